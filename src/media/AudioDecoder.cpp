@@ -3,7 +3,13 @@
 //
 
 #include "AudioDecoder.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <logger.h>
+#include "AudioKernels.h"
+#include "Metrics.h"
+#include "DecoderPool.h"
 extern "C"{
 #include <libavformat/avformat.h>
 #include <libavcodec/avcodec.h>
@@ -12,8 +18,10 @@ extern "C"{
 }
 
 namespace media {
-AudioDecoder::AudioDecoder(AVStream* stream, const AVPacketCallback& packetCallback)
-    : DecoderBase(stream, packetCallback, CodecType::Audio)
+AudioDecoder::AudioDecoder(AVStream* stream, const AVPacketCallback& packetCallback, const DecodeThreadConfig& threadConfig,
+    const OutputConfig& output)
+    : DecoderBase(stream, packetCallback, CodecType::Audio, threadConfig)
+    , m_output(output)
 {
     NEAPU_FUNC_TRACE;
     if (!m_stream) {
@@ -21,6 +29,16 @@ AudioDecoder::AudioDecoder(AVStream* stream, const AVPacketCallback& packetCallb
         throw std::runtime_error("AudioDecoder initialized with null stream");
     }
 
+    m_poolKey = PoolKeyBuilder()
+                    .addCodecParameters(m_stream->codecpar)
+                    .add(m_threadConfig.type)
+                    .add(m_threadConfig.threadCount)
+                    .add(m_threadConfig.lowLatency)
+                    .value();
+    if (adoptWarmContext()) {
+        return;
+    }
+
     DecoderBase::initializeContext();
 
     int ret = avcodec_open2(m_codecCtx, m_codec, nullptr);
@@ -41,6 +59,18 @@ AudioDecoder::~AudioDecoder() {
         m_lastChLayout = nullptr;
     }
 }
+void AudioDecoder::adoptFrom(DecoderBase& warm)
+{
+    DecoderBase::adoptFrom(warm);
+    auto& other = static_cast<AudioDecoder&>(warm);
+    std::swap(m_swrCtx, other.m_swrCtx);
+    std::swap(m_lastSampleRate, other.m_lastSampleRate);
+    std::swap(m_lastSampleFmt, other.m_lastSampleFmt);
+    std::swap(m_lastOutFmt, other.m_lastOutFmt);
+    std::swap(m_lastOutRate, other.m_lastOutRate);
+    std::swap(m_lastQuality, other.m_lastQuality);
+    std::swap(m_lastChLayout, other.m_lastChLayout);
+}
 int AudioDecoder::sampleRate() const
 {
     if (!m_stream) {
@@ -48,6 +78,10 @@ int AudioDecoder::sampleRate() const
     }
     return m_stream->codecpar->sample_rate;
 }
+int AudioDecoder::outputSampleRate() const
+{
+    return m_output.sampleRate > 0 ? m_output.sampleRate : sampleRate();
+}
 int AudioDecoder::channelCount() const
 {
     if (!m_stream) {
@@ -55,24 +89,124 @@ int AudioDecoder::channelCount() const
     }
     return m_stream->codecpar->ch_layout.nb_channels;
 }
+int AudioDecoder::outputChannelCount() const
+{
+    return m_output.channels > 0 ? m_output.channels : channelCount();
+}
+static int64_t steadyNowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+static int64_t frameEndUs(const Frame& frame, int sampleRate)
+{
+    if (sampleRate <= 0) {
+        return frame.ptsUs() + frame.durationUs();
+    }
+    return frame.ptsUs() + frame.nbSamples() * 1'000'000 / sampleRate;
+}
+bool AudioDecoder::shouldDropFrame(const Frame& frame)
+{
+    if (m_seekTargetUs < 0) {
+        return false;
+    }
+    if (frameEndUs(frame, m_codecCtx->sample_rate) <= m_seekTargetUs) {
+        Metrics::instance().add("audio.drop.seek");
+        return true;
+    }
+    return false;
+}
+void AudioDecoder::trimToSeekTarget(Frame& frame)
+{
+    if (frame.nbSamples() <= 0) {
+        return; // 重采样器刚开始缓存数据时输出为空，留给下一帧裁剪
+    }
+    const int64_t seekTargetUs = m_seekTargetUs.exchange(-1);
+    if (seekTargetUs < 0) {
+        return;
+    }
+    auto* avFrame = frame.avFrame();
+    const int64_t skipUs = seekTargetUs - frame.ptsUs();
+    if (skipUs <= 0 || avFrame->sample_rate <= 0) {
+        return;
+    }
+    const int skipSamples = static_cast<int>(std::min<int64_t>(
+        av_rescale(skipUs, avFrame->sample_rate, 1'000'000), avFrame->nb_samples));
+    if (skipSamples <= 0) {
+        return;
+    }
+    // 输出为交错格式，前移数据指针即可，缓冲区仍由buf引用
+    const int bytes = skipSamples * avFrame->ch_layout.nb_channels *
+        av_get_bytes_per_sample(static_cast<AVSampleFormat>(avFrame->format));
+    avFrame->data[0] += bytes;
+    avFrame->extended_data[0] = avFrame->data[0];
+    avFrame->linesize[0] -= bytes;
+    avFrame->nb_samples -= skipSamples;
+    if (avFrame->pts != AV_NOPTS_VALUE) {
+        avFrame->pts += av_rescale_q(skipSamples, AVRational{1, avFrame->sample_rate}, avFrame->time_base);
+    }
+    if (avFrame->duration > 0) {
+        avFrame->duration = av_rescale_q(avFrame->nb_samples, AVRational{1, avFrame->sample_rate}, avFrame->time_base);
+    }
+    Metrics::instance().add("audio.trim.seek_samples", skipSamples);
+}
 FramePtr AudioDecoder::postProcess(FramePtr&& frame)
 {
     if (!frame) {
         return nullptr;
     }
 
+    const int inChannels = frame->avFrame()->ch_layout.nb_channels;
+    const int outChannels = m_output.channels > 0 ? m_output.channels : inChannels;
+    const int outFmt = Frame::toAVSampleFormat(m_output.format);
+    const int outRate = m_output.sampleRate > 0 ? m_output.sampleRate : frame->avFrame()->sample_rate;
+    const double rate = m_playbackRate.load();
+    // 变速或拉伸器中还有上一速率的采样时，先全部处理为float，拉伸后再转为输出格式
+    const bool stretch = rate != 1.0 || (m_stretcher && !m_stretcher->empty());
+    const int workFmt = stretch ? AV_SAMPLE_FMT_FLT : outFmt;
+    FramePtr converted;
+    if (outChannels == inChannels) {
+        converted = convertFrame(std::move(frame), workFmt, outRate);
+    } else {
+        // 声道混合在float上进行，swr只负责格式转换和重采样
+        converted = convertFrame(std::move(frame), AV_SAMPLE_FMT_FLT, outRate);
+        if (converted) {
+            converted = remixFrame(std::move(converted), outChannels, workFmt);
+        }
+    }
+    if (!converted) {
+        return nullptr;
+    }
+    // 裁剪按媒体时间进行，在拉伸之前
+    trimToSeekTarget(*converted);
+    if (stretch) {
+        return stretchFrame(std::move(converted), rate, outFmt);
+    }
+    m_deliverRate = 1.0;
+    return converted;
+}
+FramePtr AudioDecoder::convertFrame(FramePtr&& frame, int targetFmt, int outRate)
+{
     auto* avFrame = frame->avFrame();
-    if (avFrame->format == AV_SAMPLE_FMT_S16) {
+    const auto outFmt = static_cast<AVSampleFormat>(targetFmt);
+    if (avFrame->ch_layout.nb_channels == 1 && av_get_packed_sample_fmt(static_cast<AVSampleFormat>(avFrame->format)) == outFmt) {
+        // 单声道的平面格式与交错格式内存布局相同
+        avFrame->format = outFmt;
+    }
+    if (avFrame->format == outFmt && avFrame->sample_rate == outRate) {
+        // 解码输出已是目标格式和采样率（如单声道float），跳过重采样
+        Metrics::instance().add("audio.convert.bypass");
         return frame;
     }
 
-    // 格式转换为 AV_SAMPLE_FMT_S16，采样率和通道数保持不变
+    // 转换为交错的目标格式并重采样到设备采样率，通道数保持不变
     auto convertedFrame = std::make_unique<Frame>(Frame::FrameType::Normal, frame->serial());
 
     bool needReinit = false;
     if (!m_swrCtx) needReinit = true;
     if (m_lastSampleRate != avFrame->sample_rate) needReinit = true;
     if (m_lastSampleFmt != avFrame->format) needReinit = true;
+    if (m_lastOutFmt != outFmt || m_lastOutRate != outRate || m_lastQuality != m_output.quality) needReinit = true;
     if (!m_lastChLayout) {
         needReinit = true;
     } else if (av_channel_layout_compare(m_lastChLayout, &avFrame->ch_layout) != 0) {
@@ -100,7 +234,7 @@ FramePtr AudioDecoder::postProcess(FramePtr&& frame)
         }
 
         ret = swr_alloc_set_opts2(&m_swrCtx,
-            &outLayout, AV_SAMPLE_FMT_S16, avFrame->sample_rate,
+            &outLayout, outFmt, outRate,
             &inLayout, static_cast<AVSampleFormat>(avFrame->format), avFrame->sample_rate,
             0, nullptr);
         if (ret < 0 || !m_swrCtx) {
@@ -109,7 +243,7 @@ FramePtr AudioDecoder::postProcess(FramePtr&& frame)
             av_channel_layout_uninit(&outLayout);
             return nullptr;
         }
-        ret = swr_init(m_swrCtx);
+        ret = initResampler(m_swrCtx, m_output.quality);
         av_channel_layout_uninit(&inLayout);
         av_channel_layout_uninit(&outLayout);
         if (ret < 0) {
@@ -120,6 +254,13 @@ FramePtr AudioDecoder::postProcess(FramePtr&& frame)
 
         m_lastSampleRate = avFrame->sample_rate;
         m_lastSampleFmt = avFrame->format;
+        m_lastOutFmt = outFmt;
+        m_lastOutRate = outRate;
+        m_lastQuality = m_output.quality;
+        if (avFrame->sample_rate != outRate) {
+            NEAPU_LOGI("Audio resampling {} Hz -> {} Hz, quality {}", avFrame->sample_rate, outRate,
+                static_cast<int>(m_output.quality));
+        }
         if (m_lastChLayout) {
             av_channel_layout_uninit(m_lastChLayout);
             delete m_lastChLayout;
@@ -134,13 +275,15 @@ FramePtr AudioDecoder::postProcess(FramePtr&& frame)
         }
     }
 
-    convertedFrame->avFrame()->format = AV_SAMPLE_FMT_S16;
-    convertedFrame->avFrame()->sample_rate = avFrame->sample_rate;
+    convertedFrame->avFrame()->format = outFmt;
+    convertedFrame->avFrame()->sample_rate = outRate;
     if (av_channel_layout_copy(&convertedFrame->avFrame()->ch_layout, &avFrame->ch_layout) < 0) {
         NEAPU_LOGE("Failed to set output channel layout");
         return nullptr;
     }
 
+    // 重采样器内部缓存的输入采样先于本帧输出，输出的第一个采样对应更早的时间
+    const int64_t delayUs = avFrame->sample_rate != outRate ? swr_get_delay(m_swrCtx, 1'000'000) : 0;
     int ret = swr_convert_frame(m_swrCtx, convertedFrame->avFrame(), avFrame);
     if (ret < 0) {
         NEAPU_LOGE("Failed to convert audio frame: {}", getFFmpegErrorString(ret));
@@ -148,6 +291,202 @@ FramePtr AudioDecoder::postProcess(FramePtr&& frame)
     }
 
     convertedFrame->copyMetaDataFrom(*frame);
+    if (avFrame->sample_rate != outRate) {
+        auto* outFrame = convertedFrame->avFrame();
+        const AVRational timeBase = outFrame->time_base;
+        if (timeBase.num > 0 && timeBase.den > 0) {
+            if (outFrame->pts != AV_NOPTS_VALUE) {
+                outFrame->pts -= av_rescale_q(delayUs, AVRational{1, 1'000'000}, timeBase);
+            }
+            outFrame->duration = av_rescale_q(outFrame->nb_samples, AVRational{1, outRate}, timeBase);
+        }
+    }
     return convertedFrame;
 }
-} // namespace media
\ No newline at end of file
+bool AudioDecoder::updateMixMatrix(const AVChannelLayout& inLayout, int outChannels)
+{
+    const int inChannels = inLayout.nb_channels;
+    const uint64_t inMask = inLayout.order == AV_CHANNEL_ORDER_NATIVE ? inLayout.u.mask : 0;
+    if (!m_mixMatrix.empty() && m_mixInChannels == inChannels && m_mixInMask == inMask &&
+        m_mixOutChannels == outChannels) {
+        return true;
+    }
+    m_mixMatrix.clear();
+
+    char inName[128];
+    av_channel_layout_describe(&inLayout, inName, sizeof(inName));
+    std::vector<float> matrix;
+    int ret = buildMixMatrix(inLayout, outChannels, matrix);
+    if (ret < 0) {
+        NEAPU_LOGE("Failed to build mix matrix {} -> {} channels: {}", inName, outChannels, getFFmpegErrorString(ret));
+        return false;
+    }
+
+    m_mixMatrix = std::move(matrix);
+    m_mixInChannels = inChannels;
+    m_mixInMask = inMask;
+    m_mixOutChannels = outChannels;
+    NEAPU_LOGI("Audio remix {} -> {} channels, kernels {}", inName, outChannels, audioKernels().name);
+    return true;
+}
+FramePtr AudioDecoder::remixFrame(FramePtr&& frame, int outChannels, int outFmt)
+{
+    const auto* avFrame = frame->avFrame();
+    if (!updateMixMatrix(avFrame->ch_layout, outChannels)) {
+        return nullptr;
+    }
+
+    auto mixedFrame = std::make_unique<Frame>(Frame::FrameType::Normal, frame->serial());
+    auto* outFrame = mixedFrame->avFrame();
+    outFrame->format = outFmt;
+    outFrame->sample_rate = avFrame->sample_rate;
+    outFrame->nb_samples = avFrame->nb_samples;
+    av_channel_layout_default(&outFrame->ch_layout, outChannels);
+    mixedFrame->copyMetaDataFrom(*frame);
+    if (avFrame->nb_samples <= 0) {
+        return mixedFrame;
+    }
+    int ret = av_frame_get_buffer(outFrame, 0);
+    if (ret < 0) {
+        NEAPU_LOGE("Failed to allocate remix buffer: {}", getFFmpegErrorString(ret));
+        return nullptr;
+    }
+
+    const auto& kernels = audioKernels();
+    const int64_t startUs = steadyNowUs();
+    const auto* src = reinterpret_cast<const float*>(avFrame->data[0]);
+    const int inChannels = avFrame->ch_layout.nb_channels;
+    const int samples = avFrame->nb_samples;
+    if (outFmt == AV_SAMPLE_FMT_FLT) {
+        kernels.mixChannels(src, inChannels, reinterpret_cast<float*>(outFrame->data[0]), outChannels,
+            m_mixMatrix.data(), samples);
+    } else {
+        m_mixBuffer.resize(static_cast<size_t>(samples) * outChannels);
+        kernels.mixChannels(src, inChannels, m_mixBuffer.data(), outChannels, m_mixMatrix.data(), samples);
+        kernels.floatToS16(m_mixBuffer.data(), reinterpret_cast<int16_t*>(outFrame->data[0]),
+            static_cast<int>(m_mixBuffer.size()));
+    }
+    auto& metrics = Metrics::instance();
+    metrics.add("audio.remix.frames");
+    metrics.set("audio.remix.process_us", steadyNowUs() - startUs);
+    return mixedFrame;
+}
+FramePtr AudioDecoder::stretchFrame(FramePtr&& frame, double rate, int outFmt)
+{
+    const auto* avFrame = frame->avFrame();
+    const int channels = avFrame->ch_layout.nb_channels;
+    if (!m_stretcher || m_stretcher->sampleRate() != avFrame->sample_rate || m_stretcher->channels() != channels) {
+        m_stretcher = std::make_unique<TimeStretcher>(avFrame->sample_rate, channels);
+    }
+
+    const int64_t startUs = steadyNowUs();
+    const auto* samples = reinterpret_cast<const float*>(avFrame->data[0]);
+    const size_t sampleCount = static_cast<size_t>(std::max(avFrame->nb_samples, 0)) * channels;
+    int64_t ptsUs = frame->ptsUs();
+    m_stretchBuffer.clear();
+    if (rate == 1.0) {
+        // 回到原速：原样输出拉伸器中剩余的采样，再接上本帧
+        m_stretcher->drain(m_stretchBuffer, ptsUs);
+        m_stretchBuffer.insert(m_stretchBuffer.end(), samples, samples + sampleCount);
+    } else {
+        m_stretcher->setRate(rate);
+        m_stretcher->push(samples, avFrame->nb_samples, frame->ptsUs());
+        m_stretcher->process(m_stretchBuffer, ptsUs);
+    }
+    m_deliverRate = rate;
+    auto stretchedFrame = makePcmFrame(m_stretchBuffer, channels, avFrame->sample_rate, outFmt, ptsUs, rate,
+        frame->serial());
+
+    // 每输出一秒的耗时与速率无关，total_us 与播放时长之比即为拉伸的CPU占用
+    const int64_t elapsedUs = steadyNowUs() - startUs;
+    auto& metrics = Metrics::instance();
+    metrics.add("audio.tempo.frames");
+    metrics.add("audio.tempo.total_us", elapsedUs);
+    metrics.set("audio.tempo.process_us", elapsedUs);
+    return stretchedFrame;
+}
+FramePtr AudioDecoder::makePcmFrame(const std::vector<float>& samples, int channels, int sampleRate, int outFmt,
+    int64_t ptsUs, double mediaRate, int serial)
+{
+    auto pcmFrame = std::make_unique<Frame>(Frame::FrameType::Normal, serial);
+    auto* outFrame = pcmFrame->avFrame();
+    const int frames = static_cast<int>(samples.size() / channels);
+    outFrame->format = outFmt;
+    outFrame->sample_rate = sampleRate;
+    outFrame->nb_samples = frames;
+    av_channel_layout_default(&outFrame->ch_layout, channels);
+    // 时间按微秒记录，duration 为覆盖的媒体时长
+    outFrame->time_base = AVRational{1, 1'000'000};
+    outFrame->pts = ptsUs;
+    outFrame->duration = static_cast<int64_t>(static_cast<double>(frames) * mediaRate * 1'000'000 / sampleRate);
+    if (frames == 0) {
+        return pcmFrame;
+    }
+    int ret = av_frame_get_buffer(outFrame, 0);
+    if (ret < 0) {
+        NEAPU_LOGE("Failed to allocate stretched audio buffer: {}", getFFmpegErrorString(ret));
+        return nullptr;
+    }
+    if (outFmt == AV_SAMPLE_FMT_FLT) {
+        std::copy(samples.begin(), samples.end(), reinterpret_cast<float*>(outFrame->data[0]));
+    } else {
+        audioKernels().floatToS16(samples.data(), reinterpret_cast<int16_t*>(outFrame->data[0]),
+            static_cast<int>(samples.size()));
+    }
+    return pcmFrame;
+}
+void AudioDecoder::onFlush()
+{
+    // 启用滤镜时滤镜线程此时已空闲
+    m_ringSerial = m_serial;
+    if (m_stretcher) {
+        m_stretcher->reset();
+    }
+    if (m_swrCtx && m_lastOutRate != m_lastSampleRate) {
+        // 丢弃重采样器中缓存的seek前的采样
+        swr_init(m_swrCtx);
+    }
+}
+void AudioDecoder::deliverFrame(FramePtr&& frame)
+{
+    if (!m_outputRing) {
+        DecoderBase::deliverFrame(std::move(frame));
+        return;
+    }
+    auto abort = [this]() {
+        return !m_running.load() || m_ringSerial < m_pendingSerial.load();
+    };
+    if (frame->type() == Frame::FrameType::EndOfStream) {
+        if (m_stretcher && !m_stretcher->empty()) {
+            // 变速时拉伸器中还留有结尾的采样，原样写入
+            int64_t ptsUs = 0;
+            m_stretchBuffer.clear();
+            m_stretcher->drain(m_stretchBuffer, ptsUs);
+            auto tail = makePcmFrame(m_stretchBuffer, m_stretcher->channels(), m_stretcher->sampleRate(),
+                Frame::toAVSampleFormat(m_output.format), ptsUs, 1.0, m_ringSerial);
+            if (tail) {
+                m_deliverRate = 1.0;
+                deliverFrame(std::move(tail));
+            }
+        }
+        m_outputRing->writeEndOfStream(m_ringSerial, abort);
+        return;
+    }
+    if (frame->sampleRate() != m_outputRing->sampleRate() || frame->channels() != m_outputRing->channels()) {
+        if (!m_ringMismatchLogged) {
+            NEAPU_LOGE("Audio frame format {}Hz/{}ch does not match output ring {}Hz/{}ch, dropping",
+                frame->sampleRate(), frame->channels(), m_outputRing->sampleRate(), m_outputRing->channels());
+            m_ringMismatchLogged = true;
+        }
+        Metrics::instance().add("audio.ring.format_mismatch");
+        return;
+    }
+    m_ringSerial = frame->serial();
+    const auto bytes = static_cast<size_t>(frame->nbSamples()) * m_outputRing->bytesPerFrame();
+    if (!m_outputRing->write(frame->data(0), bytes, frame->ptsUs(), m_deliverRate, frame->serial(), abort) &&
+        m_running.load()) {
+        // 等待缓冲区空间时发生了seek，帧已过期
+        Metrics::instance().add("audio.drop.stale_serial");
+    }
+}
+} // namespace media
@@ -4,6 +4,9 @@
 
 #pragma once
 #include "DecoderBase.h"
+#include "AudioResample.h"
+#include "AudioRingBuffer.h"
+#include "TimeStretcher.h"
 
 typedef struct SwrContext SwrContext;
 typedef struct AVChannelLayout AVChannelLayout;
@@ -12,20 +15,76 @@ namespace media {
 
 class AudioDecoder : public DecoderBase{
 public:
-    AudioDecoder(AVStream* stream, const AVPacketCallback& packetCallback);
+    // 输出的交错采样格式、采样率和声道数，解码输出已经一致时不做转换
+    struct OutputConfig {
+        Frame::SampleFormat format{Frame::SampleFormat::S16};
+        int sampleRate{0}; // 0 表示保持流的采样率
+        ResampleQuality quality{ResampleQuality::Default};
+        int channels{0}; // 0 表示保持流的声道数，否则按标准矩阵下混或上混到该声道数的默认布局
+    };
+    AudioDecoder(AVStream* stream, const AVPacketCallback& packetCallback, const DecodeThreadConfig& threadConfig = {},
+        const OutputConfig& output = {});
     ~AudioDecoder() override;
 
     int sampleRate() const;
     int channelCount() const;
+    Frame::SampleFormat outputFormat() const { return m_output.format; }
+    // 输出采样率，重采样在解码流水中完成，音频回调中不再重采样
+    int outputSampleRate() const;
+    int outputChannelCount() const;
+
+    // 转换后的采样直接写入PCM环形缓冲区，不再经过帧队列，需在 start() 之前调用。
+    // 缓冲区的采样率和通道数应与输出一致，不一致的帧被丢弃
+    void setOutputRing(std::shared_ptr<AudioRingBuffer> ring) { m_outputRing = std::move(ring); }
+
+    // 变速播放，在解码流水中用WSOLA拉伸，音高不变。可在播放中随时调用，之后输出的采样生效
+    void setPlaybackRate(double rate) { m_playbackRate = rate; }
+    double playbackRate() const { return m_playbackRate.load(); }
 
 protected:
+    bool shouldDropFrame(const Frame& frame) override;
     FramePtr postProcess(FramePtr&& frame) override;
+    void deliverFrame(FramePtr&& frame) override;
+    void onFlush() override;
+    // 精确seek时裁掉转换后帧中目标之前的采样
+    void trimToSeekTarget(Frame& frame);
+    // 转换为交错的 targetFmt 并重采样到 outRate，声道布局不变
+    FramePtr convertFrame(FramePtr&& frame, int targetFmt, int outRate);
+    // 交错float帧按矩阵混合到 outChannels，输出 outFmt
+    FramePtr remixFrame(FramePtr&& frame, int outChannels, int outFmt);
+    bool updateMixMatrix(const AVChannelLayout& inLayout, int outChannels);
+    // 交错float帧按 rate 拉伸，输出 outFmt；拉伸器缓存数据时可能输出空帧
+    FramePtr stretchFrame(FramePtr&& frame, double rate, int outFmt);
+    FramePtr makePcmFrame(const std::vector<float>& samples, int channels, int sampleRate, int outFmt,
+        int64_t ptsUs, double mediaRate, int serial);
+    void adoptFrom(DecoderBase& warm) override;
 
 protected:
+    OutputConfig m_output;
     SwrContext* m_swrCtx{nullptr};
     int m_lastSampleRate{0};
     int m_lastSampleFmt{-1};
+    // 预热池中接管的转换上下文可能是另一种输出格式、采样率或质量
+    int m_lastOutFmt{-1};
+    int m_lastOutRate{0};
+    ResampleQuality m_lastQuality{ResampleQuality::Default};
     AVChannelLayout* m_lastChLayout{nullptr};
+
+    // 声道混合矩阵按输入布局缓存，行主序 [out][in]，与输出格式无关
+    std::vector<float> m_mixMatrix;
+    std::vector<float> m_mixBuffer; // S16输出时的float中间结果
+    int m_mixInChannels{0};
+    uint64_t m_mixInMask{0};
+    int m_mixOutChannels{0};
+
+    std::atomic<double> m_playbackRate{1.0};
+    std::unique_ptr<TimeStretcher> m_stretcher;
+    std::vector<float> m_stretchBuffer;
+    double m_deliverRate{1.0}; // 最近输出帧每个采样对应的媒体时长倍数，只在输出线程访问
+
+    std::shared_ptr<AudioRingBuffer> m_outputRing;
+    int m_ringSerial{0}; // 最近写入缓冲区的serial，只在输出线程和Flush时访问
+    bool m_ringMismatchLogged{false};
 };
 
 } // namespace media
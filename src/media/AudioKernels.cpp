@@ -0,0 +1,232 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#include "AudioKernels.h"
+#include "CpuFeatures.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#if defined(NEAPU_ARCH_X86)
+#include <immintrin.h>
+#elif defined(NEAPU_ARCH_ARM64)
+#include <arm_neon.h>
+#endif
+
+namespace media {
+// SIMD 实现一帧最多处理的声道数（一个256位寄存器或两个128位寄存器）
+constexpr int MAX_SIMD_CHANNELS = 8;
+
+static void mixChannelsScalar(const float* src, int inChannels, float* dst, int outChannels, const float* matrix, int frames)
+{
+    for (int f = 0; f < frames; f++) {
+        const float* in = src + static_cast<size_t>(f) * inChannels;
+        float* out = dst + static_cast<size_t>(f) * outChannels;
+        for (int o = 0; o < outChannels; o++) {
+            const float* row = matrix + static_cast<size_t>(o) * inChannels;
+            float sum = 0.0f;
+            for (int i = 0; i < inChannels; i++) {
+                sum += row[i] * in[i];
+            }
+            out[o] = sum;
+        }
+    }
+}
+static void floatToS16Scalar(const float* src, int16_t* dst, int count)
+{
+    for (int i = 0; i < count; i++) {
+        const float value = std::clamp(src[i] * 32767.0f, -32768.0f, 32767.0f);
+        dst[i] = static_cast<int16_t>(std::lrintf(value));
+    }
+}
+static float correlateScalar(const float* a, const float* b, int count, float* energy)
+{
+    float dot = 0.0f;
+    float norm = 0.0f;
+    for (int i = 0; i < count; i++) {
+        dot += a[i] * b[i];
+        norm += b[i] * b[i];
+    }
+    *energy = norm;
+    return dot;
+}
+
+#if defined(NEAPU_ARCH_X86)
+NEAPU_TARGET_AVX2 static float horizontalSum(__m256 v)
+{
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 0x55));
+    return _mm_cvtss_f32(sum);
+}
+// 每个输出采样是一帧与矩阵一行的点积。一帧按掩码加载到一个寄存器，
+// 连续4个输出的乘积用 hadd 归约后一次写出，适用于任意不超过8的输入/输出声道数
+NEAPU_TARGET_AVX2 static void mixChannelsAvx2(const float* src, int inChannels, float* dst, int outChannels, const float* matrix, int frames)
+{
+    if (inChannels > MAX_SIMD_CHANNELS || outChannels > MAX_SIMD_CHANNELS) {
+        mixChannelsScalar(src, inChannels, dst, outChannels, matrix, frames);
+        return;
+    }
+    alignas(32) float rows[MAX_SIMD_CHANNELS][MAX_SIMD_CHANNELS] = {};
+    for (int o = 0; o < outChannels; o++) {
+        for (int i = 0; i < inChannels; i++) {
+            rows[o][i] = matrix[o * inChannels + i];
+        }
+    }
+    __m256 rowVec[MAX_SIMD_CHANNELS];
+    for (int o = 0; o < outChannels; o++) {
+        rowVec[o] = _mm256_load_ps(rows[o]);
+    }
+    alignas(32) int32_t maskBits[MAX_SIMD_CHANNELS];
+    for (int i = 0; i < MAX_SIMD_CHANNELS; i++) {
+        maskBits[i] = i < inChannels ? -1 : 0;
+    }
+    // 只读取本帧的声道，不会越过输入缓冲区末尾
+    const __m256i mask = _mm256_load_si256(reinterpret_cast<const __m256i*>(maskBits));
+
+    const int total = frames * outChannels;
+    int k = 0;
+    int f = 0;
+    int o = 0;
+    for (; k + 4 <= total; k += 4) {
+        __m256 products[4];
+        for (auto& product : products) {
+            product = _mm256_mul_ps(_mm256_maskload_ps(src + static_cast<size_t>(f) * inChannels, mask), rowVec[o]);
+            if (++o == outChannels) {
+                o = 0;
+                f++;
+            }
+        }
+        const __m256 h01 = _mm256_hadd_ps(products[0], products[1]);
+        const __m256 h23 = _mm256_hadd_ps(products[2], products[3]);
+        const __m256 h = _mm256_hadd_ps(h01, h23);
+        _mm_storeu_ps(dst + k, _mm_add_ps(_mm256_castps256_ps128(h), _mm256_extractf128_ps(h, 1)));
+    }
+    for (; k < total; k++) {
+        const float* in = src + static_cast<size_t>(f) * inChannels;
+        float sum = 0.0f;
+        for (int i = 0; i < inChannels; i++) {
+            sum += rows[o][i] * in[i];
+        }
+        dst[k] = sum;
+        if (++o == outChannels) {
+            o = 0;
+            f++;
+        }
+    }
+}
+// packs 按128位通道独立执行，结果需要用 permute4x64 还原顺序
+NEAPU_TARGET_AVX2 static void floatToS16Avx2(const float* src, int16_t* dst, int count)
+{
+    const __m256 scale = _mm256_set1_ps(32767.0f);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i a = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(src + i), scale));
+        const __m256i b = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(src + i + 8), scale));
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), packed);
+    }
+    floatToS16Scalar(src + i, dst + i, count - i);
+}
+NEAPU_TARGET_AVX2 static float correlateAvx2(const float* a, const float* b, int count, float* energy)
+{
+    __m256 dot = _mm256_setzero_ps();
+    __m256 norm = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 va = _mm256_loadu_ps(a + i);
+        const __m256 vb = _mm256_loadu_ps(b + i);
+        dot = _mm256_add_ps(dot, _mm256_mul_ps(va, vb));
+        norm = _mm256_add_ps(norm, _mm256_mul_ps(vb, vb));
+    }
+    float tailEnergy = 0.0f;
+    const float tailDot = correlateScalar(a + i, b + i, count - i, &tailEnergy);
+    *energy = horizontalSum(norm) + tailEnergy;
+    return horizontalSum(dot) + tailDot;
+}
+#elif defined(NEAPU_ARCH_ARM64)
+static void mixChannelsNeon(const float* src, int inChannels, float* dst, int outChannels, const float* matrix, int frames)
+{
+    if (inChannels > MAX_SIMD_CHANNELS || outChannels > MAX_SIMD_CHANNELS) {
+        mixChannelsScalar(src, inChannels, dst, outChannels, matrix, frames);
+        return;
+    }
+    float rows[MAX_SIMD_CHANNELS][MAX_SIMD_CHANNELS] = {};
+    for (int o = 0; o < outChannels; o++) {
+        for (int i = 0; i < inChannels; i++) {
+            rows[o][i] = matrix[o * inChannels + i];
+        }
+    }
+    float32x4_t rowLo[MAX_SIMD_CHANNELS];
+    float32x4_t rowHi[MAX_SIMD_CHANNELS];
+    for (int o = 0; o < outChannels; o++) {
+        rowLo[o] = vld1q_f32(rows[o]);
+        rowHi[o] = vld1q_f32(rows[o] + 4);
+    }
+    // 帧先拷贝到补零的临时区，避免读越界
+    float frame[MAX_SIMD_CHANNELS] = {};
+    for (int f = 0; f < frames; f++) {
+        std::memcpy(frame, src + static_cast<size_t>(f) * inChannels, sizeof(float) * inChannels);
+        const float32x4_t lo = vld1q_f32(frame);
+        const float32x4_t hi = vld1q_f32(frame + 4);
+        float* out = dst + static_cast<size_t>(f) * outChannels;
+        for (int o = 0; o < outChannels; o++) {
+            out[o] = vaddvq_f32(vfmaq_f32(vmulq_f32(lo, rowLo[o]), hi, rowHi[o]));
+        }
+    }
+}
+static void floatToS16Neon(const float* src, int16_t* dst, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const int32x4_t a = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(src + i), 32767.0f));
+        const int32x4_t b = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(src + i + 4), 32767.0f));
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+    }
+    floatToS16Scalar(src + i, dst + i, count - i);
+}
+static float correlateNeon(const float* a, const float* b, int count, float* energy)
+{
+    float32x4_t dot = vdupq_n_f32(0.0f);
+    float32x4_t norm = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float32x4_t va = vld1q_f32(a + i);
+        const float32x4_t vb = vld1q_f32(b + i);
+        dot = vfmaq_f32(dot, va, vb);
+        norm = vfmaq_f32(norm, vb, vb);
+    }
+    float tailEnergy = 0.0f;
+    const float tailDot = correlateScalar(a + i, b + i, count - i, &tailEnergy);
+    *energy = vaddvq_f32(norm) + tailEnergy;
+    return vaddvq_f32(dot) + tailDot;
+}
+#endif
+
+std::vector<AudioKernels> availableAudioKernels()
+{
+    std::vector<AudioKernels> kernels{scalarAudioKernels()};
+    [[maybe_unused]] const auto& features = cpuFeatures();
+#if defined(NEAPU_ARCH_X86)
+    if (features.avx2) {
+        kernels.push_back({mixChannelsAvx2, floatToS16Avx2, correlateAvx2, "avx2"});
+    }
+#elif defined(NEAPU_ARCH_ARM64)
+    if (features.neon) {
+        kernels.push_back({mixChannelsNeon, floatToS16Neon, correlateNeon, "neon"});
+    }
+#endif
+    return kernels;
+}
+
+const AudioKernels& audioKernels()
+{
+    static const AudioKernels kernels = availableAudioKernels().back();
+    return kernels;
+}
+const AudioKernels& scalarAudioKernels()
+{
+    static const AudioKernels kernels{mixChannelsScalar, floatToS16Scalar, correlateScalar, "scalar"};
+    return kernels;
+}
+} // namespace media
@@ -0,0 +1,28 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace media {
+
+// 交错float采样的声道混合、格式转换和相关计算内核，运行时按CPU特性选择 AVX2/NEON 实现
+struct AudioKernels {
+    // 按矩阵混合声道：dst[f * outChannels + o] = sum(matrix[o * inChannels + i] * src[f * inChannels + i])。
+    // SIMD 实现要求 inChannels <= 8，超出时退回标量
+    void (*mixChannels)(const float* src, int inChannels, float* dst, int outChannels, const float* matrix, int frames);
+    // float 转 S16，乘32767后四舍五入并饱和
+    void (*floatToS16)(const float* src, int16_t* dst, int count);
+    // 返回 a 与 b 的点积，同时输出 b 的能量 sum(b * b)，用于时间拉伸中的相似度搜索
+    float (*correlate)(const float* a, const float* b, int count, float* energy);
+    const char* name;
+};
+
+const AudioKernels& audioKernels();
+const AudioKernels& scalarAudioKernels();
+// 本机CPU支持的全部实现，按优先级从低到高排列，第一个为标量实现，最后一个即 audioKernels() 的选择
+std::vector<AudioKernels> availableAudioKernels();
+
+} // namespace media
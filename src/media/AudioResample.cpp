@@ -0,0 +1,70 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#include "AudioResample.h"
+#include <cmath>
+#include <logger.h>
+#include "Helper.h"
+extern "C" {
+#include <libavutil/channel_layout.h>
+#include <libavutil/opt.h>
+#include <libswresample/swresample.h>
+}
+
+namespace media {
+static void setSwrEngineOptions(SwrContext* swrCtx, int filterSize, int phaseShift, bool linearInterp)
+{
+    av_opt_set_int(swrCtx, "resampler", SWR_ENGINE_SWR, 0);
+    av_opt_set_int(swrCtx, "filter_size", filterSize, 0);
+    av_opt_set_int(swrCtx, "phase_shift", phaseShift, 0);
+    av_opt_set_int(swrCtx, "linear_interp", linearInterp ? 1 : 0, 0);
+}
+int initResampler(SwrContext* swrCtx, ResampleQuality quality)
+{
+    switch (quality) {
+    case ResampleQuality::Fast:
+        setSwrEngineOptions(swrCtx, 8, 6, true);
+        break;
+    case ResampleQuality::Default:
+        break;
+    case ResampleQuality::High: {
+        av_opt_set_int(swrCtx, "resampler", SWR_ENGINE_SOXR, 0);
+        av_opt_set_int(swrCtx, "precision", 28, 0);
+        const int ret = swr_init(swrCtx);
+        if (ret >= 0) {
+            return ret;
+        }
+        // FFmpeg 未编译 libsoxr
+        NEAPU_LOGW("soxr resampler unavailable ({}), falling back to swresample", getFFmpegErrorString(ret));
+        setSwrEngineOptions(swrCtx, 64, 14, true);
+        break;
+    }
+    }
+    return swr_init(swrCtx);
+}
+int buildMixMatrix(const AVChannelLayout& inLayout, int outChannels, std::vector<float>& matrix)
+{
+    // 未标明声道位置的流按该声道数的默认布局处理
+    const int inChannels = inLayout.nb_channels;
+    AVChannelLayout in{};
+    AVChannelLayout out{};
+    if (inLayout.order == AV_CHANNEL_ORDER_NATIVE && inLayout.u.mask != 0) {
+        av_channel_layout_copy(&in, &inLayout);
+    } else {
+        av_channel_layout_default(&in, inChannels);
+    }
+    av_channel_layout_default(&out, outChannels);
+    // ITU-R BS.775 系数：中置和环绕 -3dB 混入左右，LFE 丢弃。
+    // 无论输出格式和是否变速都归一化到每路增益和不超过1，音量一致且不会削波
+    std::vector<double> coefficients(static_cast<size_t>(outChannels) * inChannels);
+    const int ret = swr_build_matrix2(&in, &out, M_SQRT1_2, M_SQRT1_2, 0.0, 1.0, 1.0,
+        coefficients.data(), inChannels, AV_MATRIX_ENCODING_NONE, nullptr);
+    av_channel_layout_uninit(&in);
+    av_channel_layout_uninit(&out);
+    if (ret >= 0) {
+        matrix.assign(coefficients.begin(), coefficients.end());
+    }
+    return ret;
+}
+} // namespace media
@@ -0,0 +1,27 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+#include <vector>
+
+typedef struct SwrContext SwrContext;
+typedef struct AVChannelLayout AVChannelLayout;
+
+namespace media {
+
+enum class ResampleQuality {
+    Fast, // 短滤波器加线性插值，CPU占用最低
+    Default, // swresample 默认参数
+    High, // soxr 高精度，不可用时退回长滤波器的 swresample
+};
+
+// 在 swr_alloc_set_opts2 之后、swr_init 之前设置质量相关的选项并初始化。
+// High 档位 soxr 初始化失败时改用 swresample 引擎重试，返回 swr_init 的结果
+int initResampler(SwrContext* swrCtx, ResampleQuality quality);
+
+// 生成 inLayout 下混到 outChannels 声道默认布局的矩阵，按 ITU 系数并归一化，
+// 行主序：matrix[o * inChannels + i]。返回 swr_build_matrix2 的结果
+int buildMixMatrix(const AVChannelLayout& inLayout, int outChannels, std::vector<float>& matrix);
+
+} // namespace media
@@ -0,0 +1,177 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#include "AudioRingBuffer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+namespace media {
+// 块表容量，必须是2的幂。一个块对应一个解码帧，远多于缓冲区内能容纳的帧数
+constexpr size_t MAX_CHUNKS = 256;
+constexpr size_t CHUNK_MASK = MAX_CHUNKS - 1;
+// 写端等待读端腾出空间的轮询间隔，读端不做任何通知
+constexpr auto WRITE_POLL_INTERVAL = std::chrono::milliseconds(2);
+
+AudioRingBuffer::AudioRingBuffer(int sampleRate, int channels, int bytesPerSample, int capacityMs)
+    : m_sampleRate(sampleRate)
+    , m_channels(channels)
+    , m_bytesPerFrame(static_cast<size_t>(channels) * bytesPerSample)
+    , m_chunks(MAX_CHUNKS)
+{
+    if (sampleRate <= 0 || channels <= 0 || bytesPerSample <= 0 || capacityMs <= 0) {
+        throw std::runtime_error("Invalid audio ring buffer parameters");
+    }
+    const size_t frames = static_cast<size_t>(sampleRate) * capacityMs / 1000;
+    m_data.resize(std::max<size_t>(frames, 1) * m_bytesPerFrame);
+}
+bool AudioRingBuffer::write(const uint8_t* data, size_t bytes, int64_t ptsUs, double mediaRate, int serial,
+    const std::function<bool()>& abort)
+{
+    bytes -= bytes % m_bytesPerFrame;
+    // 大于缓冲区一半的数据分段写入，读端可以边读边腾出空间
+    const size_t maxPiece = std::max(m_bytesPerFrame, m_data.size() / 2 / m_bytesPerFrame * m_bytesPerFrame);
+    size_t offset = 0;
+    while (offset < bytes) {
+        const size_t piece = std::min(maxPiece, bytes - offset);
+        if (!waitForSpace(piece, abort)) {
+            return false;
+        }
+        const size_t start = m_writePos % m_data.size();
+        const size_t first = std::min(piece, m_data.size() - start);
+        std::memcpy(m_data.data() + start, data + offset, first);
+        if (first < piece) {
+            std::memcpy(m_data.data(), data + offset + first, piece - first);
+        }
+        const auto offsetFrames = static_cast<int64_t>(offset / m_bytesPerFrame);
+        pushChunk(Chunk{m_writePos, m_writePos + piece, ptsUs + mediaOffsetUs(offsetFrames, mediaRate), mediaRate,
+            serial, false});
+        m_writePos += piece;
+        offset += piece;
+    }
+    m_committedPos.store(m_writePos, std::memory_order_release);
+    return true;
+}
+bool AudioRingBuffer::writeEndOfStream(int serial, const std::function<bool()>& abort)
+{
+    if (!waitForSpace(0, abort)) {
+        return false;
+    }
+    pushChunk(Chunk{m_writePos, m_writePos, 0, 1.0, serial, true});
+    return true;
+}
+int64_t AudioRingBuffer::mediaOffsetUs(int64_t frames, double mediaRate) const
+{
+    return static_cast<int64_t>(static_cast<double>(frames) * mediaRate * 1'000'000 / m_sampleRate);
+}
+bool AudioRingBuffer::waitForSpace(size_t bytes, const std::function<bool()>& abort)
+{
+    for (;;) {
+        const uint64_t readPos = m_readPos.load(std::memory_order_acquire);
+        const uint64_t chunkRead = m_chunkRead.load(std::memory_order_acquire);
+        const bool hasBytes = m_data.size() - (m_writePos - readPos) >= bytes;
+        const bool hasChunk = m_chunkWrite.load(std::memory_order_relaxed) - chunkRead < MAX_CHUNKS;
+        if (hasBytes && hasChunk) {
+            return true;
+        }
+        if (abort && abort()) {
+            return false;
+        }
+        std::this_thread::sleep_for(WRITE_POLL_INTERVAL);
+    }
+}
+void AudioRingBuffer::pushChunk(const Chunk& chunk)
+{
+    const uint64_t index = m_chunkWrite.load(std::memory_order_relaxed);
+    m_chunks[index & CHUNK_MASK] = chunk;
+    // 块内容和数据先于索引对读端可见
+    m_chunkWrite.store(index + 1, std::memory_order_release);
+}
+void AudioRingBuffer::copyOut(uint8_t* dst, uint64_t position, size_t bytes) const
+{
+    const size_t start = position % m_data.size();
+    const size_t first = std::min(bytes, m_data.size() - start);
+    std::memcpy(dst, m_data.data() + start, first);
+    if (first < bytes) {
+        std::memcpy(dst + first, m_data.data(), bytes - first);
+    }
+}
+AudioRingBuffer::ReadResult AudioRingBuffer::read(uint8_t* dst, size_t bytes, int minSerial)
+{
+    ReadResult result;
+    uint64_t dropped = 0;
+    uint64_t chunkRead = m_chunkRead.load(std::memory_order_relaxed);
+    const uint64_t chunkWrite = m_chunkWrite.load(std::memory_order_acquire);
+    uint64_t readPos = m_readPos.load(std::memory_order_relaxed);
+    while (result.bytes < bytes && chunkRead != chunkWrite) {
+        const Chunk& chunk = m_chunks[chunkRead & CHUNK_MASK];
+        if (chunk.serial < minSerial) {
+            readPos = chunk.end;
+            chunkRead++;
+            dropped += chunk.endOfStream ? 0 : 1;
+            continue;
+        }
+        if (chunk.endOfStream) {
+            result.endOfStream = true;
+            m_endOfStreamSerial.store(chunk.serial, std::memory_order_release);
+            chunkRead++;
+            break;
+        }
+        readPos = std::max(readPos, chunk.begin);
+        if (result.ptsUs < 0) {
+            const auto skippedFrames = static_cast<int64_t>((readPos - chunk.begin) / m_bytesPerFrame);
+            result.ptsUs = chunk.ptsUs + mediaOffsetUs(skippedFrames, chunk.mediaRate);
+            result.mediaRate = chunk.mediaRate;
+            result.serial = chunk.serial;
+        }
+        // 回调请求的长度通常小于一个解码帧，大多数情况下只有一次拷贝
+        const size_t n = std::min<size_t>(chunk.end - readPos, bytes - result.bytes);
+        copyOut(dst + result.bytes, readPos, n);
+        readPos += n;
+        result.bytes += n;
+        if (readPos == chunk.end) {
+            chunkRead++;
+        }
+    }
+    m_readPos.store(readPos, std::memory_order_release);
+    m_chunkRead.store(chunkRead, std::memory_order_release);
+    if (dropped > 0) {
+        m_staleChunksDropped.fetch_add(dropped, std::memory_order_relaxed);
+    }
+    return result;
+}
+void AudioRingBuffer::discardStale(int minSerial)
+{
+    uint64_t dropped = 0;
+    uint64_t chunkRead = m_chunkRead.load(std::memory_order_relaxed);
+    const uint64_t chunkWrite = m_chunkWrite.load(std::memory_order_acquire);
+    uint64_t readPos = m_readPos.load(std::memory_order_relaxed);
+    while (chunkRead != chunkWrite) {
+        const Chunk& chunk = m_chunks[chunkRead & CHUNK_MASK];
+        if (chunk.serial >= minSerial) {
+            break;
+        }
+        readPos = chunk.end;
+        chunkRead++;
+        dropped += chunk.endOfStream ? 0 : 1;
+    }
+    m_readPos.store(readPos, std::memory_order_release);
+    m_chunkRead.store(chunkRead, std::memory_order_release);
+    if (dropped > 0) {
+        m_staleChunksDropped.fetch_add(dropped, std::memory_order_relaxed);
+    }
+}
+size_t AudioRingBuffer::bufferedBytes() const
+{
+    const uint64_t committed = m_committedPos.load(std::memory_order_acquire);
+    const uint64_t readPos = m_readPos.load(std::memory_order_acquire);
+    return committed > readPos ? static_cast<size_t>(committed - readPos) : 0;
+}
+int64_t AudioRingBuffer::bufferedUs() const
+{
+    return static_cast<int64_t>(bufferedBytes() / m_bytesPerFrame) * 1'000'000 / m_sampleRate;
+}
+} // namespace media
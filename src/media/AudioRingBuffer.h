@@ -0,0 +1,85 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace media {
+
+// 解码线程和音频回调之间的单生产者单消费者PCM环形缓冲区，容量按毫秒计算。
+// 数据按写入的块记录起始时间和serial，读端据此得到读出数据的时间并跳过seek前的旧数据。
+// 读端无锁、不分配内存，可以直接在音频设备回调中调用
+class AudioRingBuffer {
+public:
+    AudioRingBuffer(int sampleRate, int channels, int bytesPerSample, int capacityMs);
+    AudioRingBuffer(const AudioRingBuffer&) = delete;
+    AudioRingBuffer& operator=(const AudioRingBuffer&) = delete;
+
+    int sampleRate() const { return m_sampleRate; }
+    int channels() const { return m_channels; }
+    size_t bytesPerFrame() const { return m_bytesPerFrame; }
+
+    // 写端，只能在一个线程调用。
+    // 写入一段交错PCM，ptsUs为第一个采样的时间，mediaRate为每个采样对应的媒体时长倍数（变速播放时不为1）。
+    // 空间不足时等待，abort返回true时放弃并返回false
+    bool write(const uint8_t* data, size_t bytes, int64_t ptsUs, double mediaRate, int serial,
+        const std::function<bool()>& abort);
+    // 写入结束标记，读端读到后停止输出并记录 endOfStreamSerial
+    bool writeEndOfStream(int serial, const std::function<bool()>& abort);
+
+    struct ReadResult {
+        size_t bytes{0};
+        int64_t ptsUs{-1}; // 读出的第一个采样的时间
+        double mediaRate{1.0};
+        int serial{-1};
+        bool endOfStream{false};
+    };
+    // 读端，只能在一个线程调用。最多读出 bytes 字节，serial 小于 minSerial 的数据直接丢弃
+    ReadResult read(uint8_t* dst, size_t bytes, int minSerial);
+    // 读端，只丢弃 serial 小于 minSerial 的数据。暂停和静音时调用，避免旧数据占满缓冲区阻塞写端
+    void discardStale(int minSerial);
+
+    // 以下可在任意线程调用
+    size_t bufferedBytes() const;
+    int64_t bufferedUs() const;
+    // 读端最近读到的结束标记的serial，没有时为-1
+    int endOfStreamSerial() const { return m_endOfStreamSerial.load(std::memory_order_acquire); }
+    // 读端因serial过期丢弃的数据块数，一块对应一个解码帧
+    uint64_t staleChunksDropped() const { return m_staleChunksDropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Chunk {
+        uint64_t begin{0}; // 数据在环中的绝对位置
+        uint64_t end{0};
+        int64_t ptsUs{0};
+        double mediaRate{1.0};
+        int serial{0};
+        bool endOfStream{false};
+    };
+    bool waitForSpace(size_t bytes, const std::function<bool()>& abort);
+    void pushChunk(const Chunk& chunk);
+    void copyOut(uint8_t* dst, uint64_t position, size_t bytes) const;
+    int64_t mediaOffsetUs(int64_t frames, double mediaRate) const;
+
+private:
+    int m_sampleRate;
+    int m_channels;
+    size_t m_bytesPerFrame;
+    std::vector<uint8_t> m_data;
+    std::vector<Chunk> m_chunks;
+
+    uint64_t m_writePos{0}; // 只在写端访问
+    std::atomic<uint64_t> m_committedPos{0}; // 已发布给读端的数据末尾
+    std::atomic<uint64_t> m_readPos{0};
+    std::atomic<uint64_t> m_chunkWrite{0};
+    std::atomic<uint64_t> m_chunkRead{0};
+    std::atomic_int m_endOfStreamSerial{-1};
+    std::atomic<uint64_t> m_staleChunksDropped{0};
+};
+
+} // namespace media
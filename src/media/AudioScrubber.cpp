@@ -0,0 +1,255 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#include "AudioScrubber.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numbers>
+#include <logger.h>
+#include "AudioKernels.h"
+#include "AudioResample.h"
+#include "Helper.h"
+#include "Metrics.h"
+#include "WorkerThread.h"
+extern "C" {
+#include <libavutil/channel_layout.h>
+#include <libswresample/swresample.h>
+}
+
+namespace media {
+// 目标在已解码位置之后这个范围内时继续向后解码，不重新seek
+constexpr int64_t MAX_FORWARD_DECODE_US = 500'000;
+
+static int64_t steadyNowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+// 等功率淡入增益，片段来自不同位置，互不相关
+static float fadeInGain(int index, int frames)
+{
+    const float t = (static_cast<float>(index) + 0.5f) / static_cast<float>(frames);
+    return std::sin(t * std::numbers::pi_v<float> / 2);
+}
+
+AudioScrubber::AudioScrubber(const Config& config)
+    : m_config(config)
+    , m_reader(config.url, FrameReader::MediaType::Audio)
+    // 容纳两个片段：一个正在播放，一个等待写入
+    , m_ring(config.sampleRate, config.channels, Frame::bytesPerSample(config.sampleFormat), config.snippetMs * 2)
+    , m_snippetFrames(config.sampleRate * config.snippetMs / 1000)
+    , m_fadeFrames(std::min(config.sampleRate * config.crossfadeMs / 1000, m_snippetFrames / 2))
+{
+    NEAPU_LOGI("Audio scrubber created, snippet {} ms, crossfade {} ms, output {} Hz/{}ch",
+        m_config.snippetMs, m_config.crossfadeMs, m_config.sampleRate, m_config.channels);
+    m_workerThread = std::thread(&AudioScrubber::workerThreadFunc, this);
+}
+AudioScrubber::~AudioScrubber()
+{
+    stopWorkerThread(m_mutex, m_condVar, m_workerThread, [this]() {
+        m_running = false;
+        m_generation++;
+    });
+    if (m_swrCtx) {
+        swr_free(&m_swrCtx);
+    }
+}
+void AudioScrubber::request(int64_t positionUs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_targetUs = positionUs;
+    m_pendingTarget = true;
+    m_generation++;
+    m_condVar.notify_all();
+}
+void AudioScrubber::cancel()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pendingTarget = false;
+    m_generation++;
+    m_serial++;
+    m_condVar.notify_all();
+}
+uint32_t AudioScrubber::read(void* output, uint32_t frameCount)
+{
+    const size_t bytesPerFrame = m_ring.bytesPerFrame();
+    const auto result = m_ring.read(static_cast<uint8_t*>(output), frameCount * bytesPerFrame, m_serial.load());
+    return static_cast<uint32_t>(result.bytes / bytesPerFrame);
+}
+void AudioScrubber::workerThreadFunc()
+{
+    NEAPU_FUNC_TRACE;
+    // 没有新的位置时，在上一片段播完之前单独写出淡出的尾部
+    const auto tailTimeout = std::chrono::milliseconds(std::max(1, (m_config.snippetMs - m_config.crossfadeMs) / 2));
+    while (m_running) {
+        int64_t targetUs = 0;
+        uint64_t generation = 0;
+        int serial = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            auto ready = [this]() { return !m_running || m_pendingTarget; };
+            bool woken = true;
+            if (m_tail.empty()) {
+                m_condVar.wait(lock, ready);
+            } else {
+                woken = m_condVar.wait_for(lock, tailTimeout, ready);
+            }
+            if (!m_running) {
+                break;
+            }
+            serial = m_serial.load();
+            if (!woken) {
+                lock.unlock();
+                flushTail(serial);
+                continue;
+            }
+            m_pendingTarget = false;
+            targetUs = m_targetUs;
+            generation = m_generation.load();
+        }
+        if (m_tailSerial != serial) {
+            m_tail.clear(); // 预听已经结束过，旧尾部不再接续
+        }
+
+        const int64_t startUs = steadyNowUs();
+        if (!decodeSnippet(targetUs)) {
+            continue;
+        }
+        Metrics::instance().set("scrub.audio.decode_us", steadyNowUs() - startUs);
+
+        // 开头与上一片段的尾部交叉淡化，末尾留到下一片段再淡化
+        const int channels = m_config.channels;
+        const int frames = static_cast<int>(m_snippet.size() / channels);
+        const int fadeFrames = std::min(m_fadeFrames, frames / 2);
+        const int tailFrames = static_cast<int>(m_tail.size() / channels);
+        m_mixBuffer.assign(m_snippet.begin(), m_snippet.end() - static_cast<ptrdiff_t>(fadeFrames) * channels);
+        for (int i = 0; i < fadeFrames; i++) {
+            const float gainIn = fadeInGain(i, fadeFrames);
+            const float gainOut = i < tailFrames ? fadeInGain(fadeFrames - 1 - i, fadeFrames) : 0.0f;
+            for (int c = 0; c < channels; c++) {
+                const size_t index = static_cast<size_t>(i) * channels + c;
+                const float previous = i < tailFrames ? m_tail[index] : 0.0f;
+                m_mixBuffer[index] = m_snippet[index] * gainIn + previous * gainOut;
+            }
+        }
+        auto abort = [this, generation]() { return !m_running || m_generation.load() != generation; };
+        if (!writeSamples(m_mixBuffer, targetUs, serial, abort)) {
+            // 等待播放期间光标又移动了，这个片段作废，尾部留给新片段淡化
+            Metrics::instance().add("scrub.audio.cancelled");
+            continue;
+        }
+        m_tail.assign(m_snippet.end() - static_cast<ptrdiff_t>(fadeFrames) * channels, m_snippet.end());
+        m_tailPtsUs = targetUs + static_cast<int64_t>(frames - fadeFrames) * 1'000'000 / m_config.sampleRate;
+        m_tailSerial = serial;
+        Metrics::instance().add("scrub.audio.snippets");
+    }
+}
+bool AudioScrubber::decodeSnippet(int64_t targetUs)
+{
+    m_snippet.clear();
+    // 向后小范围拖动时沿用当前解码位置，音频seek代价低，其余情况都重新seek
+    if (m_decodedUntilUs == INT64_MIN || m_reader.isEof() ||
+        targetUs < m_decodedUntilUs || targetUs - m_decodedUntilUs > MAX_FORWARD_DECODE_US) {
+        if (!m_reader.seek(targetUs)) {
+            m_decodedUntilUs = INT64_MIN;
+            return false;
+        }
+        if (m_swrCtx) {
+            swr_init(m_swrCtx); // 丢弃重采样器中seek前的采样
+        }
+    }
+    const size_t wanted = static_cast<size_t>(m_snippetFrames) * m_config.channels;
+    while (m_snippet.size() < wanted) {
+        auto frame = m_reader.readFrame();
+        if (!frame) {
+            break;
+        }
+        const int sampleRate = frame->sampleRate();
+        m_decodedUntilUs = frame->ptsUs() + (sampleRate > 0 ? frame->nbSamples() * 1'000'000 / sampleRate : 0);
+        if (m_decodedUntilUs <= targetUs) {
+            continue;
+        }
+        if (!appendFrame(*frame, targetUs)) {
+            m_decodedUntilUs = INT64_MIN;
+            return false;
+        }
+    }
+    m_snippet.resize(std::min(m_snippet.size(), wanted));
+    return !m_snippet.empty();
+}
+bool AudioScrubber::appendFrame(Frame& frame, int64_t targetUs)
+{
+    const AVFrame* src = frame.avFrame();
+    if (!m_swrCtx) {
+        AVChannelLayout outLayout{};
+        av_channel_layout_default(&outLayout, m_config.channels);
+        int ret = swr_alloc_set_opts2(&m_swrCtx,
+            &outLayout, AV_SAMPLE_FMT_FLT, m_config.sampleRate,
+            &src->ch_layout, static_cast<AVSampleFormat>(src->format), src->sample_rate,
+            0, nullptr);
+        av_channel_layout_uninit(&outLayout);
+        // 预听只需要听清内容，用最快的重采样
+        if (ret >= 0) {
+            ret = initResampler(m_swrCtx, ResampleQuality::Fast);
+        }
+        if (ret < 0) {
+            NEAPU_LOGE("Failed to create audio scrub resampler: {}", getFFmpegErrorString(ret));
+            swr_free(&m_swrCtx);
+            return false;
+        }
+    }
+
+    Frame converted(Frame::FrameType::Normal, 0);
+    auto* dst = converted.avFrame();
+    dst->format = AV_SAMPLE_FMT_FLT;
+    dst->sample_rate = m_config.sampleRate;
+    av_channel_layout_default(&dst->ch_layout, m_config.channels);
+    int ret = swr_convert_frame(m_swrCtx, dst, src);
+    if (ret < 0) {
+        // 流中途改变格式时重建
+        NEAPU_LOGW("Failed to convert audio scrub frame: {}", getFFmpegErrorString(ret));
+        swr_free(&m_swrCtx);
+        return false;
+    }
+
+    // 跳过目标之前的采样
+    const int64_t skipUs = std::max<int64_t>(0, targetUs - frame.ptsUs());
+    const int skip = static_cast<int>(std::min<int64_t>(skipUs * m_config.sampleRate / 1'000'000, dst->nb_samples));
+    const auto* samples = reinterpret_cast<const float*>(dst->data[0]);
+    m_snippet.insert(m_snippet.end(),
+        samples + static_cast<size_t>(skip) * m_config.channels,
+        samples + static_cast<size_t>(dst->nb_samples) * m_config.channels);
+    return true;
+}
+void AudioScrubber::flushTail(int serial)
+{
+    if (m_tail.empty() || m_tailSerial != serial) {
+        m_tail.clear();
+        return;
+    }
+    const int channels = m_config.channels;
+    const int frames = static_cast<int>(m_tail.size() / channels);
+    for (int i = 0; i < frames; i++) {
+        const float gain = fadeInGain(frames - 1 - i, frames);
+        for (int c = 0; c < channels; c++) {
+            m_tail[static_cast<size_t>(i) * channels + c] *= gain;
+        }
+    }
+    writeSamples(m_tail, m_tailPtsUs, serial, [this]() { return !m_running.load(); });
+    m_tail.clear();
+}
+bool AudioScrubber::writeSamples(const std::vector<float>& samples, int64_t ptsUs, int serial,
+    const std::function<bool()>& abort)
+{
+    if (m_config.sampleFormat == Frame::SampleFormat::Float32) {
+        return m_ring.write(reinterpret_cast<const uint8_t*>(samples.data()), samples.size() * sizeof(float),
+            ptsUs, 1.0, serial, abort);
+    }
+    m_s16Buffer.resize(samples.size());
+    audioKernels().floatToS16(samples.data(), m_s16Buffer.data(), static_cast<int>(samples.size()));
+    return m_ring.write(reinterpret_cast<const uint8_t*>(m_s16Buffer.data()), m_s16Buffer.size() * sizeof(int16_t),
+        ptsUs, 1.0, serial, abort);
+}
+} // namespace media
@@ -0,0 +1,82 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AudioRingBuffer.h"
+#include "Frame.h"
+#include "FrameReader.h"
+
+typedef struct SwrContext SwrContext;
+
+namespace media {
+
+// 拖动进度条时的音频预听：在拖动位置解码一小段音频，加窗后写入自己的PCM缓冲区，
+// 拖动期间音频回调改从这里读取。使用独立的FrameReader，不冲刷主管线的队列。
+// 相邻片段首尾交叉淡化；新的拖动位置取代还没写出的片段，延迟跟随光标
+class AudioScrubber {
+public:
+    struct Config {
+        std::string url;
+        // 输出格式与音频设备一致
+        int sampleRate{48000};
+        int channels{2};
+        Frame::SampleFormat sampleFormat{Frame::SampleFormat::Float32};
+        int snippetMs{80};
+        int crossfadeMs{10};
+    };
+    explicit AudioScrubber(const Config& config);
+    ~AudioScrubber();
+    AudioScrubber(const AudioScrubber&) = delete;
+    AudioScrubber& operator=(const AudioScrubber&) = delete;
+
+    // 播放 positionUs 处的片段，取代尚未写出的片段
+    void request(int64_t positionUs);
+    // 停止预听，缓冲区中还没播放的数据由读端丢弃
+    void cancel();
+    // 在音频设备回调中调用，无锁，返回读出的帧数
+    uint32_t read(void* output, uint32_t frameCount);
+
+private:
+    void workerThreadFunc();
+    bool decodeSnippet(int64_t targetUs);
+    bool appendFrame(Frame& frame, int64_t targetUs);
+    void flushTail(int serial);
+    bool writeSamples(const std::vector<float>& samples, int64_t ptsUs, int serial, const std::function<bool()>& abort);
+
+private:
+    Config m_config;
+    FrameReader m_reader;
+    SwrContext* m_swrCtx{nullptr};
+    AudioRingBuffer m_ring;
+    int m_snippetFrames;
+    int m_fadeFrames;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condVar;
+    int64_t m_targetUs{0};
+    bool m_pendingTarget{false};
+    std::atomic<uint64_t> m_generation{0};
+    std::atomic_int m_serial{0}; // cancel() 时递增，读端丢弃之前写入的片段
+
+    // 以下只在工作线程访问
+    int64_t m_decodedUntilUs{INT64_MIN}; // INT64_MIN 表示下次需要seek
+    int64_t m_tailPtsUs{0};
+    int m_tailSerial{-1};
+    std::vector<float> m_snippet;
+    std::vector<float> m_tail; // 上一片段末尾，等待与下一片段交叉淡化或单独淡出
+    std::vector<float> m_mixBuffer;
+    std::vector<int16_t> m_s16Buffer;
+
+    std::atomic_bool m_running{true};
+    std::thread m_workerThread;
+};
+
+} // namespace media
@@ -0,0 +1,45 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#include "CpuFeatures.h"
+#if defined(NEAPU_ARCH_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace media {
+static CpuFeatures detectCpuFeatures()
+{
+    CpuFeatures features;
+#if defined(NEAPU_ARCH_X86)
+#if defined(_MSC_VER)
+    int info[4] = {0};
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    features.sse2 = (info[3] & (1 << 26)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (maxLeaf >= 7 && osxsave && avx) {
+        // 确认操作系统保存了YMM寄存器状态
+        const unsigned long long xcr0 = _xgetbv(0);
+        __cpuidex(info, 7, 0);
+        features.avx2 = (info[1] & (1 << 5)) != 0 && (xcr0 & 0x6) == 0x6;
+    }
+#else
+    __builtin_cpu_init();
+    features.sse2 = __builtin_cpu_supports("sse2");
+    features.avx2 = __builtin_cpu_supports("avx2");
+#endif
+#elif defined(NEAPU_ARCH_ARM64)
+    features.neon = true; // AArch64 必定支持 NEON
+#endif
+    return features;
+}
+
+const CpuFeatures& cpuFeatures()
+{
+    static const CpuFeatures features = detectCpuFeatures();
+    return features;
+}
+} // namespace media
@@ -0,0 +1,31 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NEAPU_ARCH_X86 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define NEAPU_ARCH_ARM64 1
+#endif
+
+// GCC/Clang 需要按函数开启指令集，MSVC 直接可用对应 intrinsics
+#if defined(NEAPU_ARCH_X86) && (defined(__GNUC__) || defined(__clang__))
+#define NEAPU_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define NEAPU_TARGET_AVX2
+#endif
+
+namespace media {
+
+struct CpuFeatures {
+    bool sse2{false};
+    bool avx2{false};
+    bool neon{false};
+};
+
+// 运行时检测一次，之后直接返回缓存结果
+const CpuFeatures& cpuFeatures();
+
+} // namespace media
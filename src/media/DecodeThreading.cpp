@@ -0,0 +1,100 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#include "DecodeThreading.h"
+#include <algorithm>
+#include <logger.h>
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+namespace media {
+static int autoThreadCount(const AVCodec* codec, int width, int height, int cpuCount)
+{
+    const int64_t pixels = static_cast<int64_t>(width) * height;
+    int maxThreads = 16; // FFmpeg 自动线程数上限同为16
+    if (pixels <= 0) {
+        maxThreads = 4; // 分辨率未知时保守处理
+    } else if (pixels <= 640 * 480) {
+        maxThreads = 2;
+    } else if (pixels <= 1280 * 720) {
+        maxThreads = 4;
+    } else if (pixels <= 1920 * 1088) {
+        maxThreads = 8;
+    }
+    // HEVC/AV1/VP9 单帧计算量更大，高分辨率下多给线程
+    if (pixels > 1920 * 1088 &&
+        (codec->id == AV_CODEC_ID_HEVC || codec->id == AV_CODEC_ID_AV1 || codec->id == AV_CODEC_ID_VP9)) {
+        maxThreads = 16;
+    }
+    // 给渲染和音频线程留一个核心
+    const int available = std::max(1, cpuCount - 1);
+    return std::clamp(available, 1, maxThreads);
+}
+
+DecodeThreadSettings resolveDecodeThreadSettings(const DecodeThreadConfig& config,
+    const AVCodec* codec,
+    int width,
+    int height,
+    int cpuCount)
+{
+    DecodeThreadSettings settings;
+    if (!codec) {
+        return settings;
+    }
+
+    const bool frameCap = codec->capabilities & AV_CODEC_CAP_FRAME_THREADS;
+    const bool sliceCap = codec->capabilities & AV_CODEC_CAP_SLICE_THREADS;
+    const bool otherCap = codec->capabilities & AV_CODEC_CAP_OTHER_THREADS; // 如 libdav1d 自管线程
+    if (!frameCap && !sliceCap && !otherCap) {
+        return settings;
+    }
+
+    const int count = config.threadCount > 0 ? config.threadCount : autoThreadCount(codec, width, height, cpuCount);
+
+    using enum DecodeThreadType;
+    switch (config.type) {
+    case Frame:
+        if (frameCap) {
+            settings.threadType = FF_THREAD_FRAME;
+        } else if (sliceCap) {
+            NEAPU_LOGW("Codec {} does not support frame threads, falling back to slice threads", codec->name);
+            settings.threadType = FF_THREAD_SLICE;
+        }
+        settings.threadCount = count;
+        break;
+    case Slice:
+        if (sliceCap) {
+            settings.threadType = FF_THREAD_SLICE;
+        } else if (frameCap) {
+            NEAPU_LOGW("Codec {} does not support slice threads, falling back to frame threads", codec->name);
+            settings.threadType = FF_THREAD_FRAME;
+        }
+        settings.threadCount = count;
+        break;
+    case Auto:
+    default:
+        if (config.lowLatency) {
+            // 帧级多线程每个线程引入一帧延迟，低延迟下只用片级或解码器自管线程
+            if (sliceCap) {
+                settings.threadType = FF_THREAD_SLICE;
+                settings.threadCount = count;
+            } else if (otherCap) {
+                settings.threadCount = count;
+            }
+        } else if (frameCap) {
+            // 同时设置两种标志，由解码器优先选择帧级多线程
+            settings.threadType = FF_THREAD_FRAME | (sliceCap ? FF_THREAD_SLICE : 0);
+            settings.threadCount = count;
+        } else if (sliceCap) {
+            settings.threadType = FF_THREAD_SLICE;
+            settings.threadCount = count;
+        } else {
+            settings.threadCount = count;
+        }
+        break;
+    }
+    return settings;
+}
+} // namespace media
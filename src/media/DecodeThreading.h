@@ -0,0 +1,35 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+
+typedef struct AVCodec AVCodec;
+
+namespace media {
+
+enum class DecodeThreadType {
+    Auto, // 根据编码、分辨率、核心数和延迟要求自动选择
+    Frame, // 帧级多线程，吞吐高，但每个线程增加一帧延迟
+    Slice, // 片级多线程，无额外延迟，依赖码流的分片/分块
+};
+
+struct DecodeThreadConfig {
+    DecodeThreadType type{DecodeThreadType::Auto};
+    int threadCount{0}; // 0 表示自动
+    bool lowLatency{false}; // 低延迟时避免使用帧级多线程
+};
+
+// 解析后的结果，直接对应 AVCodecContext 的 thread_count / thread_type
+struct DecodeThreadSettings {
+    int threadCount{1};
+    int threadType{0}; // FF_THREAD_FRAME / FF_THREAD_SLICE
+};
+
+DecodeThreadSettings resolveDecodeThreadSettings(const DecodeThreadConfig& config,
+    const AVCodec* codec,
+    int width,
+    int height,
+    int cpuCount);
+
+} // namespace media
@@ -8,15 +8,18 @@
 #include "Helper.h"
 #include "VideoDecoder.h"
 #include "AudioDecoder.h"
+#include "DecoderPool.h"
 extern "C"{
 #include <libavformat/avformat.h>
 #include <libavcodec/avcodec.h>
 }
 
 namespace media {
-DecoderBase::DecoderBase(AVStream* stream, const AVPacketCallback& packetCallback, CodecType type)
+DecoderBase::DecoderBase(AVStream* stream, const AVPacketCallback& packetCallback, CodecType type,
+    const DecodeThreadConfig& threadConfig)
     : m_type(type)
     , m_stream(stream)
+    , m_threadConfig(threadConfig)
     , m_packetCallback(packetCallback)
     , m_frameQueue(type == CodecType::Video ? 5 : 15)
 {
@@ -35,13 +38,23 @@ void DecoderBase::start()
     NEAPU_FUNC_TRACE;
     stop();
     m_running = true;
+    if (m_filterStage) {
+        m_filterStage->start();
+    }
     m_decodeThread = std::thread(&DecoderBase::decodeThreadFunc, this);
 }
 void DecoderBase::stop()
 {
     NEAPU_FUNC_TRACE;
-    m_running = false;
+    {
+        std::lock_guard<std::mutex> lock(m_eofMutex);
+        m_running = false;
+        m_eofCondVar.notify_all();
+    }
     m_frameQueue.clear();
+    if (m_filterStage) {
+        m_filterStage->stop();
+    }
     if (m_decodeThread.joinable()) {
         m_decodeThread.join();
     }
@@ -69,21 +82,19 @@ bool DecoderBase::testDecode()
             return false;
         }
 
-        for (;;) {
-            AVFrame* frame = av_frame_alloc();
-            ret = avcodec_receive_frame(m_codecCtx, frame);
-            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-                av_frame_free(&frame);
-                break;
-            }
-            if (ret < 0) {
-                NEAPU_LOGE("Failed to receive frame from decoder during test decode: {}", getFFmpegErrorString(ret));
-                av_frame_free(&frame);
-                return false;
-            }
-            av_frame_free(&frame);
-            return true; // 成功解码出一帧
+        auto frame = std::make_unique<Frame>(Frame::FrameType::Normal, packet->serial());
+        ret = avcodec_receive_frame(m_codecCtx, frame->avFrame());
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+            continue;
+        }
+        if (ret < 0) {
+            NEAPU_LOGE("Failed to receive frame from decoder during test decode: {}", getFFmpegErrorString(ret));
+            return false;
         }
+        frame->avFrame()->time_base = m_stream->time_base;
+        m_serial = packet->serial();
+        m_probeFrame = std::move(frame);
+        return true; // 成功解码出一帧
     }
 }
 FramePtr DecoderBase::getFrame()
@@ -92,6 +103,59 @@ FramePtr DecoderBase::getFrame()
     NEAPU_LOGD("{} Decoder get frame PTS {}", m_type == CodecType::Video ? "Video" : "Audio", frame ? frame->ptsUs() : -1);
     return frame;
 }
+void DecoderBase::setFilter(const FilterStage::Config& config)
+{
+    const auto type = m_type == CodecType::Video ? FilterStage::MediaType::Video : FilterStage::MediaType::Audio;
+    m_filterStage = std::make_unique<FilterStage>(type, config, [this](FramePtr&& frame) {
+        outputFilteredFrame(std::move(frame));
+    });
+}
+void DecoderBase::requestFlush(int serial, int64_t targetPtsUs)
+{
+    m_pendingSeekTargetUs = targetPtsUs;
+    {
+        std::lock_guard<std::mutex> lock(m_eofMutex);
+        m_pendingSerial = serial;
+        m_eofCondVar.notify_all();
+    }
+    if (m_filterStage) {
+        m_filterStage->clear();
+    }
+    m_frameQueue.clear();
+}
+bool DecoderBase::recycle()
+{
+    stop();
+    if (!m_codecCtx || m_poolKey == 0) {
+        return false;
+    }
+    avcodec_flush_buffers(m_codecCtx);
+    m_probeFrame.reset();
+    // 回调引用的是上一个文件的解复用器，放入池中后不再使用
+    m_packetCallback = nullptr;
+    return true;
+}
+bool DecoderBase::adoptWarmContext()
+{
+    if (m_poolKey == 0) {
+        return false;
+    }
+    auto warm = DecoderPool::instance().acquire(m_poolKey);
+    if (!warm) {
+        return false;
+    }
+    adoptFrom(*warm);
+    avcodec_flush_buffers(m_codecCtx);
+    NEAPU_LOGI("{} decoder {} adopted warm context from pool",
+        m_type == CodecType::Video ? "Video" : "Audio",
+        m_codec->name);
+    return true;
+}
+void DecoderBase::adoptFrom(DecoderBase& warm)
+{
+    std::swap(m_codecCtx, warm.m_codecCtx);
+    std::swap(m_codec, warm.m_codec);
+}
 void DecoderBase::initializeContext()
 {
     m_codec = avcodec_find_decoder(m_stream->codecpar->codec_id);
@@ -112,29 +176,70 @@ void DecoderBase::initializeContext()
         NEAPU_LOGE("Failed to copy codec parameters to context: {}", errStr);
         throw std::runtime_error("Failed to copy codec parameters: " + errStr);
     }
+
+    const auto threadSettings = resolveDecodeThreadSettings(m_threadConfig,
+        m_codec,
+        m_codecCtx->width,
+        m_codecCtx->height,
+        static_cast<int>(std::thread::hardware_concurrency()));
+    m_codecCtx->thread_count = threadSettings.threadCount;
+    m_codecCtx->thread_type = threadSettings.threadType;
+    if (m_threadConfig.lowLatency) {
+        m_codecCtx->flags |= AV_CODEC_FLAG_LOW_DELAY;
+    }
+    NEAPU_LOGI("{} decoder {} threading: count={}, type={}",
+        m_type == CodecType::Video ? "Video" : "Audio",
+        m_codec->name,
+        threadSettings.threadCount,
+        threadSettings.threadType);
 }
 void DecoderBase::decodeThreadFunc()
 {
     NEAPU_FUNC_TRACE;
+    if (m_probeFrame) {
+        // 探测时解码出的帧直接输出，解码器中可能还缓存有后续帧，先取完再送包
+        outputFrame(std::move(m_probeFrame));
+        receiveFrames();
+    }
     while (m_running) {
         auto packet = m_packetCallback();
         if (!packet) {
             NEAPU_LOGE("{} Decoder received null packet", m_type == CodecType::Video ? "Video" : "Audio");
             continue;
         }
+        if (packet->type() == Packet::PacketType::Eof && isFlushPending()) {
+            continue; // seek前读到的EOF，seek后会继续读包
+        }
         if (packet->type() == Packet::PacketType::Eof) {
             NEAPU_LOGI("{} Decoder received EOF packet", m_type == CodecType::Video ? "Video" : "Audio");
-            m_frameQueue.push(std::make_unique<Frame>(Frame::FrameType::EndOfStream, -1));
-            break;
+            if (m_filterStage) {
+                // 经过滤镜线程，排空滤镜图中剩余的帧之后再输出
+                m_filterStage->push(std::make_unique<Frame>(Frame::FrameType::EndOfStream, -1));
+            } else {
+                deliverFrame(std::make_unique<Frame>(Frame::FrameType::EndOfStream, -1));
+            }
+            // 不退出线程，快退到开头或逐帧到结尾之后还要响应seek
+            waitAfterEof();
+            continue;
         }
         if (packet->type() == Packet::PacketType::Flush) {
             avcodec_flush_buffers(m_codecCtx);
+            if (m_filterStage) {
+                // 等待滤镜线程空闲，之后的onFlush可以安全修改后处理使用的状态
+                m_filterStage->reset();
+            }
             m_serial = packet->serial();
+            m_seekTargetUs = m_pendingSeekTargetUs.exchange(-1);
+            onFlush();
             m_frameQueue.clearAndFlush(m_serial);
             NEAPU_LOGI("{} Decoder received Flush packet, serial {}", m_type == CodecType::Video ? "Video" : "Audio", m_serial);
             continue;
         }
 
+        if (isFlushPending()) {
+            // 已请求seek，旧serial的包不再送入解码器，等待Flush
+            continue;
+        }
         if (packet->serial() != m_serial) {
             NEAPU_LOGW("{} Decoder packet serial {} does not match base serial {}, skipping packet",
                 m_type == CodecType::Video ? "Video" : "Audio",
@@ -150,26 +255,87 @@ void DecoderBase::decodeThreadFunc()
             continue;
         }
 
-        for (;;) {
-            auto frame = std::make_unique<Frame>(Frame::FrameType::Normal, m_serial);
-            ret = avcodec_receive_frame(m_codecCtx, frame->avFrame());
-            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-                break;
-            }
-            if (ret < 0) {
-                NEAPU_LOGE("Failed to receive frame from decoder: {}", getFFmpegErrorString(ret));
-                break;
-            }
-            frame->avFrame()->time_base = m_stream->time_base;
-            auto processedFrame = postProcess(std::move(frame));
-            if (processedFrame) {
-                // NEAPU_LOGD("{} Decoder produced frame PTS {}", m_type == CodecType::Video ? "Video" : "Audio", processedFrame->avFrame()->pts);
-                m_frameQueue.push(std::move(processedFrame));
-            } else {
-                NEAPU_LOGE("{} Post processing of frame failed", m_type == CodecType::Video ? "Video" : "Audio");
-            }
+        receiveFrames();
+    }
+}
+void DecoderBase::waitAfterEof()
+{
+    std::unique_lock<std::mutex> lock(m_eofMutex);
+    m_eofCondVar.wait(lock, [this]() { return !m_running.load() || isFlushPending(); });
+}
+void DecoderBase::receiveFrames()
+{
+    for (;;) {
+        if (isFlushPending()) {
+            // 解码器内剩余的帧会在Flush时由avcodec_flush_buffers丢弃
+            return;
+        }
+        auto frame = std::make_unique<Frame>(Frame::FrameType::Normal, m_serial);
+        int ret = avcodec_receive_frame(m_codecCtx, frame->avFrame());
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+            break;
+        }
+        if (ret < 0) {
+            NEAPU_LOGE("Failed to receive frame from decoder: {}", getFFmpegErrorString(ret));
+            break;
+        }
+        frame->avFrame()->time_base = m_stream->time_base;
+        if (shouldDropFrame(*frame)) {
+            continue;
         }
+        outputFrame(std::move(frame));
     }
 }
+void DecoderBase::outputFrame(FramePtr&& frame)
+{
+    if (isFlushPending()) {
+        return;
+    }
+    if (m_filterStage) {
+        auto filterInput = preFilter(std::move(frame));
+        if (filterInput) {
+            m_filterStage->push(std::move(filterInput));
+        }
+        return;
+    }
+    auto processedFrame = postProcess(std::move(frame));
+    if (isFlushPending()) {
+        return; // 后处理期间发生了seek
+    }
+    if (processedFrame) {
+        // NEAPU_LOGD("{} Decoder produced frame PTS {}", m_type == CodecType::Video ? "Video" : "Audio", processedFrame->avFrame()->pts);
+        deliverFrame(std::move(processedFrame));
+    } else {
+        NEAPU_LOGE("{} Post processing of frame failed", m_type == CodecType::Video ? "Video" : "Audio");
+    }
+}
+
+void DecoderBase::outputFilteredFrame(FramePtr&& frame)
+{
+    // 在滤镜线程调用，m_serial 属于解码线程，用原子的 m_pendingSerial 判断是否过期
+    if (!m_running) {
+        return;
+    }
+    if (frame->type() == Frame::FrameType::EndOfStream) {
+        deliverFrame(std::move(frame));
+        return;
+    }
+    if (frame->serial() < m_pendingSerial.load()) {
+        return;
+    }
+    auto processedFrame = postProcess(std::move(frame));
+    if (!processedFrame) {
+        NEAPU_LOGE("{} Post processing of filtered frame failed", m_type == CodecType::Video ? "Video" : "Audio");
+        return;
+    }
+    if (processedFrame->serial() < m_pendingSerial.load()) {
+        return; // 后处理期间发生了seek
+    }
+    deliverFrame(std::move(processedFrame));
+}
+void DecoderBase::deliverFrame(FramePtr&& frame)
+{
+    m_frameQueue.push(std::move(frame));
+}
 
 } // namespace media
\ No newline at end of file
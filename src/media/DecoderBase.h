@@ -3,6 +3,8 @@
 //
 
 #pragma once
+#include "DecodeThreading.h"
+#include "FilterStage.h"
 #include "Frame.h"
 #include "Helper.h"
 #include "Packet.h"
@@ -13,6 +15,7 @@
 #include <memory>
 #include <mutex>
 #include <atomic>
+#include <condition_variable>
 #include <expected>
 #include <thread>
 
@@ -30,33 +33,74 @@ public:
     };
     using AVPacketCallback = std::function<PacketPtr()>;
 
-    DecoderBase(AVStream* stream, const AVPacketCallback& packetCallback, CodecType type);
+    DecoderBase(AVStream* stream, const AVPacketCallback& packetCallback, CodecType type,
+        const DecodeThreadConfig& threadConfig = {});
     virtual ~DecoderBase();
 
     void start();
     void stop();
 
+    // 解码出第一帧即成功，该帧保留下来作为解码线程输出的第一帧
     bool testDecode();
 
     FramePtr getFrame();
 
+    // 在解码输出和帧队列之间插入滤镜处理阶段，需在 start() 之前调用。
+    // 之后后处理（格式转换、重采样）也在滤镜线程进行
+    void setFilter(const FilterStage::Config& config);
+
+    // seek时由播放线程调用：之后解码线程跳过旧serial的包和帧直到收到Flush，
+    // 同时清空帧队列，唤醒阻塞在push上的解码线程。
+    // targetPtsUs >= 0 时为精确seek，Flush之后丢弃目标之前的数据
+    void requestFlush(int serial, int64_t targetPtsUs = -1);
+
+    // 停止并刷新解码器，准备放入预热池，不可复用时返回false
+    bool recycle();
+    uint64_t poolKey() const { return m_poolKey; }
+
 protected:
     virtual void initializeContext();
+    // 从预热池接管key相同的已打开上下文，成功后无需再初始化
+    bool adoptWarmContext();
+    virtual void adoptFrom(DecoderBase& warm);
+    // 在后处理（硬件帧下载、格式转换）之前调用，返回true则直接丢弃该帧
+    virtual bool shouldDropFrame(const Frame& frame) { return false; }
+    // 送入滤镜之前调用，如把硬件帧下载到内存
+    virtual FramePtr preFilter(FramePtr&& frame) { return std::move(frame); }
     virtual FramePtr postProcess(FramePtr&& frame) = 0;
+    // 输出后处理完成的帧和EndOfStream，默认放入帧队列
+    virtual void deliverFrame(FramePtr&& frame);
+    virtual void onFlush() {}
     virtual void decodeThreadFunc();
+    bool isFlushPending() const { return m_serial < m_pendingSerial.load(); }
+    // EOF之后解复用器线程已退出，没有包可读。等待seek请求或停止，seek后解复用器重新启动并送来Flush
+    void waitAfterEof();
+    void receiveFrames();
+    void outputFrame(FramePtr&& frame);
+    void outputFilteredFrame(FramePtr&& frame);
 
 protected:
     CodecType m_type;
     AVStream* m_stream{nullptr};
     AVCodecContext* m_codecCtx{nullptr};
     const AVCodec* m_codec{nullptr};
+    DecodeThreadConfig m_threadConfig;
+    uint64_t m_poolKey{0}; // 0 表示不参与预热池
 
     FrameQueue m_frameQueue;
     AVPacketCallback m_packetCallback;
     int m_serial{0};
+    std::atomic_int m_pendingSerial{0};
+    std::atomic<int64_t> m_pendingSeekTargetUs{-1};
+    // 精确seek的目标，到达后置为-1。在解码线程Flush时设置，启用滤镜时由滤镜线程的后处理清除
+    std::atomic<int64_t> m_seekTargetUs{-1};
+    FramePtr m_probeFrame;
+    std::unique_ptr<FilterStage> m_filterStage;
 
     std::thread m_decodeThread;
     std::atomic_bool m_running{false};
+    std::mutex m_eofMutex;
+    std::condition_variable m_eofCondVar;
 };
 
 } // namespace media
@@ -0,0 +1,120 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#include "DecoderPool.h"
+#include <logger.h>
+#include "DecoderBase.h"
+#include "Metrics.h"
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+namespace media {
+PoolKeyBuilder& PoolKeyBuilder::addBytes(const void* data, size_t size)
+{
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+        m_hash ^= bytes[i];
+        m_hash *= 1099511628211ull;
+    }
+    return *this;
+}
+PoolKeyBuilder& PoolKeyBuilder::addCodecParameters(const AVCodecParameters* codecpar)
+{
+    add(codecpar->codec_type);
+    add(codecpar->codec_id);
+    add(codecpar->codec_tag);
+    add(codecpar->profile);
+    add(codecpar->level);
+    add(codecpar->format);
+    add(codecpar->width);
+    add(codecpar->height);
+    add(codecpar->bits_per_raw_sample);
+    add(codecpar->sample_rate);
+    add(codecpar->ch_layout.order);
+    add(codecpar->ch_layout.nb_channels);
+    if (codecpar->ch_layout.order == AV_CHANNEL_ORDER_NATIVE || codecpar->ch_layout.order == AV_CHANNEL_ORDER_AMBISONIC) {
+        add(codecpar->ch_layout.u.mask);
+    }
+    add(codecpar->extradata_size);
+    if (codecpar->extradata && codecpar->extradata_size > 0) {
+        addBytes(codecpar->extradata, static_cast<size_t>(codecpar->extradata_size));
+    }
+    return *this;
+}
+
+DecoderPool& DecoderPool::instance()
+{
+    static DecoderPool instance;
+    return instance;
+}
+void DecoderPool::setCapacity(size_t capacity)
+{
+    std::list<Entry> evicted;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_capacity = capacity;
+        evictLocked(evicted);
+    }
+}
+size_t DecoderPool::capacity() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_capacity;
+}
+void DecoderPool::release(std::unique_ptr<DecoderBase> decoder)
+{
+    if (!decoder) {
+        return;
+    }
+    if (!decoder->recycle()) {
+        return;
+    }
+    const uint64_t key = decoder->poolKey();
+    std::list<Entry> evicted;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_capacity == 0) {
+            return;
+        }
+        m_idle.push_front(Entry{key, std::move(decoder)});
+        evictLocked(evicted);
+    }
+    // 在锁外释放，硬件上下文的销毁可能较慢
+}
+std::unique_ptr<DecoderBase> DecoderPool::acquire(uint64_t key)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (auto it = m_idle.begin(); it != m_idle.end(); ++it) {
+        if (it->key == key) {
+            auto decoder = std::move(it->decoder);
+            m_idle.erase(it);
+            lock.unlock();
+            Metrics::instance().add("decoder_pool.hit");
+            return decoder;
+        }
+    }
+    lock.unlock();
+    Metrics::instance().add("decoder_pool.miss");
+    return nullptr;
+}
+void DecoderPool::clear()
+{
+    std::list<Entry> idle;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        idle.swap(m_idle);
+    }
+    // 在锁外释放，硬件上下文的销毁可能较慢
+    idle.clear();
+}
+void DecoderPool::evictLocked(std::list<Entry>& evicted)
+{
+    while (m_idle.size() > m_capacity) {
+        NEAPU_LOGI("Evicting idle decoder from warm pool, key {:016x}", m_idle.back().key);
+        evicted.splice(evicted.begin(), m_idle, std::prev(m_idle.end()));
+        Metrics::instance().add("decoder_pool.evict");
+    }
+}
+} // namespace media
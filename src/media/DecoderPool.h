@@ -0,0 +1,70 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
+typedef struct AVCodecParameters AVCodecParameters;
+
+namespace media {
+class DecoderBase;
+
+// FNV-1a，把解码参数和创建参数组合成预热池的key
+class PoolKeyBuilder {
+public:
+    PoolKeyBuilder& addBytes(const void* data, size_t size);
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    PoolKeyBuilder& add(const T& value)
+    {
+        return addBytes(&value, sizeof(value));
+    }
+    // 编码参数：编码器、分辨率、像素/采样格式、声道布局和extradata
+    PoolKeyBuilder& addCodecParameters(const AVCodecParameters* codecpar);
+
+    uint64_t value() const { return m_hash; }
+
+private:
+    uint64_t m_hash{14695981039346656037ull};
+};
+
+// 空闲解码器的预热池。连续播放相同编码的短片时，
+// 新解码器直接接管已打开的解码上下文、硬件设备和转换上下文，省去重新初始化
+class DecoderPool {
+public:
+    static DecoderPool& instance();
+
+    // 0 表示禁用，缩小时立即淘汰多余的条目
+    void setCapacity(size_t capacity);
+    size_t capacity() const;
+
+    // 停止解码线程并刷新后放入池中，超出容量时淘汰最久未用的。不能复用的解码器直接销毁
+    void release(std::unique_ptr<DecoderBase> decoder);
+    // 取出key相同的空闲解码器，没有返回空
+    std::unique_ptr<DecoderBase> acquire(uint64_t key);
+    // 销毁所有空闲解码器。池是静态单例，程序退出前应主动调用，
+    // 让硬件设备上下文在 main 返回之前释放
+    void clear();
+
+private:
+    struct Entry {
+        uint64_t key{0};
+        std::unique_ptr<DecoderBase> decoder;
+    };
+    DecoderPool() = default;
+    // 超出容量的条目移到 evicted，由调用方在锁外销毁
+    void evictLocked(std::list<Entry>& evicted);
+
+private:
+    mutable std::mutex m_mutex;
+    std::list<Entry> m_idle; // 头部为最近放入
+    size_t m_capacity{4};
+};
+
+} // namespace media
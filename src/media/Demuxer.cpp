@@ -3,6 +3,7 @@
 //
 
 #include "Demuxer.h"
+#include <algorithm>
 #include <stdexcept>
 #include <logger.h>
 #include "Helper.h"
@@ -177,10 +178,35 @@ double Demuxer::durationSeconds() const
     }
     return maxDur;
 }
+// 反向快退时seek没有回退（索引不精确）的重试次数，每次回退距离翻倍
+constexpr int MAX_REVERSE_SEEK_RETRIES = 5;
+
+bool Demuxer::stepBackwardKeyframe(int64_t& lastPts, int& retries)
+{
+    int64_t target = lastPts - 1;
+    if (retries > 0) {
+        const int64_t backoff = av_rescale_q(int64_t{1} << (retries - 1), AVRational{1, 1}, m_videoStream->time_base);
+        target = lastPts - backoff;
+    }
+    const int64_t startPts = m_videoStream->start_time != AV_NOPTS_VALUE ? m_videoStream->start_time : 0;
+    if (lastPts <= startPts || retries > MAX_REVERSE_SEEK_RETRIES) {
+        return false;
+    }
+    int ret = av_seek_frame(m_fmtCtx, m_videoStream->index, std::max(target, startPts), AVSEEK_FLAG_BACKWARD);
+    if (ret < 0) {
+        NEAPU_LOGW("Failed to step back to previous keyframe: {}", getFFmpegErrorString(ret));
+        return false;
+    }
+    return true;
+}
 void Demuxer::readThreadFunc()
 {
+    int64_t reverseLastPts = AV_NOPTS_VALUE;
+    int reverseRetries = 0;
     while (m_running) {
         if (m_seekRequested) {
+            reverseLastPts = AV_NOPTS_VALUE;
+            reverseRetries = 0;
             double sec = m_seekTarget;
             if (sec < 0.0) sec = 0.0;
             const int64_t timestamp = static_cast<int64_t>(sec * AV_TIME_BASE);
@@ -228,6 +254,31 @@ void Demuxer::readThreadFunc()
                 continue;
             }
         }
+        if (const int trick = m_trickDirection.load(); trick != 0) {
+            // 快进快退只解码视频关键帧，音频静音
+            const AVPacket* avPacket = packet->avPacket();
+            if (!m_videoStream || avPacket->stream_index != m_videoStream->index || !(avPacket->flags & AV_PKT_FLAG_KEY)) {
+                continue;
+            }
+            if (trick < 0) {
+                const int64_t pts = avPacket->pts != AV_NOPTS_VALUE ? avPacket->pts : avPacket->dts;
+                if (reverseLastPts != AV_NOPTS_VALUE && pts >= reverseLastPts) {
+                    // 上次回退又回到了同一个关键帧，加大回退距离
+                    reverseRetries++;
+                } else {
+                    reverseRetries = 0;
+                    reverseLastPts = pts;
+                    m_videoQueue.push(std::move(packet));
+                }
+                if (reverseLastPts == AV_NOPTS_VALUE || !stepBackwardKeyframe(reverseLastPts, reverseRetries)) {
+                    NEAPU_LOGI("Reverse trick play reached the beginning");
+                    m_isEof.store(true);
+                    m_videoQueue.push(std::make_unique<Packet>(Packet::PacketType::Eof, -1));
+                    break;
+                }
+                continue;
+            }
+        }
         if (m_videoStream && packet->avPacket()->stream_index == m_videoStream->index) {
             m_videoQueue.push(std::move(packet));
         } else if (m_audioStream && packet->avPacket()->stream_index == m_audioStream->index) {
@@ -38,12 +38,17 @@ public:
     bool isEof() const { return m_isEof.load(); }
 
     void seek(double seconds, int serial, bool noFlush = false);
+    // 快进快退：1 仅输出视频关键帧，-1 在此基础上逐个关键帧向前回退，0 恢复正常。
+    // 立即生效，调用方随后应seek以丢弃已读出的包
+    void setTrickDirection(int direction) { m_trickDirection = direction; }
     void clear();
 
     double durationSeconds() const;
 
 private:
     void readThreadFunc();
+    // 反向快退时推送一个关键帧后回退到前一个关键帧，返回false表示已到开头
+    bool stepBackwardKeyframe(int64_t& lastPts, int& retries);
 
 private:
     AVFormatContext* m_fmtCtx{nullptr};
@@ -62,6 +67,7 @@ private:
 
     std::atomic_int m_serial{0};
     std::atomic_bool m_noFlush{false};
+    std::atomic_int m_trickDirection{0};
 };
 
 } // namespace media
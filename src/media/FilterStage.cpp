@@ -0,0 +1,302 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#include "FilterStage.h"
+#include <chrono>
+#include <cstdio>
+#include <logger.h>
+#include "Helper.h"
+#include "Metrics.h"
+extern "C" {
+#include <libavfilter/avfilter.h>
+#include <libavfilter/buffersink.h>
+#include <libavfilter/buffersrc.h>
+#include <libavutil/channel_layout.h>
+#include <libavutil/frame.h>
+#include <libavutil/pixdesc.h>
+#include <libavutil/samplefmt.h>
+}
+
+namespace media {
+static int64_t steadyNowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+FilterStage::FilterStage(MediaType type, const Config& config, OutputCallback callback)
+    : m_type(type)
+    , m_config(config)
+    , m_callback(std::move(callback))
+{
+    if (m_config.queueSize == 0) {
+        m_config.queueSize = 1;
+    }
+    NEAPU_LOGI("{} filter stage created: \"{}\", threads {}",
+        m_type == MediaType::Video ? "Video" : "Audio", m_config.description, m_config.threads);
+}
+FilterStage::~FilterStage()
+{
+    stop();
+}
+void FilterStage::start()
+{
+    stop();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = true;
+        m_resetPending = false;
+    }
+    m_filterThread = std::thread(&FilterStage::filterThreadFunc, this);
+}
+void FilterStage::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+        m_queue.clear();
+        m_clearToken++;
+        m_condVar.notify_all();
+    }
+    if (m_filterThread.joinable()) {
+        m_filterThread.join();
+    }
+}
+void FilterStage::push(FramePtr&& frame)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    const size_t token = m_clearToken;
+    m_condVar.wait(lock, [&]() {
+        return !m_running || m_clearToken != token || m_queue.size() < m_config.queueSize;
+    });
+    if (!m_running || m_clearToken != token) {
+        return;
+    }
+    m_queue.push_back(std::move(frame));
+    m_condVar.notify_all();
+}
+void FilterStage::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queue.clear();
+    m_clearToken++;
+    m_condVar.notify_all();
+}
+void FilterStage::reset()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_queue.clear();
+    m_clearToken++;
+    if (!m_running) {
+        return;
+    }
+    m_resetPending = true;
+    m_condVar.notify_all();
+    m_condVar.wait(lock, [this]() { return !m_running || (!m_resetPending && !m_busy); });
+}
+void FilterStage::filterThreadFunc()
+{
+    NEAPU_FUNC_TRACE;
+    for (;;) {
+        FramePtr frame;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condVar.wait(lock, [this]() { return !m_running || m_resetPending || !m_queue.empty(); });
+            if (!m_running) {
+                break;
+            }
+            if (m_resetPending) {
+                // 滤镜图内缓存的旧位置的帧（如去隔行的参考场、变速的重叠窗口）全部丢弃
+                freeGraph();
+                m_graphFailed = false;
+                m_resetPending = false;
+                m_condVar.notify_all();
+                continue;
+            }
+            frame = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_busy = true;
+            m_condVar.notify_all();
+        }
+
+        if (frame->type() == Frame::FrameType::EndOfStream) {
+            drain();
+            m_callback(std::move(frame));
+        } else {
+            process(std::move(frame));
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_busy = false;
+        m_condVar.notify_all();
+    }
+    freeGraph();
+}
+void FilterStage::process(FramePtr&& frame)
+{
+    AVFrame* avFrame = frame->avFrame();
+    if (inputChanged(avFrame)) {
+        // 分辨率或采样格式中途变化，先取出旧滤镜图中剩余的帧
+        drain();
+        m_graphFailed = !buildGraph(avFrame);
+    }
+    if (!m_graph) {
+        m_callback(std::move(frame));
+        return;
+    }
+
+    m_serial = frame->serial();
+    const int64_t startUs = steadyNowUs();
+    int ret = av_buffersrc_add_frame_flags(m_srcCtx, avFrame, AV_BUFFERSRC_FLAG_KEEP_REF);
+    if (ret < 0) {
+        NEAPU_LOGE("Failed to feed frame into filter graph: {}", getFFmpegErrorString(ret));
+        return;
+    }
+    pullFrames();
+
+    auto& metrics = Metrics::instance();
+    const char* prefix = m_type == MediaType::Video ? "filter.video" : "filter.audio";
+    metrics.add(std::string(prefix) + ".frames");
+    metrics.set(std::string(prefix) + ".process_us", steadyNowUs() - startUs);
+}
+void FilterStage::drain()
+{
+    if (!m_graph) {
+        return;
+    }
+    int ret = av_buffersrc_add_frame(m_srcCtx, nullptr);
+    if (ret >= 0) {
+        pullFrames();
+    }
+    freeGraph();
+}
+void FilterStage::pullFrames()
+{
+    for (;;) {
+        auto frame = std::make_unique<Frame>(Frame::FrameType::Normal, m_serial);
+        int ret = av_buffersink_get_frame(m_sinkCtx, frame->avFrame());
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+            break;
+        }
+        if (ret < 0) {
+            NEAPU_LOGE("Failed to get frame from filter graph: {}", getFFmpegErrorString(ret));
+            break;
+        }
+        // 如 fps、setpts 等滤镜会改变时间基
+        frame->avFrame()->time_base = av_buffersink_get_time_base(m_sinkCtx);
+        m_callback(std::move(frame));
+    }
+}
+bool FilterStage::inputChanged(const AVFrame* frame) const
+{
+    if (!m_graph && !m_graphFailed) {
+        return true;
+    }
+    if (m_inFormat != frame->format) {
+        return true;
+    }
+    if (m_type == MediaType::Video) {
+        return m_inWidth != frame->width || m_inHeight != frame->height;
+    }
+    const uint64_t mask = frame->ch_layout.order == AV_CHANNEL_ORDER_NATIVE ? frame->ch_layout.u.mask : 0;
+    return m_inSampleRate != frame->sample_rate || m_inChannels != frame->ch_layout.nb_channels || m_inChannelMask != mask;
+}
+bool FilterStage::buildGraph(const AVFrame* frame)
+{
+    freeGraph();
+    m_inWidth = frame->width;
+    m_inHeight = frame->height;
+    m_inFormat = frame->format;
+    m_inSampleRate = frame->sample_rate;
+    m_inChannels = frame->ch_layout.nb_channels;
+    m_inChannelMask = frame->ch_layout.order == AV_CHANNEL_ORDER_NATIVE ? frame->ch_layout.u.mask : 0;
+
+    m_graph = avfilter_graph_alloc();
+    if (!m_graph) {
+        NEAPU_LOGE("Failed to allocate filter graph");
+        return false;
+    }
+    m_graph->nb_threads = m_config.threads;
+
+    const bool isVideo = m_type == MediaType::Video;
+    AVRational timeBase = frame->time_base;
+    if (timeBase.num <= 0 || timeBase.den <= 0) {
+        timeBase = isVideo ? AVRational{1, 1'000'000} : AVRational{1, frame->sample_rate};
+    }
+    char args[512];
+    if (isVideo) {
+        AVRational sar = frame->sample_aspect_ratio;
+        if (sar.num <= 0 || sar.den <= 0) {
+            sar = AVRational{1, 1};
+        }
+        std::snprintf(args, sizeof(args), "video_size=%dx%d:pix_fmt=%d:time_base=%d/%d:pixel_aspect=%d/%d",
+            frame->width, frame->height, frame->format, timeBase.num, timeBase.den, sar.num, sar.den);
+    } else {
+        char layout[128];
+        av_channel_layout_describe(&frame->ch_layout, layout, sizeof(layout));
+        std::snprintf(args, sizeof(args), "time_base=%d/%d:sample_rate=%d:sample_fmt=%s:channel_layout=%s",
+            timeBase.num, timeBase.den, frame->sample_rate,
+            av_get_sample_fmt_name(static_cast<AVSampleFormat>(frame->format)), layout);
+    }
+
+    int ret = avfilter_graph_create_filter(&m_srcCtx, avfilter_get_by_name(isVideo ? "buffer" : "abuffer"),
+        "in", args, nullptr, m_graph);
+    if (ret < 0) {
+        NEAPU_LOGE("Failed to create filter source ({}): {}", args, getFFmpegErrorString(ret));
+        freeGraph();
+        return false;
+    }
+    ret = avfilter_graph_create_filter(&m_sinkCtx, avfilter_get_by_name(isVideo ? "buffersink" : "abuffersink"),
+        "out", nullptr, nullptr, m_graph);
+    if (ret < 0) {
+        NEAPU_LOGE("Failed to create filter sink: {}", getFFmpegErrorString(ret));
+        freeGraph();
+        return false;
+    }
+
+    // 描述中未连接的输入接到源，输出接到汇
+    AVFilterInOut* outputs = avfilter_inout_alloc();
+    AVFilterInOut* inputs = avfilter_inout_alloc();
+    if (!outputs || !inputs) {
+        avfilter_inout_free(&outputs);
+        avfilter_inout_free(&inputs);
+        freeGraph();
+        return false;
+    }
+    outputs->name = av_strdup("in");
+    outputs->filter_ctx = m_srcCtx;
+    outputs->pad_idx = 0;
+    outputs->next = nullptr;
+    inputs->name = av_strdup("out");
+    inputs->filter_ctx = m_sinkCtx;
+    inputs->pad_idx = 0;
+    inputs->next = nullptr;
+    ret = avfilter_graph_parse_ptr(m_graph, m_config.description.c_str(), &inputs, &outputs, nullptr);
+    avfilter_inout_free(&outputs);
+    avfilter_inout_free(&inputs);
+    if (ret < 0) {
+        NEAPU_LOGE("Failed to parse filter graph \"{}\": {}", m_config.description, getFFmpegErrorString(ret));
+        freeGraph();
+        return false;
+    }
+    ret = avfilter_graph_config(m_graph, nullptr);
+    if (ret < 0) {
+        NEAPU_LOGE("Failed to configure filter graph \"{}\": {}", m_config.description, getFFmpegErrorString(ret));
+        freeGraph();
+        return false;
+    }
+    NEAPU_LOGI("{} filter graph configured for input {}",
+        isVideo ? "Video" : "Audio", args);
+    return true;
+}
+void FilterStage::freeGraph()
+{
+    if (m_graph) {
+        avfilter_graph_free(&m_graph);
+    }
+    m_graph = nullptr;
+    m_srcCtx = nullptr;
+    m_sinkCtx = nullptr;
+}
+} // namespace media
@@ -0,0 +1,91 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "Frame.h"
+
+typedef struct AVFilterGraph AVFilterGraph;
+typedef struct AVFilterContext AVFilterContext;
+
+namespace media {
+
+// 解码和帧队列之间可选的 libavfilter 处理阶段，如去隔行、缩放、裁剪、变速。
+// 在独立线程中运行，输入为有界队列，滤镜耗时与解码流水并行，而不是串在解码之后。
+// 滤镜图按第一帧的参数延迟创建，输入参数变化时重建
+class FilterStage {
+public:
+    enum class MediaType {
+        Video,
+        Audio,
+    };
+    struct Config {
+        std::string description; // 滤镜图描述，如 "bwdif,crop=1920:800" 或 "atempo=1.5"
+        int threads{0}; // 滤镜图内部的切片线程数，0 表示自动
+        size_t queueSize{4}; // 输入队列的最大帧数
+    };
+    // 在滤镜线程回调，输出滤镜处理后的帧；EndOfStream 在滤镜图排空后原样输出
+    using OutputCallback = std::function<void(FramePtr&&)>;
+
+    FilterStage(MediaType type, const Config& config, OutputCallback callback);
+    ~FilterStage();
+    FilterStage(const FilterStage&) = delete;
+    FilterStage& operator=(const FilterStage&) = delete;
+
+    void start();
+    void stop();
+
+    // 送入一帧，队列满时阻塞，clear/reset/stop 时放弃
+    void push(FramePtr&& frame);
+    // 丢弃尚未处理的输入并唤醒阻塞在 push 上的线程，可在任意线程调用
+    void clear();
+    // Flush时由解码线程调用：丢弃输入，等待滤镜线程处理完当前帧并释放滤镜图，
+    // 返回后滤镜线程不再访问解码器状态，直到下一帧送入
+    void reset();
+
+private:
+    void filterThreadFunc();
+    void process(FramePtr&& frame);
+    void drain();
+    void pullFrames();
+    bool inputChanged(const AVFrame* frame) const;
+    bool buildGraph(const AVFrame* frame);
+    void freeGraph();
+
+private:
+    MediaType m_type;
+    Config m_config;
+    OutputCallback m_callback;
+
+    // 只在滤镜线程访问
+    AVFilterGraph* m_graph{nullptr};
+    AVFilterContext* m_srcCtx{nullptr};
+    AVFilterContext* m_sinkCtx{nullptr};
+    bool m_graphFailed{false}; // 当前输入参数下创建失败，参数不变时原样输出，不再重试
+    int m_serial{0};
+    int m_inWidth{0};
+    int m_inHeight{0};
+    int m_inFormat{-1};
+    int m_inSampleRate{0};
+    int m_inChannels{0};
+    uint64_t m_inChannelMask{0};
+
+    std::mutex m_mutex;
+    std::condition_variable m_condVar;
+    std::deque<FramePtr> m_queue;
+    size_t m_clearToken{0};
+    bool m_resetPending{false};
+    bool m_busy{false};
+    bool m_running{false};
+    std::thread m_filterThread;
+};
+
+} // namespace media
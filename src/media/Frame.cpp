@@ -11,6 +11,7 @@ extern "C" {
 #include <libavutil/pixfmt.h>
 #include <libavutil/avutil.h>
 #include <libavutil/channel_layout.h>
+#include <libavutil/samplefmt.h>
 #include <libavutil/rational.h>
 #include <libavutil/hwcontext.h>
 }
@@ -55,6 +56,17 @@ Frame& Frame::operator=(Frame&& other) noexcept
     return *this;
 }
 
+std::unique_ptr<Frame> Frame::ref() const
+{
+    auto frame = std::make_unique<Frame>(m_type, m_serial);
+    if (m_avFrame && m_avFrame->buf[0]) {
+        if (av_frame_ref(frame->m_avFrame, m_avFrame) < 0) {
+            return nullptr;
+        }
+    }
+    return frame;
+}
+
 void Frame::copyMetaDataFrom(const Frame& other)
 {
     if (!m_avFrame || !other.m_avFrame) return;
@@ -67,6 +79,15 @@ void Frame::copyMetaDataFrom(const Frame& other)
     m_avFrame->colorspace = other.m_avFrame->colorspace;
     m_avFrame->color_range = other.m_avFrame->color_range;
 }
+size_t Frame::dataSize() const
+{
+    if (!m_avFrame) return 0;
+    size_t size = 0;
+    for (const auto* buf : m_avFrame->buf) {
+        if (buf) size += buf->size;
+    }
+    return size;
+}
 const uint8_t* Frame::data(int index) const
 {
     if (!m_avFrame || index < 0 || index >= AV_NUM_DATA_POINTERS) return nullptr;
@@ -125,6 +146,11 @@ Frame::PixelFormat Frame::pixelFormat() const
     case AV_PIX_FMT_YUV420P: return PixelFormat::YUV420P;
     case AV_PIX_FMT_NV12: return PixelFormat::NV12;
     case AV_PIX_FMT_P010: return PixelFormat::P010;
+    case AV_PIX_FMT_YUV420P10LE: return PixelFormat::YUV420P10;
+    case AV_PIX_FMT_YUV422P: return PixelFormat::YUV422P;
+    case AV_PIX_FMT_YUV422P10LE: return PixelFormat::YUV422P10;
+    case AV_PIX_FMT_YUV444P: return PixelFormat::YUV444P;
+    case AV_PIX_FMT_YUV444P10LE: return PixelFormat::YUV444P10;
     case AV_PIX_FMT_D3D11: return PixelFormat::D3D11Texture2D;
     case AV_PIX_FMT_VAAPI: return PixelFormat::Vaapi;
     case AV_PIX_FMT_VIDEOTOOLBOX: return PixelFormat::VideoToolbox;
@@ -132,6 +158,29 @@ Frame::PixelFormat Frame::pixelFormat() const
     }
 }
 
+int Frame::avPixelFormat() const
+{
+    return m_avFrame ? m_avFrame->format : AV_PIX_FMT_NONE;
+}
+
+int Frame::toAVPixelFormat(PixelFormat format)
+{
+    switch (format) {
+    case PixelFormat::YUV420P: return AV_PIX_FMT_YUV420P;
+    case PixelFormat::NV12: return AV_PIX_FMT_NV12;
+    case PixelFormat::P010: return AV_PIX_FMT_P010LE;
+    case PixelFormat::YUV420P10: return AV_PIX_FMT_YUV420P10LE;
+    case PixelFormat::YUV422P: return AV_PIX_FMT_YUV422P;
+    case PixelFormat::YUV422P10: return AV_PIX_FMT_YUV422P10LE;
+    case PixelFormat::YUV444P: return AV_PIX_FMT_YUV444P;
+    case PixelFormat::YUV444P10: return AV_PIX_FMT_YUV444P10LE;
+    case PixelFormat::D3D11Texture2D: return AV_PIX_FMT_D3D11;
+    case PixelFormat::Vaapi: return AV_PIX_FMT_VAAPI;
+    case PixelFormat::VideoToolbox: return AV_PIX_FMT_VIDEOTOOLBOX;
+    default: return AV_PIX_FMT_NONE;
+    }
+}
+
 Frame::ColorSpace Frame::colorSpace() const
 {
     if (!m_avFrame) return ColorSpace::BT601;
@@ -212,6 +261,21 @@ void* Frame::cvPixelBuffer() const
 }
 #endif
 
+Frame::SampleFormat Frame::sampleFormat() const
+{
+    if (m_avFrame && m_avFrame->format == AV_SAMPLE_FMT_FLT) {
+        return SampleFormat::Float32;
+    }
+    return SampleFormat::S16;
+}
+int Frame::toAVSampleFormat(SampleFormat format)
+{
+    return format == SampleFormat::Float32 ? AV_SAMPLE_FMT_FLT : AV_SAMPLE_FMT_S16;
+}
+int Frame::bytesPerSample(SampleFormat format)
+{
+    return format == SampleFormat::Float32 ? static_cast<int>(sizeof(float)) : static_cast<int>(sizeof(int16_t));
+}
 int Frame::sampleRate() const
 {
     return m_avFrame ? m_avFrame->sample_rate : 0;
@@ -247,6 +311,11 @@ Frame::PixelFormat Frame::swFormat()
     case AV_PIX_FMT_YUV420P: return PixelFormat::YUV420P;
     case AV_PIX_FMT_NV12: return PixelFormat::NV12;
     case AV_PIX_FMT_P010: return PixelFormat::P010;
+    case AV_PIX_FMT_YUV420P10LE: return PixelFormat::YUV420P10;
+    case AV_PIX_FMT_YUV422P: return PixelFormat::YUV422P;
+    case AV_PIX_FMT_YUV422P10LE: return PixelFormat::YUV422P10;
+    case AV_PIX_FMT_YUV444P: return PixelFormat::YUV444P;
+    case AV_PIX_FMT_YUV444P10LE: return PixelFormat::YUV444P10;
     default: return PixelFormat::None;
     }
 }
@@ -31,6 +31,9 @@ public:
     int serial() const { return m_serial; }
     FrameType type() const { return m_type; }
 
+    // 新建一个引用同一数据缓冲区的帧，不拷贝像素，硬件帧同样引用同一表面
+    std::unique_ptr<Frame> ref() const;
+
     void copyMetaDataFrom(const Frame& other);
 
     const uint8_t* data(int index) const;
@@ -46,11 +49,18 @@ public:
         YUV420P,
         NV12,
         P010,
+        YUV420P10,
+        YUV422P,
+        YUV422P10,
+        YUV444P,
+        YUV444P10,
         D3D11Texture2D,
         Vaapi,
         VideoToolbox,
     };
     PixelFormat pixelFormat() const;
+    int avPixelFormat() const; // AVPixelFormat
+    static int toAVPixelFormat(PixelFormat format);
     enum class ColorSpace {
         BT601, // 其他全部退化到BT601
         BT709,
@@ -80,13 +90,23 @@ public:
     void* cvPixelBuffer() const;
 #endif
 
-    // audio, 格式固定为S16LE
+    // audio, 解码输出为交错格式，S16LE或float32
+    enum class SampleFormat {
+        S16,
+        Float32,
+    };
+    SampleFormat sampleFormat() const;
+    static int toAVSampleFormat(SampleFormat format); // AVSampleFormat
+    static int bytesPerSample(SampleFormat format);
     int sampleRate() const;
     int channels() const;
     int64_t nbSamples() const;
 
     AVFrame* avFrame();
 
+    // 引用的数据缓冲区总字节数，用于帧缓存的内存统计
+    size_t dataSize() const;
+
     PixelFormat swFormat();
 
 private:
@@ -0,0 +1,249 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#include "FrameReader.h"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <logger.h>
+#include "DecodeThreading.h"
+#include "Helper.h"
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libswscale/swscale.h>
+}
+
+namespace media {
+FrameReader::FrameReader(const std::string& url, MediaType type, int threadCount, int lowres)
+    : m_type(type)
+{
+    int ret = avformat_open_input(&m_fmtCtx, url.c_str(), nullptr, nullptr);
+    if (ret < 0) {
+        std::string errStr = getFFmpegErrorString(ret);
+        NEAPU_LOGE("FrameReader failed to open input file {}: {}", url, errStr);
+        throw std::runtime_error("Failed to open input file: " + errStr);
+    }
+    ret = avformat_find_stream_info(m_fmtCtx, nullptr);
+    if (ret < 0) {
+        std::string errStr = getFFmpegErrorString(ret);
+        avformat_close_input(&m_fmtCtx);
+        NEAPU_LOGE("FrameReader failed to find stream info for file {}: {}", url, errStr);
+        throw std::runtime_error("Failed to find stream info: " + errStr);
+    }
+
+    const AVMediaType mediaType = type == MediaType::Video ? AVMEDIA_TYPE_VIDEO : AVMEDIA_TYPE_AUDIO;
+    const AVCodec* codec = nullptr;
+    int streamIndex = av_find_best_stream(m_fmtCtx, mediaType, -1, -1, &codec, 0);
+    if (streamIndex < 0 || !codec) {
+        avformat_close_input(&m_fmtCtx);
+        NEAPU_LOGE("FrameReader found no {} stream in file {}", type == MediaType::Video ? "video" : "audio", url);
+        throw std::runtime_error("No suitable stream found");
+    }
+    m_stream = m_fmtCtx->streams[streamIndex];
+    // 其他流不读，减少解复用开销
+    for (unsigned int i = 0; i < m_fmtCtx->nb_streams; i++) {
+        if (static_cast<int>(i) != streamIndex) {
+            m_fmtCtx->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+
+    m_codecCtx = avcodec_alloc_context3(codec);
+    m_packet = av_packet_alloc();
+    if (!m_codecCtx || !m_packet) {
+        avcodec_free_context(&m_codecCtx);
+        av_packet_free(&m_packet);
+        avformat_close_input(&m_fmtCtx);
+        throw std::runtime_error("Failed to allocate decoder for FrameReader");
+    }
+    avcodec_parameters_to_context(m_codecCtx, m_stream->codecpar);
+    m_codecCtx->pkt_timebase = m_stream->time_base;
+
+    DecodeThreadConfig threadConfig;
+    threadConfig.threadCount = threadCount;
+    const auto threadSettings = resolveDecodeThreadSettings(threadConfig,
+        codec,
+        m_codecCtx->width,
+        m_codecCtx->height,
+        static_cast<int>(std::thread::hardware_concurrency()));
+    m_codecCtx->thread_count = threadSettings.threadCount;
+    m_codecCtx->thread_type = threadSettings.threadType;
+    if (lowres > 0 && codec->max_lowres > 0) {
+        m_codecCtx->lowres = std::min(lowres, static_cast<int>(codec->max_lowres));
+    }
+
+    ret = avcodec_open2(m_codecCtx, codec, nullptr);
+    if (ret < 0) {
+        std::string errStr = getFFmpegErrorString(ret);
+        avcodec_free_context(&m_codecCtx);
+        av_packet_free(&m_packet);
+        avformat_close_input(&m_fmtCtx);
+        NEAPU_LOGE("FrameReader failed to open codec: {}", errStr);
+        throw std::runtime_error("Failed to open codec: " + errStr);
+    }
+}
+FrameReader::~FrameReader()
+{
+    if (m_swsCtx) {
+        sws_freeContext(m_swsCtx);
+        m_swsCtx = nullptr;
+    }
+    avcodec_free_context(&m_codecCtx);
+    av_packet_free(&m_packet);
+    if (m_fmtCtx) {
+        avformat_close_input(&m_fmtCtx);
+    }
+}
+int64_t FrameReader::durationUs() const
+{
+    if (m_stream->duration != AV_NOPTS_VALUE && m_stream->duration > 0) {
+        return av_rescale_q(m_stream->duration, m_stream->time_base, AVRational{1, 1000000});
+    }
+    if (m_fmtCtx->duration != AV_NOPTS_VALUE && m_fmtCtx->duration > 0) {
+        return m_fmtCtx->duration;
+    }
+    return 0;
+}
+int64_t FrameReader::startTimeUs() const
+{
+    if (m_stream->start_time != AV_NOPTS_VALUE) {
+        return av_rescale_q(m_stream->start_time, m_stream->time_base, AVRational{1, 1000000});
+    }
+    return 0;
+}
+int FrameReader::width() const
+{
+    return m_codecCtx->width;
+}
+int FrameReader::height() const
+{
+    return m_codecCtx->height;
+}
+void FrameReader::setKeyframeOnly(bool keyframeOnly)
+{
+    m_keyframeOnly = keyframeOnly;
+    m_codecCtx->skip_frame = keyframeOnly ? AVDISCARD_NONKEY : AVDISCARD_DEFAULT;
+}
+void FrameReader::setFastDecode(bool fastDecode)
+{
+    m_codecCtx->skip_loop_filter = fastDecode ? AVDISCARD_ALL : AVDISCARD_DEFAULT;
+}
+int64_t FrameReader::keyframeBeforeUs(int64_t positionUs) const
+{
+    const int64_t timestamp = av_rescale_q(positionUs, AVRational{1, 1000000}, m_stream->time_base);
+    const int index = av_index_search_timestamp(m_stream, timestamp, AVSEEK_FLAG_BACKWARD);
+    if (index < 0) {
+        return -1;
+    }
+    const AVIndexEntry* entry = avformat_index_get_entry(m_stream, index);
+    if (!entry) {
+        return -1;
+    }
+    return av_rescale_q(entry->timestamp, m_stream->time_base, AVRational{1, 1000000});
+}
+bool FrameReader::seek(int64_t positionUs)
+{
+    const int64_t timestamp = av_rescale_q(positionUs, AVRational{1, 1000000}, m_stream->time_base);
+    int ret = av_seek_frame(m_fmtCtx, m_stream->index, timestamp, AVSEEK_FLAG_BACKWARD);
+    if (ret < 0) {
+        NEAPU_LOGW("FrameReader failed to seek to {} us: {}", positionUs, getFFmpegErrorString(ret));
+        return false;
+    }
+    avcodec_flush_buffers(m_codecCtx);
+    m_draining = false;
+    m_eof = false;
+    return true;
+}
+bool FrameReader::sendNextPacket()
+{
+    for (;;) {
+        int ret = av_read_frame(m_fmtCtx, m_packet);
+        if (ret < 0) {
+            if (ret != AVERROR_EOF) {
+                NEAPU_LOGW("FrameReader read error: {}", getFFmpegErrorString(ret));
+            }
+            // 送入空包取出解码器中剩余的帧
+            avcodec_send_packet(m_codecCtx, nullptr);
+            m_draining = true;
+            return true;
+        }
+        if (m_packet->stream_index != m_stream->index ||
+            (m_keyframeOnly && !(m_packet->flags & AV_PKT_FLAG_KEY))) {
+            av_packet_unref(m_packet);
+            continue;
+        }
+        ret = avcodec_send_packet(m_codecCtx, m_packet);
+        av_packet_unref(m_packet);
+        if (ret < 0 && ret != AVERROR(EAGAIN)) {
+            NEAPU_LOGW("FrameReader failed to send packet: {}", getFFmpegErrorString(ret));
+            continue;
+        }
+        return true;
+    }
+}
+FramePtr FrameReader::readFrame()
+{
+    if (m_eof) {
+        return nullptr;
+    }
+    for (;;) {
+        auto frame = std::make_unique<Frame>(Frame::FrameType::Normal, m_serial);
+        int ret = avcodec_receive_frame(m_codecCtx, frame->avFrame());
+        if (ret == 0) {
+            frame->avFrame()->time_base = m_stream->time_base;
+            if (m_type == MediaType::Video) {
+                return convert(std::move(frame));
+            }
+            return frame;
+        }
+        if (ret == AVERROR_EOF || (ret == AVERROR(EAGAIN) && m_draining)) {
+            m_eof = true;
+            return nullptr;
+        }
+        if (ret != AVERROR(EAGAIN)) {
+            NEAPU_LOGW("FrameReader failed to receive frame: {}", getFFmpegErrorString(ret));
+            m_eof = true;
+            return nullptr;
+        }
+        sendNextPacket();
+    }
+}
+FramePtr FrameReader::convert(FramePtr&& frame)
+{
+    AVFrame* src = frame->avFrame();
+    const int dstW = m_videoOutput.width > 0 ? m_videoOutput.width : src->width;
+    const int dstH = m_videoOutput.height > 0 ? m_videoOutput.height : src->height;
+    const int dstFormat = m_videoOutput.pixelFormat >= 0 ? m_videoOutput.pixelFormat : src->format;
+    if (dstW == src->width && dstH == src->height && dstFormat == src->format) {
+        return frame;
+    }
+
+    const int flags = m_videoOutput.swsFlags != 0 ? m_videoOutput.swsFlags : SWS_BILINEAR;
+    m_swsCtx = sws_getCachedContext(m_swsCtx,
+        src->width, src->height, static_cast<AVPixelFormat>(src->format),
+        dstW, dstH, static_cast<AVPixelFormat>(dstFormat),
+        flags, nullptr, nullptr, nullptr);
+    if (!m_swsCtx) {
+        NEAPU_LOGE("FrameReader failed to create SwsContext");
+        return nullptr;
+    }
+
+    auto dstFrame = std::make_unique<Frame>(Frame::FrameType::Normal, frame->serial());
+    dstFrame->avFrame()->format = dstFormat;
+    dstFrame->avFrame()->width = dstW;
+    dstFrame->avFrame()->height = dstH;
+    int ret = av_frame_get_buffer(dstFrame->avFrame(), 32);
+    if (ret < 0) {
+        NEAPU_LOGE("FrameReader failed to allocate frame buffer: {}", getFFmpegErrorString(ret));
+        return nullptr;
+    }
+    ret = sws_scale_frame(m_swsCtx, dstFrame->avFrame(), src);
+    if (ret < 0) {
+        NEAPU_LOGE("FrameReader failed to scale frame: {}", getFFmpegErrorString(ret));
+        return nullptr;
+    }
+    dstFrame->copyMetaDataFrom(*frame);
+    return dstFrame;
+}
+} // namespace media
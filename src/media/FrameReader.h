@@ -0,0 +1,81 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+#include <string>
+#include "Frame.h"
+
+typedef struct AVFormatContext AVFormatContext;
+typedef struct AVStream AVStream;
+typedef struct AVCodecContext AVCodecContext;
+typedef struct AVPacket AVPacket;
+typedef struct SwsContext SwsContext;
+
+namespace media {
+
+// 同步读取解码帧的工具，自带独立的解复用和软件解码上下文，
+// 供倒放、缩略图、拖动预览等需要随机访问的场景使用，不影响主播放管线
+class FrameReader {
+public:
+    enum class MediaType {
+        Video,
+        Audio,
+    };
+    // 视频输出格式，宽高为0表示保持原尺寸，pixelFormat为-1表示保持解码格式
+    struct VideoOutput {
+        int width{0};
+        int height{0};
+        int pixelFormat{-1}; // AVPixelFormat
+        int swsFlags{0}; // 0 表示 SWS_BILINEAR
+    };
+
+    // lowres 为解码器内部降分辨率的级数（1/2^lowres），解码器不支持时忽略
+    FrameReader(const std::string& url, MediaType type, int threadCount = 0, int lowres = 0);
+    ~FrameReader();
+    FrameReader(const FrameReader&) = delete;
+    FrameReader& operator=(const FrameReader&) = delete;
+
+    AVStream* stream() const { return m_stream; }
+    int64_t durationUs() const;
+    int64_t startTimeUs() const;
+    // 源视频尺寸
+    int width() const;
+    int height() const;
+
+    void setVideoOutput(const VideoOutput& output) { m_videoOutput = output; }
+    const VideoOutput& videoOutput() const { return m_videoOutput; }
+    // 只读取并解码关键帧
+    void setKeyframeOnly(bool keyframeOnly);
+    // 跳过环路滤波，画质略降，解码更快，适合缩略图
+    void setFastDecode(bool fastDecode);
+    // 按索引查找不晚于 positionUs 的关键帧时间，不读文件；没有索引时返回-1
+    int64_t keyframeBeforeUs(int64_t positionUs) const;
+    // 输出帧携带的serial
+    void setSerial(int serial) { m_serial = serial; }
+
+    // 跳转到不晚于 positionUs 的关键帧，并清空解码器
+    bool seek(int64_t positionUs);
+    // 读取下一帧，到达结尾或出错返回空
+    FramePtr readFrame();
+    bool isEof() const { return m_eof; }
+
+private:
+    bool sendNextPacket();
+    FramePtr convert(FramePtr&& frame);
+
+private:
+    AVFormatContext* m_fmtCtx{nullptr};
+    AVStream* m_stream{nullptr};
+    AVCodecContext* m_codecCtx{nullptr};
+    AVPacket* m_packet{nullptr};
+    SwsContext* m_swsCtx{nullptr};
+    VideoOutput m_videoOutput;
+    MediaType m_type;
+    int m_serial{0};
+    bool m_keyframeOnly{false};
+    bool m_draining{false};
+    bool m_eof{false};
+};
+
+} // namespace media
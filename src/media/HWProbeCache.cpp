@@ -0,0 +1,234 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#include "HWProbeCache.h"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <logger.h>
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/avutil.h>
+#include <libavutil/pixdesc.h>
+}
+#ifdef _WIN32
+#include <dxgi.h>
+#elif defined(__APPLE__)
+#include <sys/sysctl.h>
+#elif defined(__linux__)
+#include <sys/utsname.h>
+#endif
+
+namespace media {
+static constexpr const char* CACHE_FILE_HEADER = "# neapu hw probe cache v1";
+
+static int64_t currentTimeSeconds()
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static int resolutionClass(int width, int height)
+{
+    const int64_t pixels = static_cast<int64_t>(width) * height;
+    if (pixels <= 720 * 576) return 0;
+    if (pixels <= 1920 * 1088) return 1;
+    if (pixels <= 4096 * 2304) return 2;
+    return 3;
+}
+
+#ifdef __linux__
+static std::string readFirstLine(const std::string& path)
+{
+    std::ifstream file(path);
+    std::string line;
+    if (file) {
+        std::getline(file, line);
+    }
+    return line;
+}
+#endif
+
+static std::string driverFingerprint()
+{
+    std::string result;
+#ifdef _WIN32
+    IDXGIFactory1* factory = nullptr;
+    if (SUCCEEDED(CreateDXGIFactory1(__uuidof(IDXGIFactory1), reinterpret_cast<void**>(&factory)))) {
+        IDXGIAdapter1* adapter = nullptr;
+        for (UINT i = 0; factory->EnumAdapters1(i, &adapter) != DXGI_ERROR_NOT_FOUND; i++) {
+            DXGI_ADAPTER_DESC1 desc{};
+            adapter->GetDesc1(&desc);
+            LARGE_INTEGER umdVersion{};
+            adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &umdVersion);
+            result += std::to_string(desc.VendorId) + ":" + std::to_string(desc.DeviceId) + ":" +
+                      std::to_string(umdVersion.QuadPart) + ";";
+            adapter->Release();
+        }
+        factory->Release();
+    }
+#elif defined(__APPLE__)
+    // VideoToolbox 随系统更新
+    char version[64] = {0};
+    size_t size = sizeof(version);
+    if (sysctlbyname("kern.osproductversion", version, &size, nullptr, 0) == 0) {
+        result += std::string("macos=") + version + ";";
+    }
+#elif defined(__linux__)
+    utsname name{};
+    if (uname(&name) == 0) {
+        result += std::string("kernel=") + name.release + ";";
+    }
+    for (const char* module : {"nvidia", "amdgpu", "i915", "xe"}) {
+        auto version = readFirstLine(std::string("/sys/module/") + module + "/version");
+        if (!version.empty()) {
+            result += std::string(module) + "=" + version + ";";
+        }
+    }
+    if (const char* vaDriver = std::getenv("LIBVA_DRIVER_NAME")) {
+        result += std::string("libva=") + vaDriver + ";";
+    }
+#endif
+    return result;
+}
+
+HWProbeCache::HWProbeCache()
+    : m_fingerprint(environmentFingerprint())
+{
+}
+HWProbeCache& HWProbeCache::instance()
+{
+    static HWProbeCache instance;
+    return instance;
+}
+HWProbeCache::Key HWProbeCache::makeKey(const AVCodecParameters* codecpar, int method)
+{
+    Key key;
+    key.codecId = codecpar->codec_id;
+    key.profile = codecpar->profile;
+    key.resolutionClass = resolutionClass(codecpar->width, codecpar->height);
+    key.bitDepth = 8;
+    if (codecpar->bits_per_raw_sample > 0) {
+        key.bitDepth = codecpar->bits_per_raw_sample;
+    } else if (const auto* desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(codecpar->format))) {
+        key.bitDepth = desc->comp[0].depth;
+    }
+    key.method = method;
+    return key;
+}
+std::string HWProbeCache::environmentFingerprint()
+{
+    return std::string("ffmpeg=") + av_version_info() + ";avcodec=" + std::to_string(avcodec_version()) + ";" +
+           driverFingerprint();
+}
+void HWProbeCache::setStoragePath(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (path == m_storagePath) {
+        return;
+    }
+    m_storagePath = path;
+    loadLocked();
+}
+void HWProbeCache::setTtlSeconds(int64_t ttlSeconds)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ttlSeconds = ttlSeconds;
+}
+std::optional<bool> HWProbeCache::lookup(const Key& key)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return std::nullopt;
+    }
+    if (currentTimeSeconds() - it->second.timestamp > m_ttlSeconds) {
+        m_entries.erase(it);
+        return std::nullopt;
+    }
+    return it->second.ok;
+}
+void HWProbeCache::store(const Key& key, bool ok)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& entry = m_entries[key];
+    if (entry.ok == ok && currentTimeSeconds() - entry.timestamp < m_ttlSeconds / 2) {
+        return; // 结果未变且尚新，避免每次打开都写盘
+    }
+    entry.ok = ok;
+    entry.timestamp = currentTimeSeconds();
+    saveLocked();
+}
+void HWProbeCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    saveLocked();
+}
+void HWProbeCache::loadLocked()
+{
+    m_entries.clear();
+    if (m_storagePath.empty()) {
+        return;
+    }
+    std::ifstream file(m_storagePath);
+    if (!file) {
+        return;
+    }
+
+    std::string line;
+    if (!std::getline(file, line) || line != CACHE_FILE_HEADER) {
+        NEAPU_LOGW("Ignoring HW probe cache with unknown header: {}", m_storagePath);
+        return;
+    }
+    if (!std::getline(file, line) || line != "fingerprint " + m_fingerprint) {
+        NEAPU_LOGI("HW probe cache invalidated by FFmpeg or driver change");
+        return;
+    }
+    const int64_t now = currentTimeSeconds();
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        Key key;
+        Entry entry;
+        int ok = 0;
+        if (!(iss >> key.codecId >> key.profile >> key.resolutionClass >> key.bitDepth >> key.method >> ok >> entry.timestamp)) {
+            continue;
+        }
+        entry.ok = ok != 0;
+        if (now - entry.timestamp <= m_ttlSeconds) {
+            m_entries[key] = entry;
+        }
+    }
+    NEAPU_LOGI("Loaded {} HW probe cache entries from {}", m_entries.size(), m_storagePath);
+}
+void HWProbeCache::saveLocked() const
+{
+    if (m_storagePath.empty()) {
+        return;
+    }
+    // 先写临时文件再替换，避免写到一半崩溃留下损坏的缓存
+    const std::string tmpPath = m_storagePath + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::trunc);
+        if (!file) {
+            NEAPU_LOGW("Failed to write HW probe cache: {}", tmpPath);
+            return;
+        }
+        file << CACHE_FILE_HEADER << "\n";
+        file << "fingerprint " << m_fingerprint << "\n";
+        for (const auto& [key, entry] : m_entries) {
+            file << key.codecId << " " << key.profile << " " << key.resolutionClass << " " << key.bitDepth << " "
+                 << key.method << " " << (entry.ok ? 1 : 0) << " " << entry.timestamp << "\n";
+        }
+    }
+    // rename 在 POSIX 和 Windows 上都直接替换目标，其他进程总能看到完整的旧文件或新文件
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, m_storagePath, ec);
+    if (ec) {
+        NEAPU_LOGW("Failed to replace HW probe cache {}: {}", m_storagePath, ec.message());
+        std::filesystem::remove(tmpPath, ec);
+    }
+}
+} // namespace media
@@ -0,0 +1,62 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+#include <compare>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+
+typedef struct AVCodecParameters AVCodecParameters;
+
+namespace media {
+
+// 硬解能力探测结果缓存，内存中保存并可持久化到磁盘，
+// 条目带有效期，FFmpeg 或显卡驱动版本变化时整体失效
+class HWProbeCache {
+public:
+    struct Key {
+        int codecId{0};
+        int profile{0};
+        int resolutionClass{0};
+        int bitDepth{8};
+        int method{0}; // VideoDecoder::HWAccelMethod
+
+        auto operator<=>(const Key&) const = default;
+    };
+
+    static HWProbeCache& instance();
+    static Key makeKey(const AVCodecParameters* codecpar, int method);
+    // FFmpeg 版本与驱动版本组成的环境指纹
+    static std::string environmentFingerprint();
+
+    // 设置持久化文件路径并加载，空路径表示只在内存中缓存
+    void setStoragePath(const std::string& path);
+    void setTtlSeconds(int64_t ttlSeconds);
+
+    // 返回缓存的探测结果，无记录或已过期返回空
+    std::optional<bool> lookup(const Key& key);
+    void store(const Key& key, bool ok);
+    void clear();
+
+private:
+    HWProbeCache();
+    void loadLocked();
+    void saveLocked() const;
+
+private:
+    struct Entry {
+        bool ok{false};
+        int64_t timestamp{0}; // 秒
+    };
+    std::mutex m_mutex;
+    std::map<Key, Entry> m_entries;
+    std::string m_storagePath;
+    std::string m_fingerprint;
+    int64_t m_ttlSeconds{7 * 24 * 3600};
+};
+
+} // namespace media
@@ -0,0 +1,39 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#include "Metrics.h"
+
+namespace media {
+Metrics& Metrics::instance()
+{
+    static Metrics instance;
+    return instance;
+}
+void Metrics::add(const std::string& name, int64_t delta)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_values[name] += delta;
+}
+void Metrics::set(const std::string& name, int64_t value)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_values[name] = value;
+}
+int64_t Metrics::value(const std::string& name) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_values.find(name);
+    return it != m_values.end() ? it->second : 0;
+}
+std::map<std::string, int64_t> Metrics::snapshot() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_values;
+}
+void Metrics::reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_values.clear();
+}
+} // namespace media
@@ -0,0 +1,33 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace media {
+
+// 进程内的运行指标，计数器和瞬时值共用一张表，按名称区分，如 "video.degrade.level"
+class Metrics {
+public:
+    static Metrics& instance();
+
+    void add(const std::string& name, int64_t delta = 1);
+    void set(const std::string& name, int64_t value);
+    int64_t value(const std::string& name) const;
+
+    std::map<std::string, int64_t> snapshot() const;
+    void reset();
+
+private:
+    Metrics() = default;
+
+private:
+    mutable std::mutex m_mutex;
+    std::map<std::string, int64_t> m_values;
+};
+
+} // namespace media
@@ -54,4 +54,16 @@ size_t Packet::size() const
     return 0;
 }
 
+std::unique_ptr<Packet> Packet::clone() const
+{
+    auto packet = std::make_unique<Packet>(m_type, m_serial);
+    if (m_avPacket) {
+        int ret = av_packet_ref(packet->m_avPacket, m_avPacket);
+        if (ret < 0) {
+            throw std::runtime_error("Failed to reference AVPacket");
+        }
+    }
+    return packet;
+}
+
 } // namespace media
\ No newline at end of file
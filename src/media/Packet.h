@@ -30,6 +30,9 @@ public:
 
     size_t size() const;
 
+    // 引用同一份数据的新包，用于探测阶段的包重放
+    std::unique_ptr<Packet> clone() const;
+
     int serial() const { return m_serial; }
 
 private:
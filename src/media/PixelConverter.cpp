@@ -0,0 +1,128 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#include "PixelConverter.h"
+#include <algorithm>
+#include <thread>
+#include <logger.h>
+#include "Helper.h"
+#include "PixelKernels.h"
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixfmt.h>
+}
+
+namespace media {
+bool canFastConvert(int srcFormat, int dstFormat)
+{
+    if (dstFormat != AV_PIX_FMT_YUV420P) {
+        return false;
+    }
+    switch (srcFormat) {
+    case AV_PIX_FMT_NV12:
+    case AV_PIX_FMT_P010LE:
+    case AV_PIX_FMT_YUVJ420P:
+    case AV_PIX_FMT_YUV422P:
+    case AV_PIX_FMT_YUVJ422P:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool fastConvertPlanes(const AVFrame* src, AVFrame* dst, const PixelKernels& kernels)
+{
+    const int width = src->width;
+    const int height = src->height;
+    const int chromaWidth = (width + 1) / 2;
+    const int chromaHeight = (height + 1) / 2;
+
+    switch (src->format) {
+    case AV_PIX_FMT_NV12:
+        av_image_copy_plane(dst->data[0], dst->linesize[0], src->data[0], src->linesize[0], width, height);
+        for (int y = 0; y < chromaHeight; y++) {
+            kernels.deinterleaveUV8(src->data[1] + static_cast<ptrdiff_t>(y) * src->linesize[1],
+                dst->data[1] + static_cast<ptrdiff_t>(y) * dst->linesize[1],
+                dst->data[2] + static_cast<ptrdiff_t>(y) * dst->linesize[2],
+                chromaWidth);
+        }
+        break;
+    case AV_PIX_FMT_P010LE:
+        for (int y = 0; y < height; y++) {
+            kernels.narrow16To8(reinterpret_cast<const uint16_t*>(src->data[0] + static_cast<ptrdiff_t>(y) * src->linesize[0]),
+                dst->data[0] + static_cast<ptrdiff_t>(y) * dst->linesize[0],
+                width);
+        }
+        for (int y = 0; y < chromaHeight; y++) {
+            kernels.deinterleaveUV16To8(reinterpret_cast<const uint16_t*>(src->data[1] + static_cast<ptrdiff_t>(y) * src->linesize[1]),
+                dst->data[1] + static_cast<ptrdiff_t>(y) * dst->linesize[1],
+                dst->data[2] + static_cast<ptrdiff_t>(y) * dst->linesize[2],
+                chromaWidth);
+        }
+        break;
+    case AV_PIX_FMT_YUV422P:
+    case AV_PIX_FMT_YUVJ422P:
+        av_image_copy_plane(dst->data[0], dst->linesize[0], src->data[0], src->linesize[0], width, height);
+        for (int plane = 1; plane <= 2; plane++) {
+            for (int y = 0; y < chromaHeight; y++) {
+                const int row0 = 2 * y;
+                const int row1 = std::min(2 * y + 1, height - 1);
+                kernels.averageRows8(src->data[plane] + static_cast<ptrdiff_t>(row0) * src->linesize[plane],
+                    src->data[plane] + static_cast<ptrdiff_t>(row1) * src->linesize[plane],
+                    dst->data[plane] + static_cast<ptrdiff_t>(y) * dst->linesize[plane],
+                    chromaWidth);
+            }
+        }
+        break;
+    default:
+        NEAPU_LOGE("Unsupported fast conversion from pixel format {}", getAVPixelFormatString(src->format));
+        return false;
+    }
+    return true;
+}
+FramePtr fastConvert(FramePtr&& frame, int dstFormat)
+{
+    AVFrame* src = frame->avFrame();
+    const int srcFormat = src->format;
+    const bool fullRange = srcFormat == AV_PIX_FMT_YUVJ420P || srcFormat == AV_PIX_FMT_YUVJ422P;
+
+    // YUVJ420P 与 YUV420P 内存布局相同，只是范围不同，直接改标记
+    if (srcFormat == AV_PIX_FMT_YUVJ420P) {
+        src->format = dstFormat;
+        if (src->color_range == AVCOL_RANGE_UNSPECIFIED) {
+            src->color_range = AVCOL_RANGE_JPEG;
+        }
+        return std::move(frame);
+    }
+
+    auto retFrame = std::make_unique<Frame>(Frame::FrameType::Normal, frame->serial());
+    AVFrame* dst = retFrame->avFrame();
+    dst->format = dstFormat;
+    dst->width = src->width;
+    dst->height = src->height;
+    int ret = av_frame_get_buffer(dst, 32);
+    if (ret < 0) {
+        NEAPU_LOGE("Failed to allocate buffer for converted frame: {}", getFFmpegErrorString(ret));
+        return nullptr;
+    }
+    retFrame->copyMetaDataFrom(*frame);
+    if (fullRange && dst->color_range == AVCOL_RANGE_UNSPECIFIED) {
+        dst->color_range = AVCOL_RANGE_JPEG;
+    }
+
+    if (!fastConvertPlanes(src, dst, pixelKernels())) {
+        return nullptr;
+    }
+    return retFrame;
+}
+int swsThreadCount(int width, int height)
+{
+    // 约每四分之一个1080p画面一个条带，最多占用一半核心，剩余留给解码线程
+    const int64_t pixels = static_cast<int64_t>(width) * height;
+    const int slices = static_cast<int>(pixels / (960 * 540));
+    const int maxThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) / 2);
+    return std::clamp(slices, 1, maxThreads);
+}
+} // namespace media
@@ -0,0 +1,25 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+#include "Frame.h"
+
+namespace media {
+struct PixelKernels;
+
+// 同尺寸的常见像素格式转换走手写SIMD内核，不经过sws
+// 支持：NV12/P010/YUV422P/YUVJ422P -> YUV420P，YUVJ420P -> YUV420P（仅改标记，不拷贝）
+bool canFastConvert(int srcFormat, int dstFormat);
+
+// 调用前需用 canFastConvert 确认支持，失败返回 nullptr
+FramePtr fastConvert(FramePtr&& frame, int dstFormat);
+
+// 把 src 转换写入已分配好的同尺寸 YUV420P 帧 dst，不处理 YUVJ420P。
+// kernels 指定使用的内核实现，测试用它比较各实现的输出
+bool fastConvertPlanes(const AVFrame* src, AVFrame* dst, const PixelKernels& kernels);
+
+// sws 转换按水平条带切分时使用的线程数
+int swsThreadCount(int width, int height);
+
+} // namespace media
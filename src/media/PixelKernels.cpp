@@ -0,0 +1,239 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#include "PixelKernels.h"
+#include "CpuFeatures.h"
+#include <algorithm>
+#if defined(NEAPU_ARCH_X86)
+#include <immintrin.h>
+#elif defined(NEAPU_ARCH_ARM64)
+#include <arm_neon.h>
+#endif
+
+namespace media {
+static inline uint8_t roundNarrow(uint16_t value)
+{
+    return static_cast<uint8_t>(std::min((static_cast<uint32_t>(value) + 0x80) >> 8, 0xFFu));
+}
+
+static void deinterleaveUV8Scalar(const uint8_t* src, uint8_t* dstU, uint8_t* dstV, int width)
+{
+    for (int i = 0; i < width; i++) {
+        dstU[i] = src[2 * i];
+        dstV[i] = src[2 * i + 1];
+    }
+}
+static void narrow16To8Scalar(const uint16_t* src, uint8_t* dst, int width)
+{
+    for (int i = 0; i < width; i++) {
+        dst[i] = roundNarrow(src[i]);
+    }
+}
+static void deinterleaveUV16To8Scalar(const uint16_t* src, uint8_t* dstU, uint8_t* dstV, int width)
+{
+    for (int i = 0; i < width; i++) {
+        dstU[i] = roundNarrow(src[2 * i]);
+        dstV[i] = roundNarrow(src[2 * i + 1]);
+    }
+}
+static void averageRows8Scalar(const uint8_t* a, const uint8_t* b, uint8_t* dst, int width)
+{
+    for (int i = 0; i < width; i++) {
+        dst[i] = static_cast<uint8_t>((a[i] + b[i] + 1) >> 1);
+    }
+}
+
+#if defined(NEAPU_ARCH_X86)
+static void deinterleaveUV8Sse2(const uint8_t* src, uint8_t* dstU, uint8_t* dstV, int width)
+{
+    const __m128i lowMask = _mm_set1_epi16(0x00FF);
+    int i = 0;
+    for (; i + 16 <= width; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i + 16));
+        const __m128i u = _mm_packus_epi16(_mm_and_si128(a, lowMask), _mm_and_si128(b, lowMask));
+        const __m128i v = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dstU + i), u);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dstV + i), v);
+    }
+    deinterleaveUV8Scalar(src + 2 * i, dstU + i, dstV + i, width - i);
+}
+static inline __m128i roundNarrowSse2(__m128i a, __m128i b)
+{
+    const __m128i bias = _mm_set1_epi16(0x80);
+    a = _mm_srli_epi16(_mm_adds_epu16(a, bias), 8);
+    b = _mm_srli_epi16(_mm_adds_epu16(b, bias), 8);
+    return _mm_packus_epi16(a, b);
+}
+static void narrow16To8Sse2(const uint16_t* src, uint8_t* dst, int width)
+{
+    int i = 0;
+    for (; i + 16 <= width; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), roundNarrowSse2(a, b));
+    }
+    narrow16To8Scalar(src + i, dst + i, width - i);
+}
+static void deinterleaveUV16To8Sse2(const uint16_t* src, uint8_t* dstU, uint8_t* dstV, int width)
+{
+    const __m128i lowMask = _mm_set1_epi16(0x00FF);
+    int i = 0;
+    for (; i + 16 <= width; i += 16) {
+        const auto* p = reinterpret_cast<const __m128i*>(src + 2 * i);
+        // 先整体转8位，得到交错的UV字节，再按NV12方式拆分
+        const __m128i uv0 = roundNarrowSse2(_mm_loadu_si128(p), _mm_loadu_si128(p + 1));
+        const __m128i uv1 = roundNarrowSse2(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3));
+        const __m128i u = _mm_packus_epi16(_mm_and_si128(uv0, lowMask), _mm_and_si128(uv1, lowMask));
+        const __m128i v = _mm_packus_epi16(_mm_srli_epi16(uv0, 8), _mm_srli_epi16(uv1, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dstU + i), u);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dstV + i), v);
+    }
+    deinterleaveUV16To8Scalar(src + 2 * i, dstU + i, dstV + i, width - i);
+}
+static void averageRows8Sse2(const uint8_t* a, const uint8_t* b, uint8_t* dst, int width)
+{
+    int i = 0;
+    for (; i + 16 <= width; i += 16) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_avg_epu8(va, vb));
+    }
+    averageRows8Scalar(a + i, b + i, dst + i, width - i);
+}
+
+// AVX2 的 pack 指令按128位通道独立执行，结果需要用 permute4x64 还原顺序
+NEAPU_TARGET_AVX2 static void deinterleaveUV8Avx2(const uint8_t* src, uint8_t* dstU, uint8_t* dstV, int width)
+{
+    const __m256i lowMask = _mm256_set1_epi16(0x00FF);
+    int i = 0;
+    for (; i + 32 <= width; i += 32) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 2 * i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 2 * i + 32));
+        __m256i u = _mm256_packus_epi16(_mm256_and_si256(a, lowMask), _mm256_and_si256(b, lowMask));
+        __m256i v = _mm256_packus_epi16(_mm256_srli_epi16(a, 8), _mm256_srli_epi16(b, 8));
+        u = _mm256_permute4x64_epi64(u, 0xD8);
+        v = _mm256_permute4x64_epi64(v, 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dstU + i), u);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dstV + i), v);
+    }
+    deinterleaveUV8Sse2(src + 2 * i, dstU + i, dstV + i, width - i);
+}
+NEAPU_TARGET_AVX2 static inline __m256i roundNarrowAvx2(__m256i a, __m256i b)
+{
+    const __m256i bias = _mm256_set1_epi16(0x80);
+    a = _mm256_srli_epi16(_mm256_adds_epu16(a, bias), 8);
+    b = _mm256_srli_epi16(_mm256_adds_epu16(b, bias), 8);
+    return _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+}
+NEAPU_TARGET_AVX2 static void narrow16To8Avx2(const uint16_t* src, uint8_t* dst, int width)
+{
+    int i = 0;
+    for (; i + 32 <= width; i += 32) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 16));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), roundNarrowAvx2(a, b));
+    }
+    narrow16To8Sse2(src + i, dst + i, width - i);
+}
+NEAPU_TARGET_AVX2 static void deinterleaveUV16To8Avx2(const uint16_t* src, uint8_t* dstU, uint8_t* dstV, int width)
+{
+    const __m256i lowMask = _mm256_set1_epi16(0x00FF);
+    int i = 0;
+    for (; i + 32 <= width; i += 32) {
+        const auto* p = reinterpret_cast<const __m256i*>(src + 2 * i);
+        const __m256i uv0 = roundNarrowAvx2(_mm256_loadu_si256(p), _mm256_loadu_si256(p + 1));
+        const __m256i uv1 = roundNarrowAvx2(_mm256_loadu_si256(p + 2), _mm256_loadu_si256(p + 3));
+        __m256i u = _mm256_packus_epi16(_mm256_and_si256(uv0, lowMask), _mm256_and_si256(uv1, lowMask));
+        __m256i v = _mm256_packus_epi16(_mm256_srli_epi16(uv0, 8), _mm256_srli_epi16(uv1, 8));
+        u = _mm256_permute4x64_epi64(u, 0xD8);
+        v = _mm256_permute4x64_epi64(v, 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dstU + i), u);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dstV + i), v);
+    }
+    deinterleaveUV16To8Sse2(src + 2 * i, dstU + i, dstV + i, width - i);
+}
+NEAPU_TARGET_AVX2 static void averageRows8Avx2(const uint8_t* a, const uint8_t* b, uint8_t* dst, int width)
+{
+    int i = 0;
+    for (; i + 32 <= width; i += 32) {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_avg_epu8(va, vb));
+    }
+    averageRows8Sse2(a + i, b + i, dst + i, width - i);
+}
+#endif
+
+#if defined(NEAPU_ARCH_ARM64)
+static void deinterleaveUV8Neon(const uint8_t* src, uint8_t* dstU, uint8_t* dstV, int width)
+{
+    int i = 0;
+    for (; i + 16 <= width; i += 16) {
+        const uint8x16x2_t uv = vld2q_u8(src + 2 * i);
+        vst1q_u8(dstU + i, uv.val[0]);
+        vst1q_u8(dstV + i, uv.val[1]);
+    }
+    deinterleaveUV8Scalar(src + 2 * i, dstU + i, dstV + i, width - i);
+}
+static void narrow16To8Neon(const uint16_t* src, uint8_t* dst, int width)
+{
+    int i = 0;
+    for (; i + 16 <= width; i += 16) {
+        const uint8x8_t lo = vqrshrn_n_u16(vld1q_u16(src + i), 8);
+        const uint8x8_t hi = vqrshrn_n_u16(vld1q_u16(src + i + 8), 8);
+        vst1q_u8(dst + i, vcombine_u8(lo, hi));
+    }
+    narrow16To8Scalar(src + i, dst + i, width - i);
+}
+static void deinterleaveUV16To8Neon(const uint16_t* src, uint8_t* dstU, uint8_t* dstV, int width)
+{
+    int i = 0;
+    for (; i + 8 <= width; i += 8) {
+        const uint16x8x2_t uv = vld2q_u16(src + 2 * i);
+        vst1_u8(dstU + i, vqrshrn_n_u16(uv.val[0], 8));
+        vst1_u8(dstV + i, vqrshrn_n_u16(uv.val[1], 8));
+    }
+    deinterleaveUV16To8Scalar(src + 2 * i, dstU + i, dstV + i, width - i);
+}
+static void averageRows8Neon(const uint8_t* a, const uint8_t* b, uint8_t* dst, int width)
+{
+    int i = 0;
+    for (; i + 16 <= width; i += 16) {
+        vst1q_u8(dst + i, vrhaddq_u8(vld1q_u8(a + i), vld1q_u8(b + i)));
+    }
+    averageRows8Scalar(a + i, b + i, dst + i, width - i);
+}
+#endif
+
+std::vector<PixelKernels> availablePixelKernels()
+{
+    std::vector<PixelKernels> kernels{scalarPixelKernels()};
+    [[maybe_unused]] const auto& features = cpuFeatures();
+#if defined(NEAPU_ARCH_X86)
+    if (features.sse2) {
+        kernels.push_back({deinterleaveUV8Sse2, narrow16To8Sse2, deinterleaveUV16To8Sse2, averageRows8Sse2, "sse2"});
+    }
+    if (features.avx2) {
+        kernels.push_back({deinterleaveUV8Avx2, narrow16To8Avx2, deinterleaveUV16To8Avx2, averageRows8Avx2, "avx2"});
+    }
+#elif defined(NEAPU_ARCH_ARM64)
+    if (features.neon) {
+        kernels.push_back({deinterleaveUV8Neon, narrow16To8Neon, deinterleaveUV16To8Neon, averageRows8Neon, "neon"});
+    }
+#endif
+    return kernels;
+}
+
+const PixelKernels& pixelKernels()
+{
+    static const PixelKernels kernels = availablePixelKernels().back();
+    return kernels;
+}
+const PixelKernels& scalarPixelKernels()
+{
+    static const PixelKernels kernels{deinterleaveUV8Scalar, narrow16To8Scalar, deinterleaveUV16To8Scalar, averageRows8Scalar, "scalar"};
+    return kernels;
+}
+} // namespace media
@@ -0,0 +1,29 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace media {
+
+// 常见像素格式转换的逐行内核，运行时按CPU特性选择 SSE2/AVX2/NEON 实现
+struct PixelKernels {
+    // NV12 交错的UV行拆分为U、V两行，width为色度样本数
+    void (*deinterleaveUV8)(const uint8_t* src, uint8_t* dstU, uint8_t* dstV, int width);
+    // P010（高位对齐的16位）转8位，四舍五入
+    void (*narrow16To8)(const uint16_t* src, uint8_t* dst, int width);
+    // P010 交错的UV行拆分并转8位
+    void (*deinterleaveUV16To8)(const uint16_t* src, uint8_t* dstU, uint8_t* dstV, int width);
+    // 两行取平均（向上取整），用于4:2:2转4:2:0的色度垂直下采样
+    void (*averageRows8)(const uint8_t* a, const uint8_t* b, uint8_t* dst, int width);
+    const char* name;
+};
+
+const PixelKernels& pixelKernels();
+const PixelKernels& scalarPixelKernels();
+// 本机CPU支持的全部实现，按优先级从低到高排列，第一个为标量实现，最后一个即 pixelKernels() 的选择
+std::vector<PixelKernels> availablePixelKernels();
+
+} // namespace media
@@ -4,8 +4,12 @@
 
 #pragma once
 #include "Frame.h"
+#include "AudioResample.h"
+#include "DecodeThreading.h"
 #include <functional>
+#include <map>
 #include <string>
+#include <vector>
 #ifdef _WIN32
 struct ID3D11Device;
 #endif
@@ -18,7 +22,10 @@ public:
     virtual ~Player() = default;
 
     virtual FramePtr getVideoFrame() = 0;
-    virtual FramePtr getAudioFrame() = 0;
+    // 在音频设备回调中调用：从PCM环形缓冲区读出最多 frameCount 个采样帧（交错，格式见 audioSampleFormat()），返回实际读出的帧数，
+    // 不足部分由调用方填充静音。无锁、不分配内存、不触发回调。
+    // deviceLatencyUs 为设备缓冲造成的延迟，播放时钟按读出位置加上该延迟校准
+    virtual uint32_t readAudio(void* output, uint32_t frameCount, int64_t deviceLatencyUs) = 0;
 
     struct OpenParam {
         std::string url;
@@ -27,14 +34,86 @@ public:
         std::function<void()> onPlayFinished;
         Frame::PixelFormat targetPixelFormat{Frame::PixelFormat::YUV420P};
         Frame::PixelFormat downgradePixelFormat{Frame::PixelFormat::YUV420P};
+        // 软件解码时渲染端可直接使用的格式，命中时跳过sws转换
+        std::vector<Frame::PixelFormat> passthroughPixelFormats;
+        DecodeThreadConfig videoThreadConfig;
+        DecodeThreadConfig audioThreadConfig;
+        // 硬解探测结果缓存文件，空表示只缓存在内存中
+        std::string hwProbeCachePath;
+        // 关闭后保留的空闲解码器数量，0 表示不复用
+        size_t warmDecoderPoolSize{4};
+        // 倒放时解码帧缓存的内存上限
+        size_t reverseCacheBytes{256 * 1024 * 1024};
+        // 逐帧回退时缓存的最近显示帧数量，小于1时按1处理
+        size_t stepCacheFrames{8};
+        // 拖动进度条时解码帧缓存的内存上限和缓存帧的最大高度
+        size_t scrubCacheBytes{128 * 1024 * 1024};
+        int scrubMaxHeight{540};
+        // 拖动进度条时播放拖动位置的短音频片段（约80ms，首尾交叉淡化），用独立的解复用和解码
+        bool audioScrub{false};
+        // 显示尺寸感知解码：软解画面明显大于渲染尺寸时使用lowres或在转换中缩小，硬件零拷贝路径不受影响
+        bool displaySizeAwareDecoding{false};
+        // libavfilter 滤镜图描述，空表示不启用，如 "bwdif"、"crop=1920:800,scale=1280:-2"、"atempo=1.25"。
+        // 滤镜在解码和帧队列之间的独立线程运行；启用视频滤镜后硬解帧先下载到内存
+        std::string videoFilters;
+        std::string audioFilters;
+        int filterThreads{0}; // 每个滤镜图内部的线程数，0 表示自动
+        // 解码线程和音频回调之间的PCM缓冲时长
+        int audioBufferMs{250};
+        // 音频输出的交错采样格式，默认全程float；设备只支持整数格式时由渲染端改为S16
+        Frame::SampleFormat audioSampleFormat{Frame::SampleFormat::Float32};
+        // 音频设备的原生采样率，0 表示保持流的采样率。重采样在解码流水中完成，设备回调中不做重采样
+        int audioOutputSampleRate{0};
+        ResampleQuality audioResampleQuality{ResampleQuality::Default};
+        // 音频设备的声道数，0 表示保持流的声道数。多声道流在解码线程按ITU系数下混，如5.1/7.1到立体声
+        int audioOutputChannels{0};
 #ifdef _WIN32
         ID3D11Device* d3d11Device{nullptr};
 #endif
     };
     virtual bool open(const OpenParam& param) = 0;
     virtual void close() = 0;
+    // 关闭并清空解码器预热池。播放器是静态单例，程序退出前调用，硬件上下文在 main 返回前释放
+    virtual void shutdown() = 0;
 
-    virtual void seek(double seconds) = 0;
+    enum class SeekMode {
+        Fast, // 从目标之前的关键帧开始播放
+        Accurate, // 从关键帧解码，丢弃目标之前的帧和采样，首帧即目标位置
+    };
+    virtual void seek(double seconds, SeekMode mode = SeekMode::Fast) = 0;
+
+    // 快进快退倍速，如 8/16/32 或 -8/-16/-32，0 恢复正常播放。
+    // 只解码显示关键帧，音频静音
+    virtual void setTrickPlaySpeed(int speed) = 0;
+    virtual int trickPlaySpeed() const = 0;
+
+    // 变速播放，范围 0.25~4.0，1.0 为原速。播放时钟按速率推进，音频保持音高拉伸，
+    // 来不及显示的视频帧在转换前丢弃。与快进快退相互独立，设置在下次打开文件时仍然有效
+    virtual void setPlaybackRate(double rate) = 0;
+    virtual double playbackRate() const = 0;
+
+    // 倒放，按GOP解码后倒序显示，音频静音；关闭后从当前画面位置恢复正向播放
+    virtual void setReversePlayback(bool reverse) = 0;
+    virtual bool isReversePlayback() const = 0;
+
+    // 暂停时逐帧前进/后退，不推进播放时钟。
+    // 后退优先从最近显示帧缓存中取，缓存用尽时从关键帧精确seek到上一帧
+    virtual void stepForward() = 0;
+    virtual void stepBackward() = 0;
+
+    // 拖动进度条：期间显示拖动缓存中的帧，音频静音，结束时精确seek到最终位置。
+    // 快进快退和倒放时不可用，返回false
+    virtual bool beginScrub() = 0;
+    virtual void scrubTo(double seconds) = 0;
+    virtual void endScrub(double seconds) = 0;
+    virtual bool isScrubbing() const = 0;
+
+    // 渲染区域的像素尺寸，由渲染端在尺寸变化时上报，可在打开文件前和任意线程调用。
+    // 只记录尺寸不seek：缩放在下一帧生效，lowres级别在下一次seek时生效
+    virtual void setRenderSize(int width, int height) = 0;
+    // 在界面线程调用，lowres级别需要变化时原地精确seek一次让其立即生效。
+    // 正在seek、暂时无法刷新时返回false，调用方稍后重试
+    virtual bool applyRenderSize() = 0;
 
     virtual bool isOpened() const = 0;
 
@@ -42,8 +121,10 @@ public:
     virtual bool hasAudio() const = 0;
 
     virtual double fps() const = 0;
+    // 音频输出的采样率和声道数，设置了 audioOutputSampleRate/audioOutputChannels 时为该值
     virtual int sampleRate() const = 0;
     virtual int channelCount() const = 0;
+    virtual Frame::SampleFormat audioSampleFormat() const = 0;
 
     virtual double durationSeconds() const = 0;
 
@@ -54,6 +135,9 @@ public:
 
     virtual int64_t lastPlayPtsUs() const = 0;
 
+    // 运行指标快照，如解码降级次数、丢帧计数等
+    virtual std::map<std::string, int64_t> metrics() const = 0;
+
 #ifdef __linux__
     virtual void* vaDisplay() const = 0;
 #endif
@@ -4,45 +4,103 @@
 
 #include "PlayerImpl.h"
 #include <logger.h>
+#include <algorithm>
+#include <cstdlib>
+#include <future>
+#include "Metrics.h"
+#include "HWProbeCache.h"
+#include "DecoderPool.h"
 extern "C"{
 #include <libavformat/avformat.h>
 }
 
 namespace media {
+// 快进快退时显示落后于倍速时钟超过该时长（按1x计）后重新锚定
+constexpr int64_t TRICK_MAX_LAG_US = 500'000;
+// 音频事件线程检查进度、seek完成和播放结束的间隔
+constexpr auto AUDIO_EVENT_INTERVAL = std::chrono::milliseconds(20);
+constexpr double MIN_PLAYBACK_RATE = 0.25;
+constexpr double MAX_PLAYBACK_RATE = 4.0;
+
 static int64_t getCurrentTimeUs()
 {
     return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 FramePtr PlayerImpl::getVideoFrame()
 {
-    if (!m_playing.load()) {
+    if (!m_videoDecoder) {
         return nullptr;
     }
-    if (!m_videoDecoder) {
+    if (m_scrubbing.load()) {
+        return presentScrubFrame();
+    }
+    if (!m_playing.load()) {
+        // 暂停时只响应逐帧请求
+        return handleStepRequest();
+    }
+    if (!prepareNextVideoFrame()) {
         return nullptr;
     }
+
+    if (m_reversing.load()) {
+        return presentTrickFrame(-1);
+    }
+    if (const int trickSpeed = m_trickSpeed.load(); trickSpeed != 0) {
+        return presentTrickFrame(trickSpeed);
+    }
+
+    if (m_startTimeUs > 0) {
+        // 判断是否到播放时间
+        auto expectedPlayTimeUs = clockAt(getCurrentTimeUs(), m_startTimeUs.load());
+        if (m_nextVideoFrame->ptsUs() > expectedPlayTimeUs) {
+            // 还没到播放时间，返回空
+            return nullptr;
+        }
+    } else if (!m_audioDecoder) {
+        // 无音频时，初始化m_startTimeUs
+        m_startTimeUs = clockStartFor(getCurrentTimeUs(), m_nextVideoFrame->ptsUs());
+    }
+    // 到了播放时间，返回该帧
+    auto frame = std::move(m_nextVideoFrame);
+    recordSeekFirstFrame();
+    recordPresentedFrame(*frame);
+    if (!m_audioDecoder) {
+        m_lastPlayPtsUs = frame->ptsUs();
+        if (m_param.onPlayingPtsUs) {
+            m_param.onPlayingPtsUs(m_lastPlayPtsUs.load());
+        }
+    }
+    m_nextVideoFrame.reset();
+    return frame;
+}
+bool PlayerImpl::prepareNextVideoFrame()
+{
     for (;;) {
         if (!m_nextVideoFrame) {
-            m_nextVideoFrame = m_videoDecoder->getFrame();
+            m_nextVideoFrame = nextVideoFrame();
         }
         if (!m_nextVideoFrame) {
-            return nullptr;
+            return false;
         }
 
         if (m_nextVideoFrame->type() == Frame::FrameType::EndOfStream) {
             NEAPU_LOGI("Video reached end of stream");
             m_videoEof = true;
-            if (m_param.onPlayFinished && (m_audioEof.load() || !m_audioDecoder)) {
+            const int trickSpeed = m_trickSpeed.load();
+            if (trickSpeed < 0 || !m_playing.load()) {
+                // 快退到开头或逐帧到结尾，停在当前帧
+            } else if (m_param.onPlayFinished && (m_audioEof.load() || !m_audioDecoder || trickSpeed > 0)) {
                 m_param.onPlayFinished();
             }
             m_nextVideoFrame.reset();
-            return nullptr;
+            return false;
         }
 
         // 丢弃过期帧
         if (m_nextVideoFrame->serial() < m_serial) {
             NEAPU_LOGD("Discarding expired video frame with serial {}, current serial is {}",
                 m_nextVideoFrame->serial(), m_serial.load());
+            Metrics::instance().add("video.drop.stale_serial");
             m_nextVideoFrame.reset();
             continue;
         }
@@ -53,176 +111,608 @@ FramePtr PlayerImpl::getVideoFrame()
                 m_videoSeeking = false;
             }
             if (!m_audioDecoder) m_startTimeUs = 0;
+            m_trickAnchorWallUs = 0;
+            m_stepRing.clear();
+            m_stepCursor = 0;
             m_nextVideoFrame.reset();
             continue;
         }
-        
-        if (m_startTimeUs > 0) {
-            // 判断是否到播放时间
-            auto expectedPlayTimeUs = getCurrentTimeUs() - m_startTimeUs.load();
-            if (m_nextVideoFrame->ptsUs() > expectedPlayTimeUs) {
-                // 还没到播放时间，返回空
-                return nullptr;
+        return true;
+    }
+}
+FramePtr PlayerImpl::nextVideoFrame()
+{
+    if (m_reversing.load()) {
+        std::lock_guard<std::mutex> lock(m_reverseMutex);
+        return m_reversePlayback ? m_reversePlayback->getFrame() : nullptr;
+    }
+    return m_videoDecoder->getFrame();
+}
+FramePtr PlayerImpl::presentTrickFrame(int speed)
+{
+    // 按倍速推进的媒体时钟，关键帧的pts到达时钟时显示
+    const int64_t nowUs = getCurrentTimeUs();
+    const int64_t ptsUs = m_nextVideoFrame->ptsUs();
+    int64_t anchorWallUs = m_trickAnchorWallUs.load();
+    if (anchorWallUs == 0) {
+        anchorWallUs = nowUs;
+        m_trickAnchorWallUs = nowUs;
+        m_trickAnchorPtsUs = ptsUs;
+    }
+    const int64_t mediaUs = m_trickAnchorPtsUs + speed * (nowUs - anchorWallUs);
+    const int64_t aheadUs = speed > 0 ? ptsUs - mediaUs : mediaUs - ptsUs;
+    if (aheadUs > 0) {
+        return nullptr;
+    }
+    if (-aheadUs > std::abs(speed) * TRICK_MAX_LAG_US) {
+        // 解码跟不上，重新锚定，避免之后追赶时连续闪过多个关键帧
+        m_trickAnchorWallUs = nowUs;
+        m_trickAnchorPtsUs = ptsUs;
+    }
+    auto frame = std::move(m_nextVideoFrame);
+    m_lastPlayPtsUs = frame->ptsUs();
+    if (m_param.onPlayingPtsUs) {
+        m_param.onPlayingPtsUs(m_lastPlayPtsUs.load());
+    }
+    Metrics::instance().add("video.trick.frames");
+    return frame;
+}
+void PlayerImpl::stepForward()
+{
+    requestStep(1);
+}
+void PlayerImpl::stepBackward()
+{
+    requestStep(-1);
+}
+void PlayerImpl::requestStep(int step)
+{
+    if (!m_demuxer || !m_videoDecoder) {
+        NEAPU_LOGW("Cannot step frames without video");
+        return;
+    }
+    if (m_playing.load()) {
+        NEAPU_LOGW("Frame stepping is only available while paused");
+        return;
+    }
+    if (m_trickSpeed.load() != 0 || m_reversing.load()) {
+        NEAPU_LOGW("Cannot step frames during trick play or reverse playback");
+        return;
+    }
+    // 只记录请求，由渲染线程在getVideoFrame中处理，帧队列和缓存都只在渲染线程访问
+    m_stepRequest += step;
+}
+FramePtr PlayerImpl::handleStepRequest()
+{
+    if (m_stepSeekPending.load()) {
+        return refillStepRing();
+    }
+    const int request = m_stepRequest.load();
+    if (request > 0) {
+        if (m_stepCursor > 0) {
+            // 之前后退过，先沿缓存回到较新的帧
+            m_stepRequest--;
+            m_stepCursor--;
+            Metrics::instance().add("video.step.forward");
+            Metrics::instance().add("video.step.ring_hit");
+            return presentStepFrame(m_stepRing[m_stepCursor]->ref());
+        }
+        if (!prepareNextVideoFrame()) {
+            if (m_videoEof.load()) {
+                m_stepRequest = 0; // 已到结尾
             }
-        } else if (!m_audioDecoder) {
-            // 无音频时，初始化m_startTimeUs
-            m_startTimeUs = getCurrentTimeUs() - m_nextVideoFrame->ptsUs();
+            return nullptr; // 解码器还没输出，下次渲染再取
         }
-        // 到了播放时间，返回该帧
+        m_stepRequest--;
         auto frame = std::move(m_nextVideoFrame);
-        if (!m_audioDecoder) {
-            m_lastPlayPtsUs = frame->ptsUs();
-            if (m_param.onPlayingPtsUs) {
-                m_param.onPlayingPtsUs(m_lastPlayPtsUs.load());
-            }
+        recordPresentedFrame(*frame);
+        Metrics::instance().add("video.step.forward");
+        return presentStepFrame(std::move(frame));
+    }
+    if (request < 0) {
+        m_stepRequest++;
+        m_stepResync = true;
+        Metrics::instance().add("video.step.backward");
+        if (m_stepCursor + 1 < m_stepRing.size()) {
+            m_stepCursor++;
+            Metrics::instance().add("video.step.ring_hit");
+            return presentStepFrame(m_stepRing[m_stepCursor]->ref());
+        }
+
+        // 缓存用尽，从当前帧之前若干帧的位置精确seek，解码回来的帧重新填满缓存
+        Metrics::instance().add("video.step.ring_miss");
+        const int64_t currentPtsUs = m_stepRing.empty() ? m_lastPlayPtsUs.load() : m_stepRing.back()->ptsUs();
+        const double frameRate = fps();
+        const int64_t frameDurationUs = frameRate > 0.0 ? static_cast<int64_t>(1e6 / frameRate) : 40'000;
+        const auto cacheFrames = static_cast<int64_t>(m_param.stepCacheFrames);
+        const int64_t targetUs = std::max<int64_t>(0, currentPtsUs - frameDurationUs * cacheFrames);
+        if (!startSeek(static_cast<double>(targetUs) / 1e6, SeekMode::Accurate, true)) {
+            return nullptr;
         }
+        m_stepRefillUntilUs = currentPtsUs;
+        m_stepRing.clear();
+        m_stepCursor = 0;
         m_nextVideoFrame.reset();
-        return frame;
+        m_videoEof = false;
+        m_stepSeekPending = true;
     }
     return nullptr;
 }
-FramePtr PlayerImpl::getAudioFrame()
+FramePtr PlayerImpl::refillStepRing()
 {
-    if (!m_playing.load()) {
+    for (;;) {
+        if (!prepareNextVideoFrame()) {
+            if (!m_videoEof.load()) {
+                return nullptr; // 等待解码
+            }
+            break;
+        }
+        if (m_nextVideoFrame->ptsUs() >= m_stepRefillUntilUs) {
+            if (m_stepRing.empty()) {
+                // 已经是第一帧，无法再后退，重新显示它
+                auto frame = std::move(m_nextVideoFrame);
+                recordPresentedFrame(*frame);
+            }
+            // 其余情况该帧留作下一次前进的帧
+            break;
+        }
+        auto frame = std::move(m_nextVideoFrame);
+        recordPresentedFrame(*frame);
+    }
+    m_stepSeekPending = false;
+    recordSeekFirstFrame();
+    if (m_stepRing.empty()) {
         return nullptr;
     }
-    if (!m_audioDecoder) {
+    return presentStepFrame(m_stepRing.front()->ref());
+}
+FramePtr PlayerImpl::presentStepFrame(FramePtr frame)
+{
+    if (!frame) {
         return nullptr;
     }
-    for (;;) {
-        if (!m_nextAudioFrame) {
-            m_nextAudioFrame = m_audioDecoder->getFrame();
+    // 只更新显示位置，不改变播放时钟，恢复播放时由play()重新锚定
+    m_lastPlayPtsUs = frame->ptsUs();
+    if (m_param.onPlayingPtsUs) {
+        m_param.onPlayingPtsUs(m_lastPlayPtsUs.load());
+    }
+    return frame;
+}
+void PlayerImpl::recordPresentedFrame(const Frame& frame)
+{
+    m_stepCursor = 0;
+    auto ref = frame.ref();
+    if (!ref) {
+        return;
+    }
+    m_stepRing.push_front(std::move(ref));
+    while (m_stepRing.size() > m_param.stepCacheFrames) {
+        m_stepRing.pop_back();
+    }
+}
+void PlayerImpl::setRenderSize(int width, int height)
+{
+    m_renderWidth = width;
+    m_renderHeight = height;
+    if (m_param.displaySizeAwareDecoding && m_videoDecoder) {
+        m_videoDecoder->setRenderSize(width, height);
+    }
+}
+bool PlayerImpl::applyRenderSize()
+{
+    if (!m_param.displaySizeAwareDecoding || !m_videoDecoder || !m_videoDecoder->isLowresPending()) {
+        return true;
+    }
+    // 暂停时没有画面需要刷新；快进快退、倒放和拖动结束时都会seek，新级别随之生效
+    if (!m_playing.load() || m_trickSpeed.load() != 0 || m_reversing.load() || m_scrubbing.load()) {
+        return true;
+    }
+    // lowres级别只能在Flush时切换，原地精确seek一次让新级别生效
+    NEAPU_LOGI("Render size changed to {}x{}, refreshing decoder lowres", m_renderWidth.load(), m_renderHeight.load());
+    return startSeek(static_cast<double>(m_lastPlayPtsUs.load()) / 1e6, SeekMode::Accurate);
+}
+bool PlayerImpl::beginScrub()
+{
+    if (!m_demuxer || !m_videoDecoder) {
+        return false;
+    }
+    if (m_trickSpeed.load() != 0 || m_reversing.load()) {
+        NEAPU_LOGW("Cannot scrub during trick play or reverse playback");
+        return false;
+    }
+    {
+        // 缓存在同一个文件内保留，多次拖动同一区域都能命中
+        std::lock_guard<std::mutex> lock(m_scrubMutex);
+        if (!m_scrubCache) {
+            ScrubCache::Config config;
+            config.url = m_param.url;
+            config.memoryBudgetBytes = m_param.scrubCacheBytes;
+            config.maxHeight = m_param.scrubMaxHeight;
+            config.pixelFormat = m_param.downgradePixelFormat;
+            try {
+                m_scrubCache = std::make_unique<ScrubCache>(config);
+            } catch (const std::exception& e) {
+                NEAPU_LOGE("Failed to create scrub cache: {}", e.what());
+                return false;
+            }
         }
-        if (!m_nextAudioFrame) {
-            return nullptr;
+        if (m_param.audioScrub && m_audioDecoder && !m_audioScrubber) {
+            AudioScrubber::Config config;
+            config.url = m_param.url;
+            config.sampleRate = sampleRate();
+            config.channels = channelCount();
+            config.sampleFormat = m_param.audioSampleFormat;
+            try {
+                m_audioScrubber = std::make_unique<AudioScrubber>(config);
+            } catch (const std::exception& e) {
+                // 没有音频预听时画面拖动照常进行
+                NEAPU_LOGW("Failed to create audio scrubber: {}", e.what());
+            }
+        }
+    }
+    m_scrubTargetUs = -1;
+    m_scrubShownUs = -1;
+    m_scrubLookupUs = -1;
+    m_scrubbing = true;
+    return true;
+}
+void PlayerImpl::scrubTo(double seconds)
+{
+    if (!m_scrubbing.load()) {
+        return;
+    }
+    const int64_t targetUs = std::max<int64_t>(0, static_cast<int64_t>(seconds * 1'000'000));
+    if (m_scrubTargetUs.exchange(targetUs) != targetUs && m_audioScrubber) {
+        // 新位置取代还没播放的片段
+        m_audioScrubber->request(targetUs);
+    }
+}
+void PlayerImpl::endScrub(double seconds)
+{
+    if (!m_scrubbing.exchange(false)) {
+        return;
+    }
+    if (m_audioScrubber) {
+        m_audioScrubber->cancel();
+    }
+    // 主管线在拖动期间没有被打断，这里只做一次精确seek
+    startSeek(seconds, SeekMode::Accurate);
+}
+FramePtr PlayerImpl::presentScrubFrame()
+{
+    const int64_t targetUs = m_scrubTargetUs.load();
+    if (targetUs < 0 || targetUs == m_scrubShownUs.load()) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(m_scrubMutex);
+    if (!m_scrubCache) {
+        return nullptr;
+    }
+    auto frame = m_scrubCache->lookup(targetUs);
+    // 每个拖动位置只统计一次，解码完成后的再次查找不算命中
+    const bool firstLookup = m_scrubLookupUs.exchange(targetUs) != targetUs;
+    if (!frame) {
+        if (firstLookup) {
+            Metrics::instance().add("scrub.miss");
+            m_scrubCache->request(targetUs);
         }
-        if (m_nextAudioFrame->type() == Frame::FrameType::EndOfStream) {
+        return nullptr;
+    }
+    if (firstLookup) {
+        Metrics::instance().add("scrub.hit");
+    }
+    m_scrubShownUs = targetUs;
+    m_lastPlayPtsUs = frame->ptsUs();
+    if (m_param.onPlayingPtsUs) {
+        m_param.onPlayingPtsUs(m_lastPlayPtsUs.load());
+    }
+    return frame;
+}
+uint32_t PlayerImpl::readAudio(void* output, uint32_t frameCount, int64_t deviceLatencyUs)
+{
+    // 运行在音频设备回调中，只访问原子量和环形缓冲区
+    AudioRingBuffer* ring = m_audioRing.get();
+    if (!ring) {
+        return 0;
+    }
+    const int serial = m_serial.load();
+    if (m_scrubbing.load()) {
+        // 拖动时主缓冲区静音，改为输出拖动位置的预听片段
+        ring->discardStale(serial);
+        AudioScrubber* scrubber = m_audioScrubber.get();
+        return scrubber ? scrubber->read(output, frameCount) : 0;
+    }
+    if (!m_playing.load() || m_trickSpeed.load() != 0 || m_reversing.load()) {
+        // 快进快退、倒放和暂停时静音，但seek前的旧数据照常丢弃，解码线程才能写入新位置的数据
+        ring->discardStale(serial);
+        return 0;
+    }
+    const size_t bytesPerFrame = ring->bytesPerFrame();
+    const size_t requested = static_cast<size_t>(frameCount) * bytesPerFrame;
+    const auto result = ring->read(static_cast<uint8_t*>(output), requested, serial);
+    if (result.bytes > 0 && result.serial >= m_serial.load()) {
+        // 读出的第一个采样在设备延迟之后才被听到，以此锚定播放时钟，时钟速率跟随该数据的拉伸速率
+        m_clockRate = result.mediaRate;
+        m_startTimeUs = clockStartFor(getCurrentTimeUs() + deviceLatencyUs, result.ptsUs);
+        m_audioReadSerial = result.serial;
+        m_audioFramesRead.fetch_add(result.bytes / bytesPerFrame, std::memory_order_relaxed);
+    }
+    if (result.bytes < requested && !result.endOfStream && ring->endOfStreamSerial() < serial) {
+        m_audioUnderruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    return static_cast<uint32_t>(result.bytes / bytesPerFrame);
+}
+void PlayerImpl::startAudioEvents()
+{
+    stopAudioEvents();
+    m_audioEventRunning = true;
+    m_audioEventThread = std::thread(&PlayerImpl::audioEventThreadFunc, this);
+}
+void PlayerImpl::stopAudioEvents()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_audioEventMutex);
+        m_audioEventRunning = false;
+        m_audioEventCondVar.notify_all();
+    }
+    if (m_audioEventThread.joinable()) {
+        m_audioEventThread.join();
+    }
+}
+void PlayerImpl::audioEventThreadFunc()
+{
+    uint64_t reportedFrames = 0;
+    while (m_audioEventRunning) {
+        {
+            std::unique_lock<std::mutex> lock(m_audioEventMutex);
+            m_audioEventCondVar.wait_for(lock, AUDIO_EVENT_INTERVAL, [this]() { return !m_audioEventRunning.load(); });
+        }
+        if (!m_audioEventRunning) {
+            break;
+        }
+        const int serial = m_serial.load();
+        const bool endOfStream = m_audioRing->endOfStreamSerial() >= serial;
+        if (m_audioReadSerial.load() >= serial || endOfStream) {
+            // 新位置的音频已开始播放（或已到结尾），seek在音频侧完成
+            std::lock_guard<std::mutex> lock(m_seekMutex);
+            m_audioSeeking = false;
+        }
+        if (endOfStream && !m_audioEof.exchange(true)) {
             NEAPU_LOGI("Audio reached end of stream");
-            m_audioEof = true;
             if (m_param.onPlayFinished && (m_videoEof.load() || !m_videoDecoder)) {
                 m_param.onPlayFinished();
             }
-            m_nextAudioFrame.reset();
-            return nullptr;
         }
-        // 丢弃过期帧
-        if (m_nextAudioFrame->serial() < m_serial) {
-            NEAPU_LOGD("Discarding expired audio frame with serial {}, current serial is {}",
-                m_nextAudioFrame->serial(), m_serial.load());
-            m_nextAudioFrame.reset();
-            continue;
-        }
-        if (m_nextAudioFrame->type() == Frame::FrameType::Flush) {
-            {
-                std::lock_guard<std::mutex> lock(m_seekMutex);
-                m_audioSeeking = false;
-            }
-            m_startTimeUs = 0;
-            m_nextAudioFrame.reset();
+
+        const uint64_t framesRead = m_audioFramesRead.load(std::memory_order_relaxed);
+        const int64_t startTimeUs = m_startTimeUs.load();
+        if (framesRead == reportedFrames || startTimeUs <= 0 || !m_playing.load() || m_audioReadSerial.load() < serial) {
             continue;
         }
-        if (m_startTimeUs > 0) {
-            // 判断是否到播放时间
-            auto expectedPlayTimeUs = getCurrentTimeUs() - m_startTimeUs;
-            auto waitDurationUs = m_nextAudioFrame->ptsUs() - expectedPlayTimeUs;
-            if (waitDurationUs > m_nextAudioFrame->durationUs()) {
-                // 还没到播放时间，返回空
-                return nullptr;
-            } else if (waitDurationUs < -m_nextAudioFrame->durationUs()) {
-                // 已经过了播放时间，丢弃该帧
-                NEAPU_LOGD("Discarding expired audio frame with PTS {}, expected play time is {}",
-                    m_nextAudioFrame->ptsUs(), expectedPlayTimeUs);
-                m_nextAudioFrame.reset();
-                continue;
-            }
+        reportedFrames = framesRead;
+        if (!m_videoDecoder) {
+            recordSeekFirstFrame();
         }
-        auto frame = std::move(m_nextAudioFrame);;
-        m_nextAudioFrame.reset();
-        // 反响校准m_startTimeUs
-        m_lastPlayPtsUs = frame->ptsUs();
-        m_startTimeUs = getCurrentTimeUs() - m_lastPlayPtsUs.load();
+        m_lastPlayPtsUs = clockAt(getCurrentTimeUs(), startTimeUs);
         if (m_param.onPlayingPtsUs) {
             m_param.onPlayingPtsUs(m_lastPlayPtsUs.load());
         }
-        return frame;
     }
-    return nullptr;
 }
 bool PlayerImpl::open(const OpenParam& param)
 {
     close();
     try {
+        const int64_t openStartUs = getCurrentTimeUs();
         m_param = param;
+        // 逐帧回退依赖缓存重新显示seek回来的帧，至少保留一帧
+        m_param.stepCacheFrames = std::max<size_t>(param.stepCacheFrames, 1);
+        HWProbeCache::instance().setStoragePath(param.hwProbeCachePath);
+        DecoderPool::instance().setCapacity(param.warmDecoderPoolSize);
         m_demuxer = std::make_unique<Demuxer>(param.url);
+        const int64_t demuxerUs = getCurrentTimeUs() - openStartUs;
+
+        // 音频解码器的创建与视频硬解探测并行进行
+        std::future<int64_t> audioFuture;
+        if (m_demuxer->audioStream()) {
+            audioFuture = std::async(std::launch::async, [this]() {
+                const int64_t startUs = getCurrentTimeUs();
+                createAudioDecoder();
+                return getCurrentTimeUs() - startUs;
+            });
+        }
+        int64_t videoProbeUs = 0;
         if (m_demuxer->videoStream() &&
             !(m_demuxer->videoStream()->disposition & AV_DISPOSITION_ATTACHED_PIC)) {
+            const int64_t startUs = getCurrentTimeUs();
             createVideoDecoder();
+            videoProbeUs = getCurrentTimeUs() - startUs;
         }
-        if (m_demuxer->audioStream()) {
-            createAudioDecoder();
+        const int64_t audioInitUs = audioFuture.valid() ? audioFuture.get() : 0;
+        if (m_audioRing) {
+            startAudioEvents();
         }
-        NEAPU_LOGI("Media file opened successfully: {}", param.url);
+        const int64_t totalUs = getCurrentTimeUs() - openStartUs;
+
+        auto& metrics = Metrics::instance();
+        metrics.set("open.demuxer_us", demuxerUs);
+        metrics.set("open.video_probe_us", videoProbeUs);
+        metrics.set("open.audio_init_us", audioInitUs);
+        metrics.set("open.total_us", totalUs);
+        NEAPU_LOGI("Media file opened successfully: {}, demuxer {} us, video probe {} us, audio init {} us, total {} us",
+            param.url, demuxerUs, videoProbeUs, audioInitUs, totalUs);
         return true;
     } catch (const std::exception& e) {
         NEAPU_LOGE("Failed to open media file: {}", e.what());
         m_audioDecoder.reset();
+        m_audioRing.reset();
         m_videoDecoder.reset();
         m_demuxer.reset();
         return false;
     }
 }
+void PlayerImpl::shutdown()
+{
+    close();
+    DecoderPool::instance().clear();
+}
 void PlayerImpl::close()
 {
-    if (m_videoDecoder) {
-        m_videoDecoder->stop();
-        m_videoDecoder.reset();
-    }
+    stopAudioEvents();
     if (m_audioDecoder) {
         m_audioDecoder->stop();
-        m_audioDecoder.reset();
+        m_audioDecoder->setOutputRing(nullptr);
     }
+    m_audioRing.reset();
+    m_audioReadSerial = -1;
+    m_audioFramesRead = 0;
+    m_audioUnderruns = 0;
+    // 解码器放回预热池，下一个相同编码参数的文件直接复用
+    DecoderPool::instance().release(std::move(m_videoDecoder));
+    DecoderPool::instance().release(std::move(m_audioDecoder));
     m_demuxer.reset();
     m_serial = 0;
     m_startTimeUs = 0;
+    m_clockRate = m_playbackRate.load();
+    m_seekStartUs = 0;
+    m_trickSpeed = 0;
+    m_trickAnchorWallUs = 0;
+    m_reversing = false;
+    {
+        std::lock_guard<std::mutex> lock(m_reverseMutex);
+        m_reversePlayback.reset();
+    }
+    m_scrubbing = false;
+    {
+        std::lock_guard<std::mutex> lock(m_scrubMutex);
+        m_scrubCache.reset();
+        m_audioScrubber.reset();
+    }
+    m_stepRequest = 0;
+    m_stepSeekPending = false;
+    m_stepResync = false;
+    m_stepRing.clear();
+    m_stepCursor = 0;
     m_playing = false;
     m_lastPlayPtsUs = 0;
     m_nextVideoFrame.reset();
-    m_nextAudioFrame.reset();
     m_videoEof = false;
     m_audioEof = false;
     NEAPU_LOGI("Media file closed");
 }
 
-void PlayerImpl::seek(double seconds)
+void PlayerImpl::seek(double seconds, SeekMode mode)
+{
+    if (m_reversing.load()) {
+        // 倒放时从新位置重新开始倒放
+        const int serial = ++m_serial;
+        const auto positionUs = static_cast<int64_t>(seconds * 1'000'000);
+        std::lock_guard<std::mutex> lock(m_reverseMutex);
+        if (m_reversePlayback) {
+            m_reversePlayback->seek(positionUs, serial);
+            m_trickAnchorWallUs = 0;
+        }
+        return;
+    }
+    startSeek(seconds, mode);
+}
+bool PlayerImpl::startSeek(double seconds, SeekMode mode, bool allowPaused, const std::function<void()>& applyMode)
 {
     if (!m_demuxer) {
         NEAPU_LOGW("Cannot seek, demuxer is not opened");
-        return;
+        return false;
     }
-    if (!m_playing) {
+    if (!m_playing && !allowPaused) {
         NEAPU_LOGW("Cannot seek, player is not playing");
-        return;
+        return false;
     }
     if (seconds < 0.0 || seconds > durationSeconds()) {
         NEAPU_LOGW("Seek position {} seconds is out of range", seconds);
-        return;
+        return false;
     }
+    int serial = 0;
     {
+        // 检查、切换模式和递增serial在同一把锁内完成，并发的seek不会都通过检查
         std::lock_guard<std::mutex> lock(m_seekMutex);
         if (m_videoSeeking || m_audioSeeking) {
             NEAPU_LOGW("A seek operation is already in progress, ignoring new seek request");
-            return;
+            return false;
+        }
+        if (applyMode) {
+            applyMode();
         }
         if (m_videoDecoder) {
             m_videoSeeking = true;
         }
-        if (m_audioDecoder) {
+        // 快进快退和暂停时音频不输出，Flush帧不会被取走
+        if (m_audioDecoder && m_trickSpeed.load() == 0 && m_playing.load()) {
             m_audioSeeking = true;
         }
+        serial = ++m_serial;
     }
-    m_serial++;
-    NEAPU_LOGI("Seeking to {} seconds, serial {}", seconds, m_serial.load());
-    m_demuxer->seek(seconds, m_serial.load());
+    if (m_audioRing) {
+        // 缓冲区中旧位置的数据由回调按serial丢弃，时钟等新位置的音频读出后重新锚定
+        m_startTimeUs = 0;
+    }
+    NEAPU_LOGI("Seeking to {} seconds, serial {}, accurate {}", seconds, serial, mode == SeekMode::Accurate);
+    m_seekStartUs = getCurrentTimeUs();
+    const int64_t targetUs = mode == SeekMode::Accurate ? static_cast<int64_t>(seconds * 1'000'000) : -1;
+    // 先通知解码器停止处理旧数据，再让解复用器seek
+    if (m_videoDecoder) {
+        m_videoDecoder->requestFlush(serial, targetUs);
+    }
+    if (m_audioDecoder) {
+        m_audioDecoder->requestFlush(serial, targetUs);
+    }
+    m_demuxer->seek(seconds, serial);
+    return true;
+}
+void PlayerImpl::setTrickPlaySpeed(int speed)
+{
+    if (!m_demuxer || !m_videoDecoder) {
+        NEAPU_LOGW("Cannot change trick play speed without video");
+        return;
+    }
+    if (m_reversing.load()) {
+        NEAPU_LOGW("Cannot change trick play speed during reverse playback");
+        return;
+    }
+    const int oldSpeed = m_trickSpeed.load();
+    if (speed == oldSpeed) {
+        return;
+    }
+    if (oldSpeed != 0 && speed != 0 && (oldSpeed > 0) == (speed > 0)) {
+        // 同方向只改变速度，重新锚定节奏即可
+        std::lock_guard<std::mutex> lock(m_seekMutex);
+        if (m_videoSeeking || m_audioSeeking) {
+            NEAPU_LOGW("A seek operation is in progress, ignoring trick play speed change");
+            return;
+        }
+        NEAPU_LOGI("Trick play speed {} -> {}", oldSpeed, speed);
+        m_trickSpeed = speed;
+        m_trickAnchorWallUs = 0;
+        return;
+    }
+
+    // 解复用和解码模式只在seek确定发起后切换，seek被拒绝时保持原模式，队列中的帧与模式一致
+    auto applyMode = [this, speed]() {
+        m_trickSpeed = speed;
+        m_trickAnchorWallUs = 0;
+        m_demuxer->setTrickDirection(speed > 0 ? 1 : (speed < 0 ? -1 : 0));
+        m_videoDecoder->setKeyframeOnly(speed != 0);
+        if (speed == 0) {
+            // 回到正常播放，由音频重新建立时钟
+            m_startTimeUs = 0;
+            m_videoEof = false;
+        }
+    };
+    const double position = static_cast<double>(m_lastPlayPtsUs.load()) / 1e6;
+    // 回到正常播放时精确回到当前画面位置
+    if (!startSeek(position, speed == 0 ? SeekMode::Accurate : SeekMode::Fast, false, applyMode)) {
+        NEAPU_LOGW("Trick play speed change {} -> {} rejected, keeping current mode", oldSpeed, speed);
+        return;
+    }
+    NEAPU_LOGI("Trick play speed {} -> {}", oldSpeed, speed);
 }
 bool PlayerImpl::isOpened() const
 {
@@ -253,14 +743,14 @@ int PlayerImpl::sampleRate() const
     if (!m_audioDecoder) {
         return 0;
     }
-    return m_audioDecoder->sampleRate();
+    return m_audioDecoder->outputSampleRate();
 }
 int PlayerImpl::channelCount() const
 {
     if (!m_audioDecoder) {
         return 0;
     }
-    return m_audioDecoder->channelCount();
+    return m_audioDecoder->outputChannelCount();
 }
 
 double PlayerImpl::durationSeconds() const
@@ -270,6 +760,27 @@ double PlayerImpl::durationSeconds() const
     }
     return m_demuxer->durationSeconds();
 }
+std::map<std::string, int64_t> PlayerImpl::metrics() const
+{
+    auto values = Metrics::instance().snapshot();
+    auto valueOf = [&values](const std::string& name) {
+        auto it = values.find(name);
+        return it != values.end() ? it->second : 0;
+    };
+    const int64_t scrubHits = valueOf("scrub.hit");
+    const int64_t scrubLookups = scrubHits + valueOf("scrub.miss");
+    if (scrubLookups > 0) {
+        values["scrub.hit_rate_pct"] = scrubHits * 100 / scrubLookups;
+    }
+    if (m_audioRing) {
+        // 回调中不能访问加锁的Metrics，这几项在快照时读取。
+        // 播放时钟以读出的音频为准，音频不会迟到，没有 audio.drop.late
+        values["audio.ring.buffered_us"] = m_audioRing->bufferedUs();
+        values["audio.ring.underrun"] = m_audioUnderruns.load();
+        values["audio.drop.stale_serial"] += static_cast<int64_t>(m_audioRing->staleChunksDropped());
+    }
+    return values;
+}
 #ifdef __linux__
 void* PlayerImpl::vaDisplay() const
 {
@@ -295,13 +806,32 @@ void PlayerImpl::createVideoDecoder()
     }
     hwaccelMethods.push_back(None);
 
+    // 探测读到的视频包留存下来，某种方式失败后下一种方式从头重放，不再回seek到开头
+    auto replay = std::make_shared<ProbeReplay>();
+    auto& probeCache = HWProbeCache::instance();
+    // 失败结果只有在后续某个方式成功后才写入缓存，避免文件本身损坏时误判硬解不可用
+    std::vector<HWProbeCache::Key> failedKeys;
     for (auto method : hwaccelMethods) {
+        const auto cacheKey = HWProbeCache::makeKey(m_demuxer->videoStream()->codecpar, static_cast<int>(method));
+        if (method != None && probeCache.lookup(cacheKey) == false) {
+            NEAPU_LOGI("Skipping video decoder method {} known to fail from probe cache", static_cast<int>(method));
+            Metrics::instance().add("hwprobe.cache_skip");
+            continue;
+        }
         try {
             VideoDecoder::CreateParam param;
             param.stream = m_demuxer->videoStream();
-            param.packetCallback = [this]() { return m_demuxer->getVideoPacket(); };
+            param.packetCallback = [this, replay, cursor = size_t{0}]() mutable { return nextProbePacket(*replay, cursor); };
             param.hwaccelMethod = method;
             param.targetPixelFormat = m_param.targetPixelFormat;
+            param.passthroughPixelFormats = m_param.passthroughPixelFormats;
+            param.threadConfig = m_param.videoThreadConfig;
+            param.clockCallback = [this]() { return clockUs(); };
+            // 逐帧缓存持有的帧不能被解码器复用
+            param.extraHwFrames = static_cast<int>(m_param.stepCacheFrames);
+            param.displaySizeAware = m_param.displaySizeAwareDecoding;
+            param.renderWidth = m_renderWidth.load();
+            param.renderHeight = m_renderHeight.load();
 #ifdef _WIN32
             param.d3d11Device = m_param.d3d11Device;
 #endif
@@ -315,17 +845,32 @@ void PlayerImpl::createVideoDecoder()
             auto videoDecoder = std::make_unique<VideoDecoder>(param);
 
             auto ret = videoDecoder->testDecode();
-            m_demuxer->seek(0, m_serial.load(), true);
             if (!ret) {
                 NEAPU_LOGW("Video decoder test decode failed with method {}", static_cast<int>(method));
+                if (method != None) {
+                    failedKeys.push_back(cacheKey);
+                }
                 continue;
             }
+            if (method != None) {
+                probeCache.store(cacheKey, true);
+            }
+            for (const auto& key : failedKeys) {
+                probeCache.store(key, false);
+            }
+            replay->recording = false;
+            if (!m_param.videoFilters.empty()) {
+                videoDecoder->setFilter({m_param.videoFilters, m_param.filterThreads});
+            }
             m_videoDecoder = std::move(videoDecoder);
             m_videoDecoder->start();
             NEAPU_LOGI("Video decoder created successfully with method {}", static_cast<int>(method));
             return;
         } catch (const std::exception& e) {
             NEAPU_LOGW("Failed to create video decoder with method {}: {}", static_cast<int>(method), e.what());
+            if (method != None) {
+                failedKeys.push_back(cacheKey);
+            }
             continue;
         }
     }
@@ -334,18 +879,157 @@ void PlayerImpl::createVideoDecoder()
         throw std::runtime_error("Failed to create video decoder");
     }
 }
+PacketPtr PlayerImpl::nextProbePacket(ProbeReplay& replay, size_t& cursor)
+{
+    if (cursor < replay.packets.size()) {
+        if (replay.recording) {
+            return replay.packets[cursor++]->clone();
+        }
+        // 探测已结束，剩余的留存包只会被这一个解码器消费，直接移交
+        return std::move(replay.packets[cursor++]);
+    }
+    auto packet = m_demuxer->getVideoPacket();
+    if (packet && replay.recording) {
+        replay.packets.push_back(packet->clone());
+        cursor++;
+    }
+    return packet;
+}
+void PlayerImpl::setReversePlayback(bool reverse)
+{
+    if (reverse == m_reversing.load()) {
+        return;
+    }
+    if (!m_demuxer || !m_videoDecoder) {
+        NEAPU_LOGW("Cannot toggle reverse playback without video");
+        return;
+    }
+    if (!reverse) {
+        m_reversing = false;
+        {
+            std::lock_guard<std::mutex> lock(m_reverseMutex);
+            m_reversePlayback.reset();
+        }
+        // 回到正向播放，精确回到倒放停下的位置
+        m_startTimeUs = 0;
+        m_videoEof = false;
+        startSeek(static_cast<double>(m_lastPlayPtsUs.load()) / 1e6, SeekMode::Accurate);
+        return;
+    }
+
+    if (m_trickSpeed.load() != 0) {
+        NEAPU_LOGW("Cannot start reverse playback during trick play");
+        return;
+    }
+    {
+        // 倒放期间不从正向解码器取帧，进行中的seek的Flush帧将无法被消费
+        std::lock_guard<std::mutex> lock(m_seekMutex);
+        if (m_videoSeeking || m_audioSeeking) {
+            NEAPU_LOGW("A seek operation is in progress, ignoring reverse playback request");
+            return;
+        }
+    }
+    ReversePlayback::Config config;
+    config.url = m_param.url;
+    config.startUs = m_lastPlayPtsUs.load();
+    // 更新serial，正向解码器中的帧全部视为过期
+    config.serial = ++m_serial;
+    config.memoryBudgetBytes = m_param.reverseCacheBytes;
+    if (m_param.displaySizeAwareDecoding) {
+        config.maxWidth = m_renderWidth.load();
+        config.maxHeight = m_renderHeight.load();
+    }
+    config.pixelFormat = m_param.downgradePixelFormat;
+    try {
+        auto playback = std::make_unique<ReversePlayback>(config);
+        std::lock_guard<std::mutex> lock(m_reverseMutex);
+        m_reversePlayback = std::move(playback);
+    } catch (const std::exception& e) {
+        NEAPU_LOGE("Failed to start reverse playback: {}", e.what());
+        return;
+    }
+    m_trickAnchorWallUs = 0;
+    m_reversing = true;
+}
+void PlayerImpl::recordSeekFirstFrame()
+{
+    const int64_t seekStartUs = m_seekStartUs.exchange(0);
+    if (seekStartUs > 0) {
+        Metrics::instance().set("seek.first_frame_us", getCurrentTimeUs() - seekStartUs);
+    }
+}
 void PlayerImpl::createAudioDecoder()
 {
     m_audioDecoder = std::make_unique<AudioDecoder>(
         m_demuxer->audioStream(),
-        [this]() { return m_demuxer->getAudioPacket(); });
+        [this]() { return m_demuxer->getAudioPacket(); },
+        m_param.audioThreadConfig,
+        AudioDecoder::OutputConfig{m_param.audioSampleFormat, m_param.audioOutputSampleRate, m_param.audioResampleQuality,
+            m_param.audioOutputChannels});
+    // 解码输出为交错的目标格式，采样率和声道数与设备一致
+    m_audioRing = std::make_shared<AudioRingBuffer>(m_audioDecoder->outputSampleRate(), m_audioDecoder->outputChannelCount(),
+        Frame::bytesPerSample(m_param.audioSampleFormat), m_param.audioBufferMs);
+    m_audioDecoder->setOutputRing(m_audioRing);
+    m_audioDecoder->setPlaybackRate(m_playbackRate.load());
+    if (!m_param.audioFilters.empty()) {
+        m_audioDecoder->setFilter({m_param.audioFilters, m_param.filterThreads});
+    }
     m_audioDecoder->start();
     NEAPU_LOGI("Audio decoder created successfully");
 }
+std::optional<int64_t> PlayerImpl::clockUs() const
+{
+    // 快进快退时按关键帧节奏显示，不参与滞后丢帧和降级
+    if (!m_playing.load() || m_trickSpeed.load() != 0 || m_reversing.load() || m_scrubbing.load()) {
+        return std::nullopt;
+    }
+    const int64_t startTimeUs = m_startTimeUs.load();
+    if (startTimeUs <= 0) {
+        return std::nullopt;
+    }
+    return clockAt(getCurrentTimeUs(), startTimeUs);
+}
+int64_t PlayerImpl::clockAt(int64_t nowUs, int64_t startTimeUs) const
+{
+    return static_cast<int64_t>(static_cast<double>(nowUs - startTimeUs) * m_clockRate.load());
+}
+int64_t PlayerImpl::clockStartFor(int64_t nowUs, int64_t ptsUs) const
+{
+    return nowUs - static_cast<int64_t>(static_cast<double>(ptsUs) / m_clockRate.load());
+}
+void PlayerImpl::setPlaybackRate(double rate)
+{
+    rate = std::clamp(rate, MIN_PLAYBACK_RATE, MAX_PLAYBACK_RATE);
+    const double oldRate = m_playbackRate.exchange(rate);
+    if (rate == oldRate) {
+        return;
+    }
+    NEAPU_LOGI("Playback rate {} -> {}", oldRate, rate);
+    if (m_audioDecoder && !m_audioEof.load()) {
+        // 时钟在读到新速率的音频时切换
+        m_audioDecoder->setPlaybackRate(rate);
+        return;
+    }
+    // 无音频或音频已结束，在当前位置按新速率重新锚定
+    const int64_t nowUs = getCurrentTimeUs();
+    const int64_t startTimeUs = m_startTimeUs.load();
+    const int64_t positionUs = startTimeUs > 0 ? clockAt(nowUs, startTimeUs) : m_lastPlayPtsUs.load();
+    m_clockRate = rate;
+    if (startTimeUs > 0) {
+        m_startTimeUs = clockStartFor(nowUs, positionUs);
+    }
+}
 void PlayerImpl::play() 
 {
-    m_startTimeUs = getCurrentTimeUs() - m_lastPlayPtsUs.load();
+    m_stepRequest = 0;
+    m_stepSeekPending = false;
+    m_startTimeUs = clockStartFor(getCurrentTimeUs(), m_lastPlayPtsUs.load());
+    m_trickAnchorWallUs = 0;
     m_playing = true;
+    if (m_stepResync.exchange(false)) {
+        // 逐帧后退后解码器和音频都不在当前画面之后，精确seek回当前画面继续播放
+        startSeek(static_cast<double>(m_lastPlayPtsUs.load()) / 1e6, SeekMode::Accurate);
+    }
 }
 void PlayerImpl::pause() 
 {
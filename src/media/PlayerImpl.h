@@ -7,21 +7,48 @@
 #include "Demuxer.h"
 #include "VideoDecoder.h"
 #include "AudioDecoder.h"
+#include "ReversePlayback.h"
+#include "ScrubCache.h"
+#include "AudioScrubber.h"
+#include <condition_variable>
+#include <deque>
+#include <thread>
 
 namespace media {
 
 class PlayerImpl : public Player {
 public:
     PlayerImpl() = default;
-    ~PlayerImpl() override = default;
+    ~PlayerImpl() override { stopAudioEvents(); }
 
     FramePtr getVideoFrame() override;
-    FramePtr getAudioFrame() override;
+    uint32_t readAudio(void* output, uint32_t frameCount, int64_t deviceLatencyUs) override;
 
     bool open(const OpenParam& param) override;
     void close() override;
+    void shutdown() override;
 
-    void seek(double seconds) override;
+    void seek(double seconds, SeekMode mode = SeekMode::Fast) override;
+
+    void setTrickPlaySpeed(int speed) override;
+    int trickPlaySpeed() const override { return m_trickSpeed.load(); }
+
+    void setPlaybackRate(double rate) override;
+    double playbackRate() const override { return m_playbackRate.load(); }
+
+    void setReversePlayback(bool reverse) override;
+    bool isReversePlayback() const override { return m_reversing.load(); }
+
+    void stepForward() override;
+    void stepBackward() override;
+
+    bool beginScrub() override;
+    void scrubTo(double seconds) override;
+    void endScrub(double seconds) override;
+    bool isScrubbing() const override { return m_scrubbing.load(); }
+
+    void setRenderSize(int width, int height) override;
+    bool applyRenderSize() override;
 
     bool isOpened() const override;
 
@@ -31,6 +58,7 @@ public:
     double fps() const override;
     int sampleRate() const override;
     int channelCount() const override;
+    Frame::SampleFormat audioSampleFormat() const override { return m_param.audioSampleFormat; }
 
     double durationSeconds() const override;
 
@@ -41,31 +69,100 @@ public:
     
     int64_t lastPlayPtsUs() const override { return m_lastPlayPtsUs.load(); }
 
+    std::map<std::string, int64_t> metrics() const override;
+
 #ifdef __linux__
     void* vaDisplay() const override;
 #endif
 private:
+    // 视频解码器探测阶段读取的包
+    struct ProbeReplay {
+        std::vector<PacketPtr> packets;
+        bool recording{true};
+    };
+
     void createVideoDecoder();
+    PacketPtr nextProbePacket(ProbeReplay& replay, size_t& cursor);
     void createAudioDecoder();
+    void startAudioEvents();
+    void stopAudioEvents();
+    void audioEventThreadFunc();
+    std::optional<int64_t> clockUs() const;
+    // 播放时钟：媒体时间 = (当前时间 - m_startTimeUs) * m_clockRate
+    int64_t clockAt(int64_t nowUs, int64_t startTimeUs) const;
+    // nowUs 时刻媒体时间为 ptsUs 时对应的 m_startTimeUs
+    int64_t clockStartFor(int64_t nowUs, int64_t ptsUs) const;
+    void recordSeekFirstFrame();
+    // applyMode 在确认可以seek之后、冲刷之前调用，seek被拒绝时不调用
+    bool startSeek(double seconds, SeekMode mode, bool allowPaused = false, const std::function<void()>& applyMode = nullptr);
+    FramePtr nextVideoFrame();
+    bool prepareNextVideoFrame();
+    FramePtr presentTrickFrame(int speed);
+    void requestStep(int step);
+    FramePtr handleStepRequest();
+    FramePtr refillStepRing();
+    FramePtr presentStepFrame(FramePtr frame);
+    FramePtr presentScrubFrame();
+    void recordPresentedFrame(const Frame& frame);
 
 private:
     OpenParam m_param;
     std::unique_ptr<Demuxer> m_demuxer;
     std::unique_ptr<AudioDecoder> m_audioDecoder;
+    // 音频解码器写入、音频回调读出；回调只更新下面的原子量，
+    // 进度通知、结束通知等由音频事件线程根据这些状态完成
+    std::shared_ptr<AudioRingBuffer> m_audioRing;
+    std::atomic_int m_audioReadSerial{-1}; // 最近一次读出数据的serial
+    std::atomic<uint64_t> m_audioFramesRead{0};
+    std::atomic<int64_t> m_audioUnderruns{0};
+    std::atomic_bool m_audioEventRunning{false};
+    std::mutex m_audioEventMutex;
+    std::condition_variable m_audioEventCondVar;
+    std::thread m_audioEventThread;
     std::unique_ptr<VideoDecoder> m_videoDecoder;
 
     std::atomic_int m_serial{0};
     std::atomic<int64_t> m_startTimeUs{0};
+    std::atomic<double> m_playbackRate{1.0};
+    // 时钟当前的推进速率。有音频时跟随读出的音频，缓冲区中按旧速率拉伸的数据播完后才切换
+    std::atomic<double> m_clockRate{1.0};
     std::atomic<int64_t> m_lastPlayPtsUs{0};
     std::atomic_bool m_playing{false};
+    std::atomic<int64_t> m_seekStartUs{0}; // seek发起时间，输出第一帧后清零
+    std::atomic_int m_trickSpeed{0};
+    std::atomic<int64_t> m_trickAnchorWallUs{0}; // 0 表示需要重新锚定
+    int64_t m_trickAnchorPtsUs{0};
+
+    std::atomic_bool m_reversing{false};
+    std::mutex m_reverseMutex;
+    std::unique_ptr<ReversePlayback> m_reversePlayback;
     bool m_videoSeeking{false};
     bool m_audioSeeking{false};
     std::mutex m_seekMutex;
     std::atomic_bool m_videoEof{false};
     std::atomic_bool m_audioEof{false};
 
+    std::atomic_int m_renderWidth{0};
+    std::atomic_int m_renderHeight{0};
+
+    std::atomic_bool m_scrubbing{false};
+    std::atomic<int64_t> m_scrubTargetUs{-1};
+    std::atomic<int64_t> m_scrubShownUs{-1}; // 已显示的拖动位置
+    std::atomic<int64_t> m_scrubLookupUs{-1}; // 已统计过命中率的拖动位置
+    std::mutex m_scrubMutex;
+    std::unique_ptr<ScrubCache> m_scrubCache;
+    std::unique_ptr<AudioScrubber> m_audioScrubber; // 拖动期间音频回调只读，不在拖动中创建或销毁
+
+    // 逐帧：正数前进，负数后退，由渲染线程消费
+    std::atomic_int m_stepRequest{0};
+    // 最近显示帧，队首最新；m_stepCursor为当前显示帧在其中的位置，只在渲染线程访问
+    std::deque<FramePtr> m_stepRing;
+    size_t m_stepCursor{0};
+    std::atomic_bool m_stepSeekPending{false}; // 后退缓存用尽后的seek尚未完成
+    int64_t m_stepRefillUntilUs{0}; // 重新填充缓存时解码到此pts之前
+    std::atomic_bool m_stepResync{false}; // 后退过，恢复播放时需要seek回当前画面
+
     FramePtr m_nextVideoFrame;
-    FramePtr m_nextAudioFrame;
 };
 
 } // namespace media
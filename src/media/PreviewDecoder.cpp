@@ -0,0 +1,150 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#include "PreviewDecoder.h"
+#include <algorithm>
+#include <chrono>
+#include <logger.h>
+#include "Metrics.h"
+#include "WorkerThread.h"
+extern "C" {
+#include <libavutil/pixfmt.h>
+#include <libswscale/swscale.h>
+}
+
+namespace media {
+// 缩略图只需要看清内容，解码器支持时内部直接降到1/4分辨率
+constexpr int PREVIEW_LOWRES = 2;
+
+static int64_t steadyNowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+PreviewDecoder::PreviewDecoder(const Config& config, ThumbnailCallback callback)
+    : m_config(config)
+    , m_callback(std::move(callback))
+{
+    m_config.maxCpuShare = std::clamp(m_config.maxCpuShare, 0.05, 1.0);
+    m_workerThread = std::thread(&PreviewDecoder::workerThreadFunc, this);
+}
+PreviewDecoder::~PreviewDecoder()
+{
+    stopWorkerThread(m_mutex, m_condVar, m_workerThread, [this]() {
+        m_running = false;
+        m_requestId++;
+    });
+}
+uint64_t PreviewDecoder::request(int64_t positionUs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_targetUs = std::max<int64_t>(0, positionUs);
+    m_pendingTarget = true;
+    const uint64_t requestId = ++m_requestId;
+    m_condVar.notify_all();
+    return requestId;
+}
+void PreviewDecoder::cancel()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pendingTarget = false;
+    m_requestId++;
+}
+bool PreviewDecoder::openReader()
+{
+    try {
+        // 单线程解码，占用不超过一个核心
+        m_reader = std::make_unique<FrameReader>(m_config.url, FrameReader::MediaType::Video, 1, PREVIEW_LOWRES);
+    } catch (const std::exception& e) {
+        NEAPU_LOGE("Failed to open preview decoder: {}", e.what());
+        return false;
+    }
+    m_reader->setKeyframeOnly(true);
+    m_reader->setFastDecode(true);
+
+    FrameReader::VideoOutput output;
+    const int width = m_reader->width();
+    const int height = m_reader->height();
+    output.height = std::max(2, m_config.thumbnailHeight & ~1);
+    output.width = height > 0 ? std::max(2, static_cast<int>(static_cast<int64_t>(width) * output.height / height) & ~1) : output.height * 16 / 9;
+    output.pixelFormat = AV_PIX_FMT_RGBA;
+    output.swsFlags = SWS_FAST_BILINEAR;
+    m_reader->setVideoOutput(output);
+    return true;
+}
+void PreviewDecoder::workerThreadFunc()
+{
+    if (!openReader()) {
+        return;
+    }
+    while (m_running) {
+        int64_t targetUs = 0;
+        uint64_t requestId = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condVar.wait(lock, [this]() { return !m_running || m_pendingTarget; });
+            if (!m_running) {
+                break;
+            }
+            m_pendingTarget = false;
+            targetUs = m_targetUs;
+            requestId = m_requestId.load();
+        }
+
+        const int64_t startUs = steadyNowUs();
+        auto frame = decodeThumbnail(targetUs, requestId);
+        const int64_t elapsedUs = steadyNowUs() - startUs;
+        if (frame && requestId == m_requestId.load() && m_callback) {
+            m_callback(requestId, targetUs, std::move(frame));
+        }
+
+        // 按占空比空闲，期间到达的请求只保留最新的一个
+        const auto idleUs = static_cast<int64_t>(static_cast<double>(elapsedUs) * (1.0 - m_config.maxCpuShare) / m_config.maxCpuShare);
+        if (idleUs > 0) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condVar.wait_for(lock, std::chrono::microseconds(idleUs), [this]() { return !m_running.load(); });
+        }
+    }
+}
+FramePtr PreviewDecoder::decodeThumbnail(int64_t positionUs, uint64_t requestId)
+{
+    // 同一个关键帧覆盖的范围内悬停时直接复用缩略图
+    const int64_t keyframeUs = m_reader->keyframeBeforeUs(positionUs);
+    if (keyframeUs >= 0) {
+        if (auto it = m_cache.find(keyframeUs); it != m_cache.end()) {
+            Metrics::instance().add("preview.cache_hit");
+            return it->second->ref();
+        }
+    }
+
+    if (!m_reader->seek(positionUs)) {
+        return nullptr;
+    }
+    if (requestId != m_requestId.load()) {
+        Metrics::instance().add("preview.cancelled");
+        return nullptr;
+    }
+    const int64_t startUs = steadyNowUs();
+    auto frame = m_reader->readFrame();
+    if (!frame) {
+        return nullptr;
+    }
+    auto& metrics = Metrics::instance();
+    metrics.add("preview.decoded");
+    metrics.set("preview.decode_us", steadyNowUs() - startUs);
+
+    if (keyframeUs >= 0 && m_config.cacheEntries > 0) {
+        if (m_cacheOrder.size() >= m_config.cacheEntries) {
+            m_cache.erase(m_cacheOrder.front());
+            m_cacheOrder.pop_front();
+        }
+        if (auto ref = frame->ref()) {
+            m_cache.emplace(keyframeUs, std::move(ref));
+            m_cacheOrder.push_back(keyframeUs);
+        }
+    }
+    return frame;
+}
+} // namespace media
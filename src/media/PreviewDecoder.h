@@ -0,0 +1,68 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "Frame.h"
+#include "FrameReader.h"
+
+namespace media {
+
+// 进度条悬停预览。独立的解复用和单线程软件解码，只解码目标位置之前最近的关键帧，
+// 缩小为RGBA缩略图。新请求使旧请求失效，解码耗时按占空比限制，不影响主播放
+class PreviewDecoder {
+public:
+    struct Config {
+        std::string url;
+        int thumbnailHeight{90}; // 宽度按比例计算
+        // 解码耗时占后台线程时间的最大比例，解码一次后按比例空闲
+        double maxCpuShare{0.25};
+        size_t cacheEntries{64}; // 按关键帧缓存的缩略图数量
+    };
+    // 在后台线程回调，frame 为RGBA格式；requestId 对应 request() 的返回值
+    using ThumbnailCallback = std::function<void(uint64_t requestId, int64_t positionUs, FramePtr frame)>;
+
+    PreviewDecoder(const Config& config, ThumbnailCallback callback);
+    ~PreviewDecoder();
+    PreviewDecoder(const PreviewDecoder&) = delete;
+    PreviewDecoder& operator=(const PreviewDecoder&) = delete;
+
+    // 请求 positionUs 处的缩略图，返回请求编号，尚未处理的旧请求被丢弃
+    uint64_t request(int64_t positionUs);
+    // 取消尚未完成的请求
+    void cancel();
+
+private:
+    void workerThreadFunc();
+    bool openReader();
+    FramePtr decodeThumbnail(int64_t positionUs, uint64_t requestId);
+
+private:
+    Config m_config;
+    ThumbnailCallback m_callback;
+    std::unique_ptr<FrameReader> m_reader; // 在后台线程打开，避免阻塞界面
+
+    // 只在后台线程访问
+    std::map<int64_t, FramePtr> m_cache; // 关键帧时间 -> 缩略图
+    std::deque<int64_t> m_cacheOrder;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condVar;
+    int64_t m_targetUs{0};
+    bool m_pendingTarget{false};
+    std::atomic<uint64_t> m_requestId{0};
+
+    std::atomic_bool m_running{true};
+    std::thread m_workerThread;
+};
+
+} // namespace media
@@ -0,0 +1,192 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#include "ReversePlayback.h"
+#include <algorithm>
+#include <logger.h>
+#include "Metrics.h"
+#include "WorkerThread.h"
+
+namespace media {
+// 关键帧索引不精确时，定位回到同一个GOP的重试次数，每次回退距离翻倍
+constexpr int MAX_GOP_SEEK_RETRIES = 5;
+constexpr int MAX_SCALE_SHIFT = 2; // 最多缩小到1/4
+
+ReversePlayback::ReversePlayback(const Config& config)
+    : m_config(config)
+    , m_reader(config.url, FrameReader::MediaType::Video)
+    , m_nextEndUs(config.startUs + 1)
+    , m_serial(config.serial)
+{
+    NEAPU_LOGI("Starting reverse playback from {} us, budget {} bytes", config.startUs, config.memoryBudgetBytes);
+    m_workerThread = std::thread(&ReversePlayback::workerThreadFunc, this);
+}
+ReversePlayback::~ReversePlayback()
+{
+    stopWorkerThread(m_mutex, m_condVar, m_workerThread, [this]() {
+        m_running = false;
+        m_generation++;
+    });
+}
+FramePtr ReversePlayback::getFrame()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while (!m_gops.empty()) {
+        auto& gop = m_gops.front();
+        if (gop.frames.empty()) {
+            m_gops.pop_front();
+            m_condVar.notify_all(); // 腾出了预算，唤醒后台解码
+            continue;
+        }
+        auto frame = std::move(gop.frames.back());
+        gop.frames.pop_back();
+        const size_t size = frame->dataSize();
+        gop.bytes -= std::min(gop.bytes, size);
+        m_cachedBytes -= std::min(m_cachedBytes, size);
+        return frame;
+    }
+    return nullptr;
+}
+bool ReversePlayback::isFinished() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_reachedStart) {
+        return false;
+    }
+    return std::ranges::all_of(m_gops, [](const Gop& gop) { return gop.frames.empty(); });
+}
+void ReversePlayback::seek(int64_t positionUs, int serial)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_generation++;
+    m_gops.clear();
+    m_cachedBytes = 0;
+    m_nextEndUs = positionUs + 1;
+    m_serial = serial;
+    m_reachedStart = false;
+    m_condVar.notify_all();
+}
+void ReversePlayback::workerThreadFunc()
+{
+    while (m_running) {
+        int64_t endUs = 0;
+        uint64_t generation = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            // 正在输出的GOP之外只预取一个，两个GOP都受单GOP预算约束，总量不超过预算
+            m_condVar.wait(lock, [this]() {
+                return !m_running || (!m_reachedStart && m_gops.size() < 2);
+            });
+            if (!m_running) {
+                break;
+            }
+            endUs = m_nextEndUs;
+            generation = m_generation.load();
+            m_reader.setSerial(m_serial);
+        }
+
+        Gop gop;
+        const bool hasEarlier = decodeGop(endUs, generation, gop);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (generation != m_generation.load()) {
+            continue; // 期间发生了seek
+        }
+        m_nextEndUs = gop.startUs;
+        m_reachedStart = !hasEarlier;
+        if (!gop.frames.empty()) {
+            m_cachedBytes += gop.bytes;
+            m_gops.push_back(std::move(gop));
+        }
+        auto& metrics = Metrics::instance();
+        metrics.add("reverse.gops");
+        metrics.set("reverse.cache_bytes", static_cast<int64_t>(m_cachedBytes));
+    }
+}
+bool ReversePlayback::decodeGop(int64_t endUs, uint64_t generation, Gop& gop)
+{
+    const int64_t streamStartUs = m_reader.startTimeUs();
+    const size_t gopBudget = m_config.memoryBudgetBytes / 2;
+    int64_t seekUs = endUs - 1;
+    for (int retry = 0;; retry++) {
+        if (seekUs < streamStartUs || !m_reader.seek(seekUs)) {
+            return false;
+        }
+        int decimation = 1; // 每隔几帧保留一帧
+        int scaleShift = 0;
+        m_reader.setVideoOutput(outputForScale(scaleShift));
+        gop.frames.clear();
+        gop.bytes = 0;
+        gop.startUs = INT64_MAX;
+        int frameIndex = 0;
+        while (auto frame = m_reader.readFrame()) {
+            if (generation != m_generation.load()) {
+                return true;
+            }
+            const int64_t ptsUs = frame->ptsUs();
+            gop.startUs = std::min(gop.startUs, ptsUs);
+            if (ptsUs >= endUs) {
+                break;
+            }
+            if (frameIndex++ % decimation != 0) {
+                continue;
+            }
+            gop.bytes += frame->dataSize();
+            gop.frames.push_back(std::move(frame));
+            if (gop.bytes > gopBudget) {
+                spill(gop, decimation, scaleShift);
+            }
+        }
+        if (gop.startUs == INT64_MAX) {
+            return false; // 没有解码出任何帧
+        }
+        if (!gop.frames.empty() || retry >= MAX_GOP_SEEK_RETRIES) {
+            break;
+        }
+        // 定位落在了endUs之后的关键帧上，向前加大回退距离
+        seekUs = endUs - (int64_t{1'000'000} << retry);
+    }
+    if (gop.frames.empty() || gop.startUs >= endUs) {
+        return false;
+    }
+    return gop.startUs > streamStartUs;
+}
+void ReversePlayback::spill(Gop& gop, int& decimation, int& scaleShift)
+{
+    // GOP过长：已缓存的帧隔帧丢弃，之后的帧降低分辨率并按同样间隔抽取
+    std::vector<FramePtr> kept;
+    kept.reserve(gop.frames.size() / 2 + 1);
+    gop.bytes = 0;
+    for (size_t i = 0; i < gop.frames.size(); i += 2) {
+        gop.bytes += gop.frames[i]->dataSize();
+        kept.push_back(std::move(gop.frames[i]));
+    }
+    gop.frames = std::move(kept);
+    decimation *= 2;
+    if (scaleShift < MAX_SCALE_SHIFT) {
+        scaleShift++;
+        m_reader.setVideoOutput(outputForScale(scaleShift));
+    }
+    Metrics::instance().add("reverse.spill");
+    NEAPU_LOGI("Reverse playback GOP exceeds budget, keeping every {} frames at 1/{} scale", decimation, 1 << scaleShift);
+}
+FrameReader::VideoOutput ReversePlayback::outputForScale(int scaleShift) const
+{
+    int width = m_reader.width();
+    int height = m_reader.height();
+    if (m_config.maxWidth > 0 && m_config.maxHeight > 0 && width > 0 && height > 0 &&
+        (width > m_config.maxWidth || height > m_config.maxHeight)) {
+        // 按显示尺寸等比缩小
+        const double scale = std::min(static_cast<double>(m_config.maxWidth) / width,
+            static_cast<double>(m_config.maxHeight) / height);
+        width = static_cast<int>(width * scale);
+        height = static_cast<int>(height * scale);
+    }
+    FrameReader::VideoOutput output;
+    output.width = std::max(2, (width >> scaleShift) & ~1);
+    output.height = std::max(2, (height >> scaleShift) & ~1);
+    output.pixelFormat = Frame::toAVPixelFormat(m_config.pixelFormat);
+    return output;
+}
+} // namespace media
@@ -0,0 +1,74 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Frame.h"
+#include "FrameReader.h"
+
+namespace media {
+
+// 倒放：从当前位置起逐个向前定位GOP，正向解码整个GOP后倒序输出。
+// 后台线程预先解码前一个GOP，缓存总量受内存预算限制，
+// 单个GOP超出预算一半时降低分辨率并隔帧抽取
+class ReversePlayback {
+public:
+    struct Config {
+        std::string url;
+        int64_t startUs{0};
+        int serial{0};
+        size_t memoryBudgetBytes{256 * 1024 * 1024};
+        // 缓存帧的最大尺寸，0 表示使用源尺寸
+        int maxWidth{0};
+        int maxHeight{0};
+        Frame::PixelFormat pixelFormat{Frame::PixelFormat::YUV420P};
+    };
+    explicit ReversePlayback(const Config& config);
+    ~ReversePlayback();
+    ReversePlayback(const ReversePlayback&) = delete;
+    ReversePlayback& operator=(const ReversePlayback&) = delete;
+
+    // 按倒序取下一帧，尚未解码完成时返回空，不阻塞
+    FramePtr getFrame();
+    // 已经倒放到开头并且所有帧都已取走
+    bool isFinished() const;
+    // 从新位置重新开始倒放，之后输出的帧使用新的serial
+    void seek(int64_t positionUs, int serial);
+
+private:
+    struct Gop {
+        int64_t startUs{0}; // GOP首个关键帧的时间，也是下一个GOP的结束位置
+        std::vector<FramePtr> frames; // 按显示顺序
+        size_t bytes{0};
+    };
+    void workerThreadFunc();
+    // 解码 [关键帧, endUs) 范围内的帧，返回false表示前面已经没有内容
+    bool decodeGop(int64_t endUs, uint64_t generation, Gop& gop);
+    void spill(Gop& gop, int& decimation, int& scaleShift);
+    FrameReader::VideoOutput outputForScale(int scaleShift) const;
+
+private:
+    Config m_config;
+    FrameReader m_reader;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condVar;
+    std::deque<Gop> m_gops; // 头部为正在输出的GOP（时间最晚）
+    size_t m_cachedBytes{0};
+    int64_t m_nextEndUs{0};
+    int m_serial{0};
+    bool m_reachedStart{false};
+    std::atomic<uint64_t> m_generation{0};
+
+    std::atomic_bool m_running{true};
+    std::thread m_workerThread;
+};
+
+} // namespace media
@@ -0,0 +1,159 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#include "ScrubCache.h"
+#include <algorithm>
+#include <logger.h>
+#include "Metrics.h"
+#include "WorkerThread.h"
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+namespace media {
+// 目标在当前解码位置之后这个范围内时继续向后解码，不重新seek
+constexpr int64_t MAX_FORWARD_DECODE_US = 2'000'000;
+
+ScrubCache::ScrubCache(const Config& config)
+    : m_config(config)
+    , m_reader(config.url, FrameReader::MediaType::Video)
+    , m_startUs(m_reader.startTimeUs())
+{
+    const AVRational frameRate = m_reader.stream()->avg_frame_rate;
+    if (frameRate.num > 0 && frameRate.den > 0) {
+        m_defaultFrameDurationUs = static_cast<int64_t>(1e6 / av_q2d(frameRate));
+    }
+
+    FrameReader::VideoOutput output;
+    const int width = m_reader.width();
+    const int height = m_reader.height();
+    if (m_config.maxHeight > 0 && width > 0 && height > m_config.maxHeight) {
+        // 拖动时画面只需要看清内容，按高度等比缩小以减少缩放和缓存开销
+        output.width = std::max(2, static_cast<int>(static_cast<int64_t>(width) * m_config.maxHeight / height) & ~1);
+        output.height = m_config.maxHeight & ~1;
+    }
+    output.pixelFormat = Frame::toAVPixelFormat(m_config.pixelFormat);
+    m_reader.setVideoOutput(output);
+
+    NEAPU_LOGI("Scrub cache created, budget {} bytes, output {}x{}",
+        m_config.memoryBudgetBytes, output.width > 0 ? output.width : width, output.height > 0 ? output.height : height);
+    m_workerThread = std::thread(&ScrubCache::workerThreadFunc, this);
+}
+ScrubCache::~ScrubCache()
+{
+    stopWorkerThread(m_mutex, m_condVar, m_workerThread, [this]() {
+        m_running = false;
+        m_generation++;
+    });
+}
+FramePtr ScrubCache::lookup(int64_t positionUs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = findLocked(clampPosition(positionUs));
+    if (it == m_frames.end()) {
+        return nullptr;
+    }
+    m_lru.splice(m_lru.begin(), m_lru, it->second.lruIt);
+    return it->second.frame->ref();
+}
+void ScrubCache::request(int64_t positionUs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_targetUs = clampPosition(positionUs);
+    m_pendingTarget = true;
+    m_generation++;
+    m_condVar.notify_all();
+}
+size_t ScrubCache::cachedBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cachedBytes;
+}
+int64_t ScrubCache::clampPosition(int64_t positionUs) const
+{
+    return std::max(positionUs, m_startUs);
+}
+ScrubCache::EntryMap::iterator ScrubCache::findLocked(int64_t positionUs)
+{
+    auto it = m_frames.upper_bound(positionUs);
+    if (it == m_frames.begin()) {
+        return m_frames.end();
+    }
+    --it;
+    if (positionUs < it->second.endUs || it->first == m_lastFramePtsUs) {
+        return it;
+    }
+    return m_frames.end();
+}
+void ScrubCache::insert(FramePtr&& frame, int64_t endUs)
+{
+    const int64_t ptsUs = frame->ptsUs();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_frames.contains(ptsUs)) {
+        return;
+    }
+    const size_t size = frame->dataSize();
+    m_lru.push_front(ptsUs);
+    m_frames.emplace(ptsUs, Entry{std::move(frame), endUs, m_lru.begin()});
+    m_cachedBytes += size;
+    // 淘汰最久未使用的帧，刚解码的这一帧保留
+    while (m_cachedBytes > m_config.memoryBudgetBytes && m_lru.size() > 1) {
+        auto victim = m_frames.find(m_lru.back());
+        m_cachedBytes -= std::min(m_cachedBytes, victim->second.frame->dataSize());
+        m_frames.erase(victim);
+        m_lru.pop_back();
+        Metrics::instance().add("scrub.evict");
+    }
+}
+void ScrubCache::workerThreadFunc()
+{
+    int64_t decodedUntilUs = INT64_MIN; // 解码器已输出到的位置，INT64_MIN 表示下次需要seek
+    while (m_running) {
+        int64_t targetUs = 0;
+        uint64_t generation = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condVar.wait(lock, [this]() { return !m_running || m_pendingTarget; });
+            if (!m_running) {
+                break;
+            }
+            m_pendingTarget = false;
+            targetUs = m_targetUs;
+            generation = m_generation.load();
+            if (findLocked(targetUs) != m_frames.end()) {
+                continue;
+            }
+        }
+
+        // 向后小范围拖动时沿用当前解码位置，省去从关键帧重新解码
+        if (decodedUntilUs == INT64_MIN || m_reader.isEof() ||
+            targetUs < decodedUntilUs || targetUs - decodedUntilUs > MAX_FORWARD_DECODE_US) {
+            if (!m_reader.seek(targetUs)) {
+                decodedUntilUs = INT64_MIN;
+                continue;
+            }
+        }
+        int64_t lastPtsUs = INT64_MIN;
+        while (auto frame = m_reader.readFrame()) {
+            const int64_t ptsUs = frame->ptsUs();
+            const int64_t durationUs = frame->durationUs() > 0 ? frame->durationUs() : m_defaultFrameDurationUs;
+            lastPtsUs = ptsUs;
+            decodedUntilUs = ptsUs + durationUs;
+            insert(std::move(frame), decodedUntilUs);
+            Metrics::instance().add("scrub.decoded");
+            if (decodedUntilUs > targetUs || generation != m_generation.load()) {
+                // 覆盖了目标，或者目标已变化，回到外层重新判断是否需要seek
+                break;
+            }
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_reader.isEof() && lastPtsUs != INT64_MIN) {
+            m_lastFramePtsUs = lastPtsUs;
+        }
+        auto& metrics = Metrics::instance();
+        metrics.set("scrub.cache_bytes", static_cast<int64_t>(m_cachedBytes));
+        metrics.set("scrub.cache_frames", static_cast<int64_t>(m_frames.size()));
+    }
+}
+} // namespace media
@@ -0,0 +1,75 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "Frame.h"
+#include "FrameReader.h"
+
+namespace media {
+
+// 拖动进度条时的解码帧缓存，按pts索引，LRU淘汰，总量受内存上限约束。
+// 后台线程用独立的FrameReader解码，从关键帧到目标位置沿途的帧全部入缓存，
+// 来回拖动经过同一区域时每帧只解码一次
+class ScrubCache {
+public:
+    struct Config {
+        std::string url;
+        size_t memoryBudgetBytes{128 * 1024 * 1024};
+        // 缓存帧的最大高度，按比例缩小，0 表示使用源尺寸
+        int maxHeight{540};
+        Frame::PixelFormat pixelFormat{Frame::PixelFormat::YUV420P};
+    };
+    explicit ScrubCache(const Config& config);
+    ~ScrubCache();
+    ScrubCache(const ScrubCache&) = delete;
+    ScrubCache& operator=(const ScrubCache&) = delete;
+
+    // 查找覆盖 positionUs 的缓存帧，命中时返回一个引用，不经过解码器
+    FramePtr lookup(int64_t positionUs);
+    // 让后台线程解码 positionUs 处的帧，新的请求会取代尚未完成的请求
+    void request(int64_t positionUs);
+
+    size_t cachedBytes() const;
+
+private:
+    struct Entry {
+        FramePtr frame;
+        int64_t endUs{0};
+        std::list<int64_t>::iterator lruIt;
+    };
+    using EntryMap = std::map<int64_t, Entry>;
+
+    void workerThreadFunc();
+    EntryMap::iterator findLocked(int64_t positionUs);
+    void insert(FramePtr&& frame, int64_t endUs);
+    int64_t clampPosition(int64_t positionUs) const;
+
+private:
+    Config m_config;
+    FrameReader m_reader;
+    int64_t m_startUs{0};
+    int64_t m_defaultFrameDurationUs{40'000};
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condVar;
+    EntryMap m_frames;
+    std::list<int64_t> m_lru; // 头部为最近使用
+    size_t m_cachedBytes{0};
+    int64_t m_lastFramePtsUs{INT64_MAX}; // 解码到结尾后记录最后一帧，之后的位置都由它覆盖
+    int64_t m_targetUs{0};
+    bool m_pendingTarget{false};
+    std::atomic<uint64_t> m_generation{0};
+
+    std::atomic_bool m_running{true};
+    std::thread m_workerThread;
+};
+
+} // namespace media
@@ -0,0 +1,384 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#include "ThumbnailStrip.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <logger.h>
+#include "DecoderPool.h"
+#include "FrameReader.h"
+#include "Metrics.h"
+extern "C" {
+#include <libavutil/pixfmt.h>
+#include <libswscale/swscale.h>
+}
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace media {
+namespace fs = std::filesystem;
+
+constexpr uint32_t STRIP_FILE_VERSION = 1;
+constexpr char STRIP_FILE_MAGIC[8] = {'N', 'V', 'P', 'S', 'T', 'R', 'I', 'P'};
+constexpr size_t FINGERPRINT_SAMPLE_BYTES = 64 * 1024; // 指纹取文件头尾各64KB
+constexpr int THUMBNAIL_LOWRES = 2;
+
+// 缓存文件头，之后紧跟 count * height * stride 字节的RGBA数据
+struct StripFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;
+    uint32_t reserved0;
+    uint64_t fingerprint;
+    int64_t startUs;
+    int64_t intervalUs;
+    uint64_t reserved1;
+};
+static_assert(sizeof(StripFileHeader) == 64, "StripFileHeader must stay 64 bytes so pixel rows are aligned");
+
+static int64_t steadyNowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 只读映射整个文件
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path)
+    {
+#ifdef _WIN32
+        m_file = CreateFileW(fs::path(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE) {
+            return;
+        }
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+            return;
+        }
+        m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!m_mapping) {
+            return;
+        }
+        m_data = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+        if (m_data) {
+            m_size = static_cast<size_t>(size.QuadPart);
+        }
+#else
+        m_fd = open(path.c_str(), O_RDONLY);
+        if (m_fd < 0) {
+            return;
+        }
+        struct stat st{};
+        if (fstat(m_fd, &st) != 0 || st.st_size == 0) {
+            return;
+        }
+        void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, m_fd, 0);
+        if (data != MAP_FAILED) {
+            m_data = data;
+            m_size = static_cast<size_t>(st.st_size);
+        }
+#endif
+    }
+    ~MappedFile()
+    {
+#ifdef _WIN32
+        if (m_data) UnmapViewOfFile(m_data);
+        if (m_mapping) CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+#else
+        if (m_data) munmap(m_data, m_size);
+        if (m_fd >= 0) close(m_fd);
+#endif
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data() const { return static_cast<const uint8_t*>(m_data); }
+    size_t size() const { return m_size; }
+
+private:
+#ifdef _WIN32
+    HANDLE m_file{INVALID_HANDLE_VALUE};
+    HANDLE m_mapping{nullptr};
+#else
+    int m_fd{-1};
+#endif
+    void* m_data{nullptr};
+    size_t m_size{0};
+};
+
+ThumbnailStrip::ThumbnailStrip(const Config& config, ProgressCallback callback)
+    : m_config(config)
+    , m_callback(std::move(callback))
+{
+    m_config.count = std::max(1, m_config.count);
+    m_config.thumbnailHeight = std::max(2, m_config.thumbnailHeight & ~1);
+    m_generatorThread = std::thread(&ThumbnailStrip::generatorThreadFunc, this);
+}
+ThumbnailStrip::~ThumbnailStrip()
+{
+    m_running = false;
+    if (m_generatorThread.joinable()) {
+        m_generatorThread.join();
+    }
+}
+const uint8_t* ThumbnailStrip::thumbnail(int index) const
+{
+    if (!isLayoutReady() || index < 0 || index >= m_count) {
+        return nullptr;
+    }
+    if (m_ready && !m_ready[index].load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    return m_data + static_cast<size_t>(index) * m_height * m_stride;
+}
+void ThumbnailStrip::generatorThreadFunc()
+{
+    const int64_t startTimeUs = steadyNowUs();
+    m_fingerprint = fingerprint();
+    if (loadCache()) {
+        Metrics::instance().add("thumbnails.cache_hit");
+        NEAPU_LOGI("Thumbnail strip loaded from cache for {}", m_config.url);
+        if (m_callback) {
+            m_callback(-1);
+        }
+        return;
+    }
+
+    std::unique_ptr<FrameReader> firstReader;
+    try {
+        firstReader = std::make_unique<FrameReader>(m_config.url, FrameReader::MediaType::Video, 1, THUMBNAIL_LOWRES);
+    } catch (const std::exception& e) {
+        NEAPU_LOGE("Failed to open thumbnail reader: {}", e.what());
+        return;
+    }
+    const int64_t durationUs = firstReader->durationUs();
+    if (durationUs <= 0 || firstReader->width() <= 0 || firstReader->height() <= 0) {
+        NEAPU_LOGW("Cannot generate thumbnail strip, unknown duration or size");
+        return;
+    }
+
+    m_count = m_config.count;
+    m_height = m_config.thumbnailHeight;
+    m_width = std::max(2, static_cast<int>(static_cast<int64_t>(firstReader->width()) * m_height / firstReader->height()) & ~1);
+    m_stride = m_width * 4;
+    m_startUs = firstReader->startTimeUs();
+    m_intervalUs = durationUs / m_count;
+    m_pixels.assign(static_cast<size_t>(m_count) * m_height * m_stride, 0);
+    m_ready = std::make_unique<std::atomic_bool[]>(m_count);
+    m_data = m_pixels.data();
+    m_layoutReady.store(true, std::memory_order_release);
+
+    int workerCount = m_config.workerCount;
+    if (workerCount <= 0) {
+        workerCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) / 2);
+    }
+    workerCount = std::min(workerCount, m_count);
+    // 每个线程负责一段连续的区间，只向后seek，读文件的局部性更好
+    const int segment = (m_count + workerCount - 1) / workerCount;
+    std::vector<std::thread> workers;
+    workers.reserve(workerCount);
+    for (int i = 0; i < workerCount; i++) {
+        const int begin = i * segment;
+        const int end = std::min(m_count, begin + segment);
+        if (begin >= end) {
+            break;
+        }
+        // 第一个线程沿用已打开的读取器，其余在各自线程里打开，打开文件本身也并行
+        workers.emplace_back(&ThumbnailStrip::workerFunc, this, i == 0 ? std::move(firstReader) : nullptr, begin, end);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (!m_running) {
+        return;
+    }
+
+    const int64_t elapsedUs = steadyNowUs() - startTimeUs;
+    Metrics::instance().set("thumbnails.generate_us", elapsedUs);
+    const int readyCount = static_cast<int>(std::count_if(m_ready.get(), m_ready.get() + m_count,
+        [](const std::atomic_bool& ready) { return ready.load(std::memory_order_acquire); }));
+    if (readyCount < m_count) {
+        // 有缩略图失败时只保留在内存中，不让一次偶发的失败永久留在缓存里
+        Metrics::instance().add("thumbnails.incomplete");
+        NEAPU_LOGW("Thumbnail strip incomplete, {} of {} thumbnails generated in {} us", readyCount, m_count, elapsedUs);
+        return;
+    }
+    NEAPU_LOGI("Thumbnail strip generated, {} thumbnails with {} workers in {} us", m_count, workers.size(), elapsedUs);
+    saveCache();
+    m_complete = true;
+}
+void ThumbnailStrip::workerFunc(std::unique_ptr<FrameReader> reader, int begin, int end)
+{
+    if (!reader) {
+        try {
+            reader = std::make_unique<FrameReader>(m_config.url, FrameReader::MediaType::Video, 1, THUMBNAIL_LOWRES);
+        } catch (const std::exception& e) {
+            NEAPU_LOGE("Failed to open thumbnail reader: {}", e.what());
+            return;
+        }
+    }
+    reader->setKeyframeOnly(true);
+    reader->setFastDecode(true);
+    FrameReader::VideoOutput output;
+    output.width = m_width;
+    output.height = m_height;
+    output.pixelFormat = AV_PIX_FMT_RGBA;
+    // 缩小倍数大，快速双线性的SIMD路径画质足够
+    output.swsFlags = SWS_FAST_BILINEAR;
+    reader->setVideoOutput(output);
+
+    const size_t thumbnailBytes = static_cast<size_t>(m_height) * m_stride;
+    int64_t lastKeyframeUs = -1;
+    int lastIndex = -1;
+    for (int i = begin; i < end && m_running; i++) {
+        const int64_t positionUs = m_startUs + m_intervalUs * i + m_intervalUs / 2;
+        uint8_t* dst = m_pixels.data() + thumbnailBytes * i;
+        const int64_t keyframeUs = reader->keyframeBeforeUs(positionUs);
+        if (keyframeUs >= 0 && keyframeUs == lastKeyframeUs && lastIndex >= 0) {
+            // GOP比间隔长，相邻区间落在同一个关键帧上，直接复制
+            std::memcpy(dst, m_pixels.data() + thumbnailBytes * lastIndex, thumbnailBytes);
+        } else {
+            if (!reader->seek(positionUs)) {
+                continue;
+            }
+            auto frame = reader->readFrame();
+            if (!frame || frame->width() != m_width || frame->height() != m_height) {
+                continue;
+            }
+            for (int y = 0; y < m_height; y++) {
+                std::memcpy(dst + static_cast<size_t>(y) * m_stride, frame->data(0) + static_cast<size_t>(y) * frame->lineSize(0), m_stride);
+            }
+            Metrics::instance().add("thumbnails.decoded");
+        }
+        lastKeyframeUs = keyframeUs;
+        lastIndex = i;
+        m_ready[i].store(true, std::memory_order_release);
+        if (m_callback) {
+            m_callback(i);
+        }
+    }
+}
+uint64_t ThumbnailStrip::fingerprint() const
+{
+    // 文件大小、修改时间和头尾内容，避免对大文件整体求哈希
+    PoolKeyBuilder builder;
+    std::error_code ec;
+    const fs::path path(m_config.url);
+    const auto size = fs::file_size(path, ec);
+    if (ec) {
+        return 0;
+    }
+    builder.add(static_cast<uint64_t>(size));
+    const auto mtime = fs::last_write_time(path, ec);
+    if (!ec) {
+        builder.add(static_cast<int64_t>(mtime.time_since_epoch().count()));
+    }
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> buffer(FINGERPRINT_SAMPLE_BYTES);
+    file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    builder.addBytes(buffer.data(), static_cast<size_t>(file.gcount()));
+    if (size > FINGERPRINT_SAMPLE_BYTES) {
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(size - FINGERPRINT_SAMPLE_BYTES));
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        builder.addBytes(buffer.data(), static_cast<size_t>(file.gcount()));
+    }
+    return builder.value();
+}
+std::string ThumbnailStrip::cachePath(uint64_t fingerprint) const
+{
+    char name[64];
+    std::snprintf(name, sizeof(name), "strip-%016llx-%dx%d.bin",
+        static_cast<unsigned long long>(fingerprint), m_config.count, m_config.thumbnailHeight);
+    return (fs::path(m_config.cacheDir) / name).string();
+}
+bool ThumbnailStrip::loadCache()
+{
+    if (m_config.cacheDir.empty() || m_fingerprint == 0) {
+        return false;
+    }
+    auto mapped = std::make_unique<MappedFile>(cachePath(m_fingerprint));
+    if (!mapped->data() || mapped->size() < sizeof(StripFileHeader)) {
+        return false;
+    }
+    StripFileHeader header{};
+    std::memcpy(&header, mapped->data(), sizeof(header));
+    const size_t expectedSize = sizeof(StripFileHeader) + static_cast<size_t>(header.count) * header.height * header.stride;
+    if (std::memcmp(header.magic, STRIP_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != STRIP_FILE_VERSION ||
+        header.fingerprint != m_fingerprint ||
+        static_cast<int>(header.count) != m_config.count ||
+        static_cast<int>(header.height) != m_config.thumbnailHeight ||
+        header.stride < header.width * 4 ||
+        mapped->size() != expectedSize) {
+        NEAPU_LOGW("Ignoring invalid thumbnail cache for {}", m_config.url);
+        return false;
+    }
+    m_count = static_cast<int>(header.count);
+    m_width = static_cast<int>(header.width);
+    m_height = static_cast<int>(header.height);
+    m_stride = static_cast<int>(header.stride);
+    m_startUs = header.startUs;
+    m_intervalUs = header.intervalUs;
+    m_data = mapped->data() + sizeof(StripFileHeader);
+    m_mapped = std::move(mapped);
+    m_complete = true;
+    m_layoutReady.store(true, std::memory_order_release);
+    return true;
+}
+void ThumbnailStrip::saveCache() const
+{
+    if (m_config.cacheDir.empty() || m_fingerprint == 0) {
+        return;
+    }
+    std::error_code ec;
+    fs::create_directories(m_config.cacheDir, ec);
+    const std::string path = cachePath(m_fingerprint);
+    const std::string tmpPath = path + ".tmp";
+    {
+        StripFileHeader header{};
+        std::memcpy(header.magic, STRIP_FILE_MAGIC, sizeof(header.magic));
+        header.version = STRIP_FILE_VERSION;
+        header.count = static_cast<uint32_t>(m_count);
+        header.width = static_cast<uint32_t>(m_width);
+        header.height = static_cast<uint32_t>(m_height);
+        header.stride = static_cast<uint32_t>(m_stride);
+        header.fingerprint = m_fingerprint;
+        header.startUs = m_startUs;
+        header.intervalUs = m_intervalUs;
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(m_pixels.data()), static_cast<std::streamsize>(m_pixels.size()));
+        if (!file) {
+            NEAPU_LOGW("Failed to write thumbnail cache {}", tmpPath);
+            fs::remove(tmpPath, ec);
+            return;
+        }
+    }
+    // 先写临时文件再改名，其他进程不会映射到写了一半的文件
+    fs::rename(tmpPath, path, ec);
+    if (ec) {
+        NEAPU_LOGW("Failed to save thumbnail cache {}: {}", path, ec.message());
+        fs::remove(tmpPath, ec);
+    }
+}
+} // namespace media
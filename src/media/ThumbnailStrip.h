@@ -0,0 +1,81 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace media {
+class FrameReader;
+class MappedFile;
+
+// 整条时间轴的缩略图条。按固定间隔每段取一个关键帧，分段交给多个工作线程并行解码，
+// 每个线程使用独立的解复用器。结果是一张紧密排列的RGBA精灵图，
+// 按文件内容指纹写入缓存目录，再次打开同一文件时直接内存映射，无需解码
+class ThumbnailStrip {
+public:
+    struct Config {
+        std::string url;
+        std::string cacheDir; // 空表示不落盘
+        int count{120};
+        int thumbnailHeight{54}; // 宽度按比例计算
+        int workerCount{0}; // 0 表示核心数的一半，给主播放留出余量
+    };
+    // 在生成线程回调，index 为刚完成的缩略图，-1 表示全部可用（如从缓存加载）
+    using ProgressCallback = std::function<void(int index)>;
+
+    ThumbnailStrip(const Config& config, ProgressCallback callback);
+    ~ThumbnailStrip();
+    ThumbnailStrip(const ThumbnailStrip&) = delete;
+    ThumbnailStrip& operator=(const ThumbnailStrip&) = delete;
+
+    // 以下尺寸在 isLayoutReady() 之后有效
+    bool isLayoutReady() const { return m_layoutReady.load(std::memory_order_acquire); }
+    int count() const { return m_count; }
+    int thumbnailWidth() const { return m_width; }
+    int thumbnailHeight() const { return m_height; }
+    int stride() const { return m_stride; }
+    // RGBA数据，尚未生成时返回空
+    const uint8_t* thumbnail(int index) const;
+    // 全部缩略图都已可用；生成时有缩略图失败则一直为 false，也不写入缓存
+    bool isComplete() const { return m_complete.load(); }
+
+private:
+    void generatorThreadFunc();
+    bool loadCache();
+    void saveCache() const;
+    void workerFunc(std::unique_ptr<FrameReader> reader, int begin, int end);
+    uint64_t fingerprint() const;
+    std::string cachePath(uint64_t fingerprint) const;
+
+private:
+    Config m_config;
+    ProgressCallback m_callback;
+    uint64_t m_fingerprint{0};
+
+    int m_count{0};
+    int m_width{0};
+    int m_height{0};
+    int m_stride{0};
+    int64_t m_startUs{0};
+    int64_t m_intervalUs{0};
+    std::atomic_bool m_layoutReady{false};
+    std::atomic_bool m_complete{false};
+
+    // 生成中的精灵图和每张缩略图的完成标记；从缓存加载时直接指向映射内存
+    std::vector<uint8_t> m_pixels;
+    std::unique_ptr<std::atomic_bool[]> m_ready;
+    std::unique_ptr<MappedFile> m_mapped;
+    const uint8_t* m_data{nullptr};
+
+    std::atomic_bool m_running{true};
+    std::thread m_generatorThread;
+};
+
+} // namespace media
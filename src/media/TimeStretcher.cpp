@@ -0,0 +1,145 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#include "TimeStretcher.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include "AudioKernels.h"
+
+namespace media {
+// 段长、重叠和搜索窗口取语音和音乐都适用的折中值。
+// 48kHz立体声每输出一秒约31步，每步搜索720个位置，每个位置768个采样的点积
+constexpr int SEQUENCE_MS = 40;
+constexpr int OVERLAP_MS = 8;
+constexpr int SEEK_WINDOW_MS = 15;
+
+TimeStretcher::TimeStretcher(int sampleRate, int channels)
+    : m_sampleRate(sampleRate)
+    , m_channels(channels)
+    , m_sequence(sampleRate * SEQUENCE_MS / 1000)
+    , m_overlap(sampleRate * OVERLAP_MS / 1000)
+    , m_seekWindow(sampleRate * SEEK_WINDOW_MS / 1000)
+{
+    if (sampleRate <= 0 || channels <= 0 || m_overlap <= 0 || m_sequence <= 2 * m_overlap) {
+        throw std::runtime_error("Invalid time stretcher parameters");
+    }
+}
+void TimeStretcher::push(const float* data, int frames, int64_t ptsUs)
+{
+    if (frames <= 0) {
+        return;
+    }
+    // 每次送入都按该帧的时间重新对齐，不累积误差
+    m_basePtsUs = ptsUs - inputEnd() * 1'000'000 / m_sampleRate;
+    m_input.insert(m_input.end(), data, data + static_cast<size_t>(frames) * m_channels);
+}
+int TimeStretcher::process(std::vector<float>& out, int64_t& firstPtsUs)
+{
+    const size_t startSize = out.size();
+    const size_t overlapSamples = static_cast<size_t>(m_overlap) * m_channels;
+    const size_t stepSamples = static_cast<size_t>(m_sequence - m_overlap) * m_channels;
+    for (;;) {
+        m_position = std::max(m_position, static_cast<double>(m_inputStart));
+        const auto position = static_cast<int64_t>(m_position);
+        if (position + m_seekWindow + m_sequence > inputEnd()) {
+            break;
+        }
+        int64_t start = position;
+        if (!m_tail.empty()) {
+            start += bestOffset(inputAt(position));
+        }
+        if (out.size() == startSize) {
+            firstPtsUs = ptsAt(start);
+        }
+        const float* segment = inputAt(start);
+        const size_t base = out.size();
+        out.resize(base + stepSamples);
+        float* dst = out.data() + base;
+        if (m_tail.empty()) {
+            std::copy_n(segment, overlapSamples, dst);
+        } else {
+            for (int i = 0; i < m_overlap; i++) {
+                const float fadeIn = static_cast<float>(i) / static_cast<float>(m_overlap);
+                for (int c = 0; c < m_channels; c++) {
+                    const size_t index = static_cast<size_t>(i) * m_channels + c;
+                    dst[index] = m_tail[index] + (segment[index] - m_tail[index]) * fadeIn;
+                }
+            }
+        }
+        std::copy(segment + overlapSamples, segment + stepSamples, dst + overlapSamples);
+        m_tail.assign(segment + stepSamples, segment + stepSamples + overlapSamples);
+        m_tailPosition = start + m_sequence - m_overlap;
+        m_position += m_rate * (m_sequence - m_overlap);
+    }
+    discardBefore(static_cast<int64_t>(m_position));
+    return static_cast<int>((out.size() - startSize) / m_channels);
+}
+int TimeStretcher::drain(std::vector<float>& out, int64_t& firstPtsUs)
+{
+    const size_t startSize = out.size();
+    int64_t from = std::max(static_cast<int64_t>(m_position), m_inputStart);
+    if (!m_tail.empty()) {
+        // 从上一段尾部接着输出，保证与已输出的数据连续
+        firstPtsUs = ptsAt(m_tailPosition);
+        out.insert(out.end(), m_tail.begin(), m_tail.end());
+        from = std::max(m_tailPosition + m_overlap, m_inputStart);
+    } else {
+        firstPtsUs = ptsAt(from);
+    }
+    from = std::min(from, inputEnd());
+    out.insert(out.end(), inputAt(from), inputAt(inputEnd()));
+    reset();
+    return static_cast<int>((out.size() - startSize) / m_channels);
+}
+void TimeStretcher::reset()
+{
+    m_input.clear();
+    m_inputStart = 0;
+    m_position = 0.0;
+    m_tail.clear();
+    m_tailPosition = 0;
+}
+int64_t TimeStretcher::inputEnd() const
+{
+    return m_inputStart + static_cast<int64_t>(m_input.size() / m_channels);
+}
+const float* TimeStretcher::inputAt(int64_t position) const
+{
+    return m_input.data() + static_cast<size_t>(position - m_inputStart) * m_channels;
+}
+int64_t TimeStretcher::ptsAt(int64_t position) const
+{
+    return m_basePtsUs + position * 1'000'000 / m_sampleRate;
+}
+int TimeStretcher::bestOffset(const float* candidates) const
+{
+    // 归一化互相关，候选段能量越大点积越大，需要除掉
+    const auto& kernels = audioKernels();
+    const int count = m_overlap * m_channels;
+    int best = 0;
+    float bestScore = -std::numeric_limits<float>::infinity();
+    for (int offset = 0; offset < m_seekWindow; offset++) {
+        float energy = 0.0f;
+        const float dot = kernels.correlate(m_tail.data(), candidates + static_cast<size_t>(offset) * m_channels,
+            count, &energy);
+        const float score = dot / std::sqrt(energy + 1e-9f);
+        if (score > bestScore) {
+            bestScore = score;
+            best = offset;
+        }
+    }
+    return best;
+}
+void TimeStretcher::discardBefore(int64_t position)
+{
+    const int64_t frames = std::min(position, inputEnd()) - m_inputStart;
+    if (frames <= 0) {
+        return;
+    }
+    m_input.erase(m_input.begin(), m_input.begin() + static_cast<ptrdiff_t>(frames * m_channels));
+    m_inputStart += frames;
+}
+} // namespace media
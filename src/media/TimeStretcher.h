@@ -0,0 +1,56 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace media {
+
+// WSOLA 时间拉伸：按速率改变交错float采样的时长而不改变音高。
+// 每步在下一段的理想起点之后的搜索窗口内找与上一段尾部最相似的位置，交叉淡化后拼接。
+// 每输出一秒的计算量只由搜索窗口和重叠长度决定，与速率无关
+class TimeStretcher {
+public:
+    TimeStretcher(int sampleRate, int channels);
+
+    int sampleRate() const { return m_sampleRate; }
+    int channels() const { return m_channels; }
+    void setRate(double rate) { m_rate = rate; }
+
+    // 送入交错采样，ptsUs 为第一个采样的媒体时间
+    void push(const float* data, int frames, int64_t ptsUs);
+    // 按当前速率处理已送入的采样，输出追加到 out，返回输出帧数。
+    // firstPtsUs 为第一个输出采样对应的媒体时间，之后每个输出采样对应 rate 个输入采样
+    int process(std::vector<float>& out, int64_t& firstPtsUs);
+    // 不再拉伸，原样取出剩余的采样（上一段尾部和之后的输入）并清空，用于结束和回到原速
+    int drain(std::vector<float>& out, int64_t& firstPtsUs);
+    // 丢弃全部缓存，seek后调用
+    void reset();
+    bool empty() const { return m_input.empty() && m_tail.empty(); }
+
+private:
+    int64_t inputEnd() const;
+    const float* inputAt(int64_t position) const;
+    int64_t ptsAt(int64_t position) const;
+    int bestOffset(const float* candidates) const;
+    void discardBefore(int64_t position);
+
+private:
+    int m_sampleRate;
+    int m_channels;
+    int m_sequence; // 每步取用的输入段长度（帧）
+    int m_overlap; // 相邻两段交叉淡化的长度
+    int m_seekWindow; // 搜索窗口长度
+    double m_rate{1.0};
+
+    std::vector<float> m_input; // 第一个采样的绝对序号为 m_inputStart
+    int64_t m_inputStart{0};
+    double m_position{0.0}; // 下一段的理想起点（绝对序号）
+    std::vector<float> m_tail; // 上一段末尾的重叠部分，与下一段开头交叉淡化
+    int64_t m_tailPosition{0};
+    int64_t m_basePtsUs{0}; // 绝对序号0对应的媒体时间
+};
+
+} // namespace media
@@ -3,7 +3,12 @@
 //
 
 #include "VideoDecoder.h"
+#include <algorithm>
+#include <cmath>
 #include <logger.h>
+#include "DecoderPool.h"
+#include "Metrics.h"
+#include "PixelConverter.h"
 extern "C" {
 #include <libavformat/avformat.h>
 #include <libavcodec/avcodec.h>
@@ -20,6 +25,19 @@ extern "C"{
 #endif
 
 namespace media {
+// 自适应降级参数：持续滞后才升级，余量恢复后需要更长时间才降级，形成迟滞避免来回抖动
+constexpr int64_t DEGRADE_ESCALATE_LATENESS_US = 40'000;
+constexpr int64_t DEGRADE_RECOVER_LATENESS_US = -100'000;
+constexpr int DEGRADE_ESCALATE_FRAMES = 15;
+constexpr int DEGRADE_RECOVER_FRAMES = 150;
+constexpr int64_t DEGRADE_MAX_LATENESS_US = 5'000'000; // 超过视为时钟跳变（如seek），不计入统计
+// 连续丢弃过期帧的上限，保证严重落后时画面仍会更新
+constexpr int MAX_CONSECUTIVE_LATE_DROPS = 8;
+// 显示比例低于该值（画面超过渲染尺寸25%以上）才缩小
+constexpr double DOWNSCALE_THRESHOLD = 0.8;
+// 缩小后的高度按16对齐，窗口拖动时不必每个像素都重建sws上下文
+constexpr int DOWNSCALE_ALIGN = 16;
+
 static AVHWDeviceType hwAccelTypeFromEnum(VideoDecoder::HWAccelMethod method)
 {
     using enum VideoDecoder::HWAccelMethod;
@@ -33,33 +51,57 @@ static AVHWDeviceType hwAccelTypeFromEnum(VideoDecoder::HWAccelMethod method)
 }
 static AVPixelFormat pixelFormatFromEnum(Frame::PixelFormat format)
 {
-    using enum Frame::PixelFormat;
-    switch (format) {
-    case YUV420P: return AV_PIX_FMT_YUV420P;
-    case NV12: return AV_PIX_FMT_NV12;
-    case P010: return AV_PIX_FMT_P010LE;
-    default: return AV_PIX_FMT_NONE;
-    }
+    return static_cast<AVPixelFormat>(Frame::toAVPixelFormat(format));
 }
 
 VideoDecoder::VideoDecoder(const CreateParam& param)
-    : DecoderBase(param.stream, param.packetCallback, CodecType::Video)
+    : DecoderBase(param.stream, param.packetCallback, CodecType::Video, param.threadConfig)
     , m_hwaccelMethod(param.hwaccelMethod)
 #ifdef _WIN32
     , m_d3d11Device(param.d3d11Device)
 #endif
+    , m_extraHwFrames(param.extraHwFrames)
     , m_targetPixelFormat(param.targetPixelFormat)
+    , m_passthroughPixelFormats(param.passthroughPixelFormats)
+    , m_clockCallback(param.clockCallback)
+    , m_displaySizeAware(param.displaySizeAware)
 {
     NEAPU_FUNC_TRACE;
     if (!m_stream) {
         NEAPU_LOGE("Stream is null");
         throw std::runtime_error("Stream is null");
     }
+    setRenderSize(param.renderWidth, param.renderHeight);
+
+    PoolKeyBuilder keyBuilder;
+    keyBuilder.addCodecParameters(m_stream->codecpar)
+        .add(m_hwaccelMethod)
+        .add(m_extraHwFrames)
+        .add(m_targetPixelFormat)
+        .add(m_threadConfig.type)
+        .add(m_threadConfig.threadCount)
+        .add(m_threadConfig.lowLatency);
+#ifdef _WIN32
+    keyBuilder.add(m_d3d11Device);
+#endif
+    m_poolKey = keyBuilder.value();
+    if (adoptWarmContext()) {
+        return;
+    }
 
     initializeContext();
 
     initializeHWContext();
 
+    if (!m_hwDeviceCtx) {
+        m_lowres = desiredLowres();
+        m_codecCtx->lowres = m_lowres.load();
+        if (m_lowres > 0) {
+            NEAPU_LOGI("Video decoder uses lowres {} for render size {}x{}", m_lowres.load(), param.renderWidth, param.renderHeight);
+            m_poolKey = 0; // lowres上下文不放入预热池
+        }
+    }
+
     int ret = avcodec_open2(m_codecCtx, m_codec, nullptr);
     if (ret < 0) {
         std::string errStr = getFFmpegErrorString(ret);
@@ -148,6 +190,9 @@ void VideoDecoder::initializeHWContext()
 #endif
 
     m_codecCtx->hw_device_ctx = av_buffer_ref(m_hwDeviceCtx);
+    // 硬解不需要软件多线程，帧级多线程只会增加延迟和占用的硬件表面
+    m_codecCtx->thread_count = 1;
+    m_codecCtx->extra_hw_frames = m_extraHwFrames;
     m_codecCtx->opaque = this;
     m_codecCtx->get_format = [](AVCodecContext* ctx, const AVPixelFormat* pix_fmts) -> AVPixelFormat {
         const auto* decoder = static_cast<VideoDecoder*>(ctx->opaque);
@@ -161,53 +206,86 @@ void VideoDecoder::initializeHWContext()
         return AV_PIX_FMT_NONE;
     };
 }
+void VideoDecoder::adoptFrom(DecoderBase& warm)
+{
+    DecoderBase::adoptFrom(warm);
+    // key包含解码类型，池中取出的必然是视频解码器
+    auto& other = static_cast<VideoDecoder&>(warm);
+    std::swap(m_hwDeviceCtx, other.m_hwDeviceCtx);
+    std::swap(m_hwPixelFormat, other.m_hwPixelFormat);
+    std::swap(m_swsCtx, other.m_swsCtx);
+#ifdef __linux__
+    std::swap(m_vaDisplay, other.m_vaDisplay);
+#endif
+    if (m_hwDeviceCtx) {
+        m_codecCtx->opaque = this; // get_format 通过 opaque 找到解码器
+    }
+    // 上一次播放可能处于降级状态
+    m_codecCtx->skip_loop_filter = AVDISCARD_DEFAULT;
+    m_codecCtx->skip_idct = AVDISCARD_DEFAULT;
+    m_codecCtx->skip_frame = AVDISCARD_DEFAULT;
+}
 FramePtr VideoDecoder::convertFixelFormat(FramePtr&& avFrame)
 {
+    // 渲染端可直接使用的格式只缩小，不转换格式
+    const auto targetPixFmt = isPassthroughFormat(avFrame->pixelFormat())
+        ? static_cast<AVPixelFormat>(avFrame->avFrame()->format)
+        : pixelFormatFromEnum(m_targetPixelFormat);
+    int dstWidth = avFrame->width();
+    int dstHeight = avFrame->height();
+    const bool downscale = downscaledSize(avFrame->width(), avFrame->height(), dstWidth, dstHeight);
+    if (!downscale && canFastConvert(avFrame->avFrame()->format, targetPixFmt)) {
+        return fastConvert(std::move(avFrame), targetPixFmt);
+    }
+
     if (m_swsCtx &&
         (m_swsCtx->src_format != avFrame->avFrame()->format ||
          m_swsCtx->src_w != avFrame->width() ||
-         m_swsCtx->src_h != avFrame->height())) {
+         m_swsCtx->src_h != avFrame->height() ||
+         m_swsCtx->dst_format != targetPixFmt ||
+         m_swsCtx->dst_w != dstWidth ||
+         m_swsCtx->dst_h != dstHeight)) {
         sws_freeContext(m_swsCtx);
         m_swsCtx = nullptr;
     }
 
-    auto targetPixFmt = pixelFormatFromEnum(m_targetPixelFormat);
     if (!m_swsCtx) {
-        m_swsCtx = sws_getContext(
-            avFrame->width(),
-            avFrame->height(),
-            static_cast<AVPixelFormat>(avFrame->avFrame()->format),
-            avFrame->width(),
-            avFrame->height(),
-            targetPixFmt,
-            SWS_BILINEAR,
-            nullptr,
-            nullptr,
-            nullptr);
+        m_swsCtx = sws_alloc_context();
         if (!m_swsCtx) {
-            NEAPU_LOGE("Failed to create SwsContext for pixel format conversion");
+            NEAPU_LOGE("Failed to allocate SwsContext for pixel format conversion");
+            return nullptr;
+        }
+        m_swsCtx->src_w = avFrame->width();
+        m_swsCtx->src_h = avFrame->height();
+        m_swsCtx->src_format = static_cast<AVPixelFormat>(avFrame->avFrame()->format);
+        m_swsCtx->dst_w = dstWidth;
+        m_swsCtx->dst_h = dstHeight;
+        m_swsCtx->dst_format = targetPixFmt;
+        m_swsCtx->flags = SWS_BILINEAR;
+        // 按水平条带切分到sws内部线程池，各条带输出行互不依赖，结果与单线程逐位一致
+        m_swsCtx->threads = swsThreadCount(avFrame->width(), avFrame->height());
+        int ret = sws_init_context(m_swsCtx, nullptr, nullptr);
+        if (ret < 0) {
+            NEAPU_LOGE("Failed to initialize SwsContext for pixel format conversion: {}", getFFmpegErrorString(ret));
+            sws_freeContext(m_swsCtx);
+            m_swsCtx = nullptr;
             return nullptr;
         }
+        NEAPU_LOGI("Created SwsContext {}x{} -> {}x{} with {} threads",
+            avFrame->width(), avFrame->height(), dstWidth, dstHeight, m_swsCtx->threads);
     }
 
     auto retFrame = std::make_unique<Frame>(Frame::FrameType::Normal, avFrame->serial());
     retFrame->avFrame()->format = targetPixFmt;
-    retFrame->avFrame()->width = avFrame->width();
-    retFrame->avFrame()->height = avFrame->height();
+    retFrame->avFrame()->width = dstWidth;
+    retFrame->avFrame()->height = dstHeight;
     int ret = av_frame_get_buffer(retFrame->avFrame(), 32);
     if (ret < 0) {
         std::string errStr = getFFmpegErrorString(ret);
         NEAPU_LOGE("Failed to allocate buffer for converted frame: {}", errStr);
         return nullptr;
     }
-    ret = sws_scale(
-        m_swsCtx,
-        avFrame->avFrame()->data,
-        avFrame->avFrame()->linesize,
-        0,
-        avFrame->avFrame()->height,
-        retFrame->avFrame()->data,
-        retFrame->avFrame()->linesize);
+    ret = sws_scale_frame(m_swsCtx, retFrame->avFrame(), avFrame->avFrame());
     if (ret < 0) {
         std::string errStr = getFFmpegErrorString(ret);
         NEAPU_LOGE("Failed to scale frame for pixel format conversion: {}", errStr);
@@ -215,6 +293,15 @@ FramePtr VideoDecoder::convertFixelFormat(FramePtr&& avFrame)
     }
 
     retFrame->copyMetaDataFrom(*avFrame);
+    if (downscale) {
+        // 按像素数折算全尺寸输出的字节数，统计省下的上传和内存带宽
+        const size_t outputBytes = retFrame->dataSize();
+        const auto fullBytes = static_cast<int64_t>(static_cast<double>(outputBytes) *
+            avFrame->width() * avFrame->height() / (static_cast<double>(dstWidth) * dstHeight));
+        auto& metrics = Metrics::instance();
+        metrics.add("video.downscale.frames");
+        metrics.add("video.downscale.saved_bytes", fullBytes - static_cast<int64_t>(outputBytes));
+    }
     return retFrame;
 }
 FramePtr VideoDecoder::hwFrameTransfer(FramePtr&& avFrame)
@@ -230,9 +317,53 @@ FramePtr VideoDecoder::hwFrameTransfer(FramePtr&& avFrame)
     swFrame->copyMetaDataFrom(*avFrame);
     return swFrame;
 }
+bool VideoDecoder::shouldDropFrame(const Frame& frame)
+{
+    if (m_seekTargetUs >= 0) {
+        // 精确seek：目标时间落在该帧显示区间之前才算到达
+        if (frame.ptsUs() + frameDurationUs(frame) <= m_seekTargetUs) {
+            Metrics::instance().add("video.drop.seek");
+            return true;
+        }
+        m_seekTargetUs = -1;
+    }
+    if (!m_clockCallback) {
+        return false;
+    }
+    // 每帧只读一次时钟，降级判断和迟到丢帧基于同一个时间
+    const auto clockUs = m_clockCallback();
+    if (!clockUs) {
+        return false;
+    }
+    updateDegradation(frame, *clockUs);
+
+    // 该帧的显示区间已经结束，下载和转换都是浪费
+    const int64_t deadlineUs = frame.ptsUs() + frameDurationUs(frame);
+    if (*clockUs < deadlineUs || m_consecutiveLateDrops >= MAX_CONSECUTIVE_LATE_DROPS) {
+        m_consecutiveLateDrops = 0;
+        return false;
+    }
+    m_consecutiveLateDrops++;
+    Metrics::instance().add("video.drop.late");
+    NEAPU_LOGD("Dropping late video frame PTS {} before post processing, clock {}", frame.ptsUs(), *clockUs);
+    return true;
+}
+FramePtr VideoDecoder::preFilter(FramePtr&& frame)
+{
+    // 通用滤镜只处理内存中的帧，启用滤镜后硬解不再零拷贝，下载的开销与滤镜一起在流水中消化
+    if (frame->avFrame()->hw_frames_ctx) {
+        return hwFrameTransfer(std::move(frame));
+    }
+    return std::move(frame);
+}
 FramePtr VideoDecoder::postProcess(FramePtr&& avFrame)
 {
-    if (avFrame->pixelFormat() == m_targetPixelFormat) {
+    int dstWidth = 0;
+    int dstHeight = 0;
+    // 硬件表面零拷贝直接交给渲染端，由GPU缩放；软件帧明显大于显示尺寸时在转换中缩小
+    const bool downscale = !avFrame->avFrame()->hw_frames_ctx &&
+        downscaledSize(avFrame->width(), avFrame->height(), dstWidth, dstHeight);
+    if (!downscale && (avFrame->pixelFormat() == m_targetPixelFormat || isPassthroughFormat(avFrame->pixelFormat()))) {
         return avFrame;
     }
 
@@ -247,7 +378,8 @@ FramePtr VideoDecoder::postProcess(FramePtr&& avFrame)
     }
 
     FramePtr convertedFrame;
-    if (swFrame->pixelFormat() != m_targetPixelFormat) {
+    if ((swFrame->pixelFormat() != m_targetPixelFormat && !isPassthroughFormat(swFrame->pixelFormat())) ||
+        downscaledSize(swFrame->width(), swFrame->height(), dstWidth, dstHeight)) {
         convertedFrame = convertFixelFormat(std::move(swFrame));
         if (!convertedFrame) {
             return nullptr;
@@ -258,4 +390,206 @@ FramePtr VideoDecoder::postProcess(FramePtr&& avFrame)
 
     return convertedFrame;
 }
+bool VideoDecoder::isPassthroughFormat(Frame::PixelFormat format) const
+{
+    if (format == Frame::PixelFormat::None) {
+        return false;
+    }
+    return std::ranges::find(m_passthroughPixelFormats, format) != m_passthroughPixelFormats.end();
+}
+void VideoDecoder::onFlush()
+{
+    // seek后队列重新积累，之前的滞后统计不再有效，保留当前级别
+    m_latenessValid = false;
+    m_avgLatenessUs = 0;
+    m_lateFrames = 0;
+    m_headroomFrames = 0;
+    m_consecutiveLateDrops = 0;
+
+    if (m_keyframeOnly != m_pendingKeyframeOnly.load()) {
+        m_keyframeOnly = m_pendingKeyframeOnly.load();
+        NEAPU_LOGI("Video decoder keyframe only: {}", m_keyframeOnly);
+        applySkipFrame();
+    }
+    if (const int lowres = desiredLowres(); lowres != m_lowres.load()) {
+        reopenWithLowres(lowres);
+    }
+}
+void VideoDecoder::setRenderSize(int width, int height)
+{
+    if (width <= 0 || height <= 0) {
+        m_renderSize = 0;
+        return;
+    }
+    m_renderSize = static_cast<uint64_t>(width) << 32 | static_cast<uint32_t>(height);
+}
+bool VideoDecoder::isLowresPending() const
+{
+    return desiredLowres() != m_lowres.load();
+}
+int VideoDecoder::desiredLowres() const
+{
+    // lowres只有部分软件解码器支持（如MJPEG），在解码器内部直接少算像素
+    if (!m_displaySizeAware || m_hwDeviceCtx || !m_codec || m_codec->max_lowres <= 0) {
+        return 0;
+    }
+    const uint64_t renderSize = m_renderSize.load();
+    const int renderWidth = static_cast<int>(renderSize >> 32);
+    const int renderHeight = static_cast<int>(renderSize & 0xffffffff);
+    const int width = m_stream->codecpar->width;
+    const int height = m_stream->codecpar->height;
+    if (renderWidth <= 0 || renderHeight <= 0 || width <= 0 || height <= 0) {
+        return 0;
+    }
+    // 每级减半，保证减半后仍不小于实际显示尺寸
+    const double scale = std::min(static_cast<double>(renderWidth) / width, static_cast<double>(renderHeight) / height);
+    int lowres = 0;
+    while (lowres < m_codec->max_lowres && 1.0 / (1 << (lowres + 1)) >= scale) {
+        lowres++;
+    }
+    return lowres;
+}
+void VideoDecoder::reopenWithLowres(int lowres)
+{
+    // lowres只能在打开解码器前设置，Flush时解码器内没有参考帧，重新打开是安全的
+    AVCodecContext* oldCtx = m_codecCtx;
+    m_codecCtx = nullptr;
+    try {
+        initializeContext();
+    } catch (const std::exception& e) {
+        NEAPU_LOGE("Failed to reopen video decoder with lowres {}: {}", lowres, e.what());
+        m_codecCtx = oldCtx;
+        return;
+    }
+    m_codecCtx->lowres = lowres;
+    int ret = avcodec_open2(m_codecCtx, m_codec, nullptr);
+    if (ret < 0) {
+        NEAPU_LOGE("Failed to reopen video decoder with lowres {}: {}", lowres, getFFmpegErrorString(ret));
+        avcodec_free_context(&m_codecCtx);
+        m_codecCtx = oldCtx;
+        return;
+    }
+    avcodec_free_context(&oldCtx);
+    // 恢复当前的降级设置
+    applyDegradeSettings();
+    NEAPU_LOGI("Video decoder lowres {} -> {}", m_lowres.load(), lowres);
+    m_lowres = lowres;
+    m_poolKey = 0;
+    Metrics::instance().set("video.lowres.level", lowres);
+}
+bool VideoDecoder::downscaledSize(int width, int height, int& dstWidth, int& dstHeight) const
+{
+    if (!m_displaySizeAware || width <= 0 || height <= 0) {
+        return false;
+    }
+    const uint64_t renderSize = m_renderSize.load();
+    const int renderWidth = static_cast<int>(renderSize >> 32);
+    const int renderHeight = static_cast<int>(renderSize & 0xffffffff);
+    if (renderWidth <= 0 || renderHeight <= 0) {
+        return false;
+    }
+    // 渲染端等比缩放显示，按实际显示比例计算
+    const double scale = std::min(static_cast<double>(renderWidth) / width, static_cast<double>(renderHeight) / height);
+    if (scale >= DOWNSCALE_THRESHOLD) {
+        return false;
+    }
+    int alignedHeight = (static_cast<int>(std::ceil(height * scale)) + DOWNSCALE_ALIGN - 1) / DOWNSCALE_ALIGN * DOWNSCALE_ALIGN;
+    alignedHeight = std::min(alignedHeight, height) & ~1;
+    if (alignedHeight >= height || alignedHeight < 2) {
+        return false;
+    }
+    dstHeight = alignedHeight;
+    // 宽度按高度等比计算，保持宽高比
+    dstWidth = std::max(2, static_cast<int>(static_cast<int64_t>(width) * dstHeight / height) & ~1);
+    return true;
+}
+int64_t VideoDecoder::frameDurationUs(const Frame& frame) const
+{
+    if (frame.durationUs() > 0) {
+        return frame.durationUs();
+    }
+    const AVRational fr = m_stream->avg_frame_rate;
+    if (fr.num > 0 && fr.den > 0) {
+        return av_rescale(1'000'000, fr.den, fr.num);
+    }
+    return 40'000;
+}
+void VideoDecoder::updateDegradation(const Frame& frame, int64_t clockUs)
+{
+    // 硬解不受这些跳过选项影响
+    if (m_hwDeviceCtx) {
+        return;
+    }
+
+    // 解码输出时相对时钟的滞后，正常情况下因为帧队列缓冲为负值
+    const int64_t latenessUs = clockUs - frame.ptsUs();
+    if (latenessUs > DEGRADE_MAX_LATENESS_US || latenessUs < -DEGRADE_MAX_LATENESS_US) {
+        return;
+    }
+    if (!m_latenessValid) {
+        m_avgLatenessUs = latenessUs;
+        m_latenessValid = true;
+    } else {
+        m_avgLatenessUs += (latenessUs - m_avgLatenessUs) / 8;
+    }
+
+    if (m_avgLatenessUs > DEGRADE_ESCALATE_LATENESS_US) {
+        m_lateFrames++;
+        m_headroomFrames = 0;
+    } else if (m_avgLatenessUs < DEGRADE_RECOVER_LATENESS_US) {
+        m_headroomFrames++;
+        m_lateFrames = 0;
+    } else {
+        m_lateFrames = 0;
+        m_headroomFrames = 0;
+    }
+
+    using enum DegradeLevel;
+    if (m_lateFrames >= DEGRADE_ESCALATE_FRAMES && m_degradeLevel != SkipAllLoopFilter) {
+        applyDegradeLevel(static_cast<DegradeLevel>(static_cast<int>(m_degradeLevel) + 1));
+        Metrics::instance().add("video.degrade.escalate");
+    } else if (m_headroomFrames >= DEGRADE_RECOVER_FRAMES && m_degradeLevel != None) {
+        applyDegradeLevel(static_cast<DegradeLevel>(static_cast<int>(m_degradeLevel) - 1));
+        Metrics::instance().add("video.degrade.recover");
+    }
+}
+void VideoDecoder::applyDegradeLevel(DegradeLevel level)
+{
+    using enum DegradeLevel;
+    NEAPU_LOGW("Video decode degrade level {} -> {}, average lateness {} us",
+        static_cast<int>(m_degradeLevel),
+        static_cast<int>(level),
+        m_avgLatenessUs);
+    m_degradeLevel = level;
+    m_lateFrames = 0;
+    m_headroomFrames = 0;
+
+    applyDegradeSettings();
+
+    auto& metrics = Metrics::instance();
+    metrics.set("video.degrade.level", static_cast<int64_t>(level));
+    metrics.add("video.degrade.enter_level_" + std::to_string(static_cast<int>(level)));
+}
+void VideoDecoder::applyDegradeSettings()
+{
+    using enum DegradeLevel;
+    // 先只跳过非参考帧的环路滤波，参考帧的滤波误差会被后续帧引用，放到最后一级
+    if (m_degradeLevel >= SkipAllLoopFilter) {
+        m_codecCtx->skip_loop_filter = AVDISCARD_ALL;
+    } else if (m_degradeLevel >= SkipLoopFilter) {
+        m_codecCtx->skip_loop_filter = AVDISCARD_NONREF;
+    } else {
+        m_codecCtx->skip_loop_filter = AVDISCARD_DEFAULT;
+    }
+    m_codecCtx->skip_idct = m_degradeLevel >= SkipIdct ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+    applySkipFrame();
+}
+void VideoDecoder::applySkipFrame()
+{
+    if (m_keyframeOnly) {
+        m_codecCtx->skip_frame = AVDISCARD_NONKEY;
+    } else {
+        m_codecCtx->skip_frame = m_degradeLevel >= DegradeLevel::SkipNonRefFrame ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+    }
+}
 } // namespace media
\ No newline at end of file
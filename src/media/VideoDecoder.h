@@ -4,6 +4,8 @@
 
 #pragma once
 #include "DecoderBase.h"
+#include <optional>
+#include <vector>
 #ifdef _WIN32
 #include <d3d11.h>
 #endif
@@ -22,11 +24,31 @@ public:
         Vaapi, // Linux
         VideoToolBox, // macOS
     };
+    // 解码跟不上时逐级降低解码质量
+    enum class DegradeLevel {
+        None,
+        SkipLoopFilter, // 跳过非参考帧的环路滤波，误差不会传播
+        SkipIdct, // 额外跳过非参考帧的IDCT
+        SkipNonRefFrame, // 额外丢弃非参考帧
+        SkipAllLoopFilter, // 参考帧也跳过环路滤波，伪影会持续到下一个关键帧
+    };
+    // 返回当前播放时钟（us），时钟未运行时返回空
+    using ClockCallback = std::function<std::optional<int64_t>()>;
     struct CreateParam {
         AVStream* stream{nullptr};
         AVPacketCallback packetCallback;
         HWAccelMethod hwaccelMethod{HWAccelMethod::None};
         Frame::PixelFormat targetPixelFormat{Frame::PixelFormat::YUV420P};
+        // 渲染端可直接使用的软件格式，解码输出这些格式时不做转换
+        std::vector<Frame::PixelFormat> passthroughPixelFormats;
+        DecodeThreadConfig threadConfig;
+        ClockCallback clockCallback;
+        // 额外保留的硬件表面数量，逐帧回退缓存会长期持有已显示的帧
+        int extraHwFrames{0};
+        // 显示尺寸感知解码：画面明显大于渲染尺寸时软解使用lowres，或在sws转换中缩小
+        bool displaySizeAware{false};
+        int renderWidth{0};
+        int renderHeight{0};
 #ifdef _WIN32
         ID3D11Device* d3d11Device{nullptr};
 #endif
@@ -41,15 +63,41 @@ public:
 
     Frame::PixelFormat targetPixelFormat() const { return m_targetPixelFormat; }
 
+    // 快进快退时只解码关键帧，在下一次Flush时生效
+    void setKeyframeOnly(bool keyframeOnly) { m_pendingKeyframeOnly = keyframeOnly; }
+
+    // 渲染区域的像素尺寸，可在任意线程调用。缩放在下一帧生效，lowres级别在下一次Flush时生效
+    void setRenderSize(int width, int height);
+    // lowres级别需要变化，调用方应发起一次seek使其生效
+    bool isLowresPending() const;
+
 #ifdef __linux__
     void* vaDisplay() const { return m_vaDisplay; }
 #endif
 
 protected:
     virtual void initializeHWContext();
+    void adoptFrom(DecoderBase& warm) override;
     virtual FramePtr convertFixelFormat(FramePtr&& avFrame);
     virtual FramePtr hwFrameTransfer(FramePtr&& avFrame);
+    bool shouldDropFrame(const Frame& frame) override;
+    FramePtr preFilter(FramePtr&& frame) override;
     FramePtr postProcess(FramePtr&& frame) override;
+    void onFlush() override;
+
+    int64_t frameDurationUs(const Frame& frame) const;
+    bool isPassthroughFormat(Frame::PixelFormat format) const;
+
+    void updateDegradation(const Frame& frame, int64_t clockUs);
+    void applyDegradeLevel(DegradeLevel level);
+    // 按当前降级级别设置解码上下文的丢弃选项
+    void applyDegradeSettings();
+    void applySkipFrame();
+
+    int desiredLowres() const;
+    void reopenWithLowres(int lowres);
+    // 按渲染尺寸计算输出尺寸，不需要缩小时返回false
+    bool downscaledSize(int width, int height, int& dstWidth, int& dstHeight) const;
 
 protected:
     HWAccelMethod m_hwaccelMethod{HWAccelMethod::None};
@@ -58,9 +106,24 @@ protected:
     ID3D11Device* m_d3d11Device{nullptr};
 #endif
     int m_hwPixelFormat{-1};
+    int m_extraHwFrames{0};
     SwsContext* m_swsCtx{nullptr};
 
     Frame::PixelFormat m_targetPixelFormat{Frame::PixelFormat::YUV420P};
+    std::vector<Frame::PixelFormat> m_passthroughPixelFormats;
+
+    ClockCallback m_clockCallback;
+    DegradeLevel m_degradeLevel{DegradeLevel::None};
+    int64_t m_avgLatenessUs{0};
+    bool m_latenessValid{false};
+    int m_lateFrames{0};
+    int m_headroomFrames{0};
+    int m_consecutiveLateDrops{0};
+    std::atomic_bool m_pendingKeyframeOnly{false};
+    bool m_keyframeOnly{false};
+    bool m_displaySizeAware{false};
+    std::atomic<uint64_t> m_renderSize{0}; // 高32位宽，低32位高
+    std::atomic_int m_lowres{0};
 #ifdef __linux__
     void* m_vaDisplay{ nullptr };
 #endif
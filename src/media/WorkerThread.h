@@ -0,0 +1,27 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace media {
+
+// 停止在条件变量上等待的后台线程：在锁内执行 stop（清除运行标志、使进行中的请求失效）并唤醒，再等待线程退出。
+// 在锁内修改，工作线程检查完等待条件、进入等待之前不会错过通知
+template <typename StopFn>
+void stopWorkerThread(std::mutex& mutex, std::condition_variable& condVar, std::thread& thread, StopFn&& stop)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop();
+        condVar.notify_all();
+    }
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+} // namespace media
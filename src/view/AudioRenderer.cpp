@@ -6,6 +6,7 @@
 #include <miniaudio.h>
 #include <logger.h>
 #include <cmath>
+#include <memory>
 #include "../media/Player.h"
 
 namespace view {
@@ -14,10 +15,45 @@ AudioRenderer::AudioRenderer(QObject* parent)
 {
 
 }
-bool AudioRenderer::start(int sampleRate, int channels, int64_t startTimeUs)
+const AudioRenderer::DeviceFormat& AudioRenderer::probeDevice()
+{
+    using media::Frame;
+    if (m_deviceFormat) {
+        return *m_deviceFormat;
+    }
+    // 无法探测时使用float和流的采样率，由miniaudio在设备端转换
+    m_deviceFormat = DeviceFormat{};
+    // 格式、采样率和声道数都设为0时miniaudio按设备原生设置打开，internal* 即混音器的格式。
+    // nativeDataFormats 列出的是设备支持的所有组合，第一项不一定是混音器使用的
+    ma_device_config config = ma_device_config_init(ma_device_type_playback);
+    config.playback.format = ma_format_unknown;
+    config.playback.channels = 0;
+    config.sampleRate = 0;
+    config.dataCallback = [](ma_device*, void*, const void*, uint32_t) {};
+    // ma_device 较大，和 start() 一样放在堆上
+    auto device = std::make_unique<ma_device>();
+    if (ma_device_init(nullptr, &config, device.get()) != MA_SUCCESS) {
+        NEAPU_LOGW("Failed to open default audio device for probe");
+        return *m_deviceFormat;
+    }
+    const auto& playback = device->playback;
+    // 24/32位整数设备上float保留的精度更多，只有原生为16位时才输出S16
+    if (playback.internalFormat == ma_format_s16) {
+        m_deviceFormat->sampleFormat = Frame::SampleFormat::S16;
+    }
+    m_deviceFormat->sampleRate = static_cast<int>(playback.internalSampleRate);
+    m_deviceFormat->channels = static_cast<int>(playback.internalChannels);
+    ma_device_uninit(device.get());
+    NEAPU_LOGI("Audio device native format: {}, {} Hz, {} channels",
+        m_deviceFormat->sampleFormat == Frame::SampleFormat::Float32 ? "f32" : "s16", m_deviceFormat->sampleRate,
+        m_deviceFormat->channels);
+    return *m_deviceFormat;
+}
+bool AudioRenderer::start(int sampleRate, int channels, media::Frame::SampleFormat format, int64_t startTimeUs)
 {
     NEAPU_FUNC_TRACE;
-    NEAPU_LOGI("Starting audio renderer: sampleRate={}, channels={}", sampleRate, channels);
+    NEAPU_LOGI("Starting audio renderer: sampleRate={}, channels={}, float={}",
+        sampleRate, channels, format == media::Frame::SampleFormat::Float32);
     if (m_device) {
         NEAPU_LOGW("Audio device is already started");
         return false;
@@ -28,7 +64,7 @@ bool AudioRenderer::start(int sampleRate, int channels, int64_t startTimeUs)
     }
     ma_device_config config;
     config = ma_device_config_init(ma_device_type_playback);
-    config.playback.format = ma_format_s16;
+    config.playback.format = format == media::Frame::SampleFormat::Float32 ? ma_format_f32 : ma_format_s16;
     config.playback.channels = static_cast<ma_uint32>(channels);
     config.sampleRate = static_cast<ma_uint32>(sampleRate);
     config.dataCallback = [](ma_device* pDevice, void* pOutput, const void* pInput, uint32_t frameCount) {
@@ -45,6 +81,28 @@ bool AudioRenderer::start(int sampleRate, int channels, int64_t startTimeUs)
         return false;
     }
 
+    const auto& playback = m_device->playback;
+    if (playback.internalSampleRate != static_cast<ma_uint32>(sampleRate)) {
+        NEAPU_LOGW("Audio device runs at {} Hz, {} Hz output will be resampled in the callback",
+            playback.internalSampleRate, sampleRate);
+    }
+    if (m_deviceFormat) {
+        // 与 probeDevice() 相同的判断：只有原生为16位时才是S16
+        const bool formatChanged = (playback.internalFormat == ma_format_s16) !=
+            (m_deviceFormat->sampleFormat == media::Frame::SampleFormat::S16);
+        if (formatChanged || playback.internalSampleRate != static_cast<ma_uint32>(m_deviceFormat->sampleRate) ||
+            playback.internalChannels != static_cast<ma_uint32>(m_deviceFormat->channels)) {
+            NEAPU_LOGI("Default audio device changed to {} Hz, {} channels, probing again on next open",
+                playback.internalSampleRate, playback.internalChannels);
+            m_deviceFormat.reset();
+        }
+    }
+    if (playback.internalSampleRate > 0) {
+        m_latencyUs = static_cast<int64_t>(playback.internalPeriodSizeInFrames) * playback.internalPeriods *
+            1'000'000 / playback.internalSampleRate;
+    }
+    NEAPU_LOGI("Audio device latency {} us", m_latencyUs);
+
     if (ma_device_start(m_device) != MA_SUCCESS) {
         NEAPU_LOGE("Failed to start audio device");
         ma_device_uninit(m_device);
@@ -61,7 +119,7 @@ void AudioRenderer::stop()
 {
     NEAPU_FUNC_TRACE;
     m_running = false;
-    m_currentData.reset();
+    m_playing = false;
     if (m_device) {
         ma_device_stop(m_device);
         ma_device_uninit(m_device);
@@ -72,38 +130,14 @@ void AudioRenderer::stop()
 
 void AudioRenderer::maDataCallback(ma_device* pDevice, void* pOutput, const void* pInput, uint32_t frameCount)
 {
-    const auto channels = static_cast<size_t>(pDevice->playback.channels);
-    const auto requireSize = static_cast<size_t>(frameCount) * channels * sizeof(int16_t);
-    size_t copyOffset = 0;
-    while (copyOffset < requireSize) {
-        updateCurrentData();
-        if (!m_currentData) {
-            const size_t remainSize = requireSize - copyOffset;
-            std::memset(static_cast<uint8_t*>(pOutput) + copyOffset, 0, remainSize);
-            m_playing.store(false);
-            break;
-        }
-
-        m_playing.store(true);
-        size_t frameBytes = static_cast<size_t>(m_currentData->nbSamples()) * channels * sizeof(int16_t);
-        if (m_offset > frameBytes) m_offset = frameBytes; // 防御式修正
-        size_t availableSize = frameBytes - m_offset;
-        const size_t toCopy = std::min(availableSize, requireSize - copyOffset);
-        std::memcpy(static_cast<uint8_t*>(pOutput) + copyOffset, m_currentData->data(0) + m_offset, toCopy);
-        m_offset += toCopy;
-        copyOffset += toCopy;
-        if (m_offset >= frameBytes) {
-            m_currentData.reset();
-            m_offset = 0;
-        }
-    }
-}
-void AudioRenderer::updateCurrentData()
-{
-    if (m_currentData) {
-        return;
+    // 从播放器的PCM缓冲区直接拷贝，不足部分填静音
+    const uint32_t framesRead = media::Player::instance().readAudio(pOutput, frameCount, m_latencyUs);
+    if (framesRead < frameCount) {
+        const size_t frameBytes = static_cast<size_t>(pDevice->playback.channels) *
+            ma_get_bytes_per_sample(pDevice->playback.format);
+        std::memset(static_cast<uint8_t*>(pOutput) + framesRead * frameBytes, 0, (frameCount - framesRead) * frameBytes);
     }
-    m_currentData = media::Player::instance().getAudioFrame();
+    m_playing.store(framesRead > 0);
 }
 
 } // namespace view
@@ -6,6 +6,8 @@
 #include <QObject>
 #include "../media/Frame.h"
 #include <atomic>
+#include <cstdint>
+#include <optional>
 
 typedef struct ma_device ma_device;
 
@@ -16,22 +18,29 @@ public:
     explicit AudioRenderer(QObject* parent = nullptr);
     ~AudioRenderer() override = default;
 
-    bool start(int sampleRate, int channels, int64_t startTimeUs);
+    // 默认输出设备的原生格式：支持float时为Float32，只支持16位整数时为S16；
+    // sampleRate、channels 为设备混音器的采样率和声道数，0 表示探测失败。探测结果缓存，
+    // start() 发现设备实际的混音格式与缓存不同（如插拔耳机、切换了默认设备）时失效，下次打开重新探测
+    struct DeviceFormat {
+        media::Frame::SampleFormat sampleFormat{media::Frame::SampleFormat::Float32};
+        int sampleRate{0};
+        int channels{0};
+    };
+    const DeviceFormat& probeDevice();
+    bool start(int sampleRate, int channels, media::Frame::SampleFormat format, int64_t startTimeUs);
     void stop();
 
     bool isPlaying() const { return m_playing.load(); }
 
 private:
     void maDataCallback(ma_device* pDevice, void* pOutput, const void* pInput, uint32_t frameCount);
-    void updateCurrentData();
 
 private:
     std::atomic_bool m_playing{false};
 
     ma_device* m_device{nullptr};
-
-    media::FramePtr m_currentData{nullptr};
-    size_t m_offset{0};
+    int64_t m_latencyUs{0}; // 设备内部缓冲的延迟
+    std::optional<DeviceFormat> m_deviceFormat;
 
     std::atomic_bool m_running{false};
 };
@@ -4,6 +4,10 @@
 
 #include "ControlWidget.h"
 #include <QVBoxLayout>
+#include <QGridLayout>
+#include <QEvent>
+#include <QMouseEvent>
+#include <QStyle>
 #include <logger.h>
 
 namespace view {
@@ -21,6 +25,7 @@ ControlWidget::ControlWidget(PlayerController* playerController, QWidget* parent
     connect(m_playerController, &PlayerController::durationChanged, this, &ControlWidget::onDurationChanged, Qt::QueuedConnection);
     connect(m_playerController, &PlayerController::positionChanged, this, &ControlWidget::onPlayingTimeChanged, Qt::QueuedConnection);
     connect(m_playerController, &PlayerController::stateChanged, this, &ControlWidget::onPlayStateChanged, Qt::QueuedConnection);
+    connect(m_playerController, &PlayerController::previewReady, this, &ControlWidget::onPreviewReady, Qt::QueuedConnection);
 }
 ControlWidget::~ControlWidget() {}
 
@@ -64,6 +69,7 @@ void ControlWidget::onPlayStateChanged(PlayerController::State state)
         m_timelineSlider->setEnabled(false);
     } else if (state == PlayerController::State::Stopped) {
         NEAPU_LOGD("ControlWidget::onPlayStateChanged: Stopped");
+        hidePreview();
         m_playPauseButton->setIcon(QIcon(":/svg/play.svg"));
         QMutexLocker locker(&m_mutex);
         m_timelineSlider->setValue(0);
@@ -90,20 +96,76 @@ void ControlWidget::onStopButtonClicked()
     m_playerController->onClose();
 }
 
+void ControlWidget::onPreviewReady(double seconds, const QImage& image)
+{
+    if (!m_timelineSlider->underMouse() || m_timelineSliderDragging) {
+        return;
+    }
+    m_previewLabel->setPixmap(QPixmap::fromImage(image));
+    m_previewLabel->adjustSize();
+    // 浮窗底边贴着进度条上方，水平居中于鼠标位置
+    const QPoint anchor = m_timelineSlider->mapToGlobal(QPoint(m_previewX, 0));
+    m_previewLabel->move(anchor.x() - m_previewLabel->width() / 2, anchor.y() - m_previewLabel->height() - 4);
+    m_previewLabel->show();
+    NEAPU_LOGD("Timeline preview shown at {} seconds", seconds);
+}
+
+bool ControlWidget::eventFilter(QObject* watched, QEvent* event)
+{
+    if (watched == m_timelineSlider) {
+        if (event->type() == QEvent::MouseMove) {
+            onTimelineHovered(static_cast<QMouseEvent*>(event)->position().toPoint().x());
+        } else if (event->type() == QEvent::Leave || event->type() == QEvent::MouseButtonPress) {
+            hidePreview();
+        }
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+void ControlWidget::onTimelineHovered(int x)
+{
+    if (!m_timelineSlider->isEnabled() || m_timelineSliderDragging || m_duration <= 0.0) {
+        return;
+    }
+    m_previewX = x;
+    const int value = QStyle::sliderValueFromPosition(m_timelineSlider->minimum(), m_timelineSlider->maximum(),
+        x, m_timelineSlider->width());
+    m_playerController->requestPreview(static_cast<double>(value) / 1000.0);
+}
+
+void ControlWidget::hidePreview()
+{
+    m_playerController->cancelPreview();
+    m_previewLabel->hide();
+}
+
 void ControlWidget::createTimelineLayout(QBoxLayout* parentLayout)
 {
-    auto* timelineLayout = new QHBoxLayout();
+    // 缩略图条放在进度条正下方，与进度条同列对齐
+    auto* timelineLayout = new QGridLayout();
     timelineLayout->setContentsMargins(0, 0, 0, 0);
-    timelineLayout->setSpacing(3);
+    timelineLayout->setHorizontalSpacing(3);
+    timelineLayout->setVerticalSpacing(2);
 
     m_currentTimeLabel = new QLabel("00:00:00", this);
     m_timelineSlider = new QSlider(Qt::Horizontal, this);
     m_totalTimeLabel = new QLabel("00:00:00", this);
-    timelineLayout->addWidget(m_currentTimeLabel);
-    timelineLayout->addWidget(m_timelineSlider, 1);
-    timelineLayout->addWidget(m_totalTimeLabel);
+    m_filmstrip = new FilmstripWidget(m_playerController, this);
+    m_filmstrip->setFixedHeight(36);
+    timelineLayout->addWidget(m_currentTimeLabel, 0, 0);
+    timelineLayout->addWidget(m_timelineSlider, 0, 1);
+    timelineLayout->addWidget(m_totalTimeLabel, 0, 2);
+    timelineLayout->addWidget(m_filmstrip, 1, 1);
+    timelineLayout->setColumnStretch(1, 1);
     parentLayout->addLayout(timelineLayout);
 
+    // 鼠标悬停在进度条上时显示对应位置的缩略图
+    m_timelineSlider->setMouseTracking(true);
+    m_timelineSlider->installEventFilter(this);
+    m_previewLabel = new QLabel(this, Qt::ToolTip);
+    m_previewLabel->setStyleSheet("QLabel { border: 1px solid #808080; background-color: black; }");
+    m_previewLabel->hide();
+
     connect(m_timelineSlider, &QSlider::sliderMoved, this, &ControlWidget::onTimelineSliderMoved);
     // connect(m_timelineSlider, &QSlider::valueChanged, this, &ControlWidget::onTimelineSliderValueChanged);
     connect(m_timelineSlider, &QSlider::sliderPressed, this, &ControlWidget::onTimelineSliderPressed);
@@ -206,8 +268,8 @@ void ControlWidget::onTimelineSliderMoved(int value)
 {
     QMutexLocker locker(&m_mutex);
     double sec = static_cast<double>(value) / 1000.0;
-    NEAPU_LOGI("Timeline Slider Moved: {} seconds", sec);
-    m_playerController->seek(sec);
+    NEAPU_LOGD("Timeline Slider Moved: {} seconds", sec);
+    m_playerController->scrubTo(sec);
 }
 void ControlWidget::onTimelineSliderPressed()
 {
@@ -215,12 +277,16 @@ void ControlWidget::onTimelineSliderPressed()
     m_timelineSliderDragging = true;
     double sec = static_cast<double>(m_timelineSlider->value()) / 1000.0;
     NEAPU_LOGI("Timeline Slider Pressed: {} seconds", sec);
-    m_playerController->seek(sec);
+    // 拖动过程中显示拖动缓存中的帧，松开时精确seek到最终位置
+    m_playerController->beginScrub(sec);
 }
 void ControlWidget::onTimelineSliderReleased()
 {
     QMutexLocker locker(&m_mutex);
     m_timelineSliderDragging = false;
+    double sec = static_cast<double>(m_timelineSlider->value()) / 1000.0;
+    NEAPU_LOGI("Timeline Slider Released: {} seconds", sec);
+    m_playerController->endScrub(sec);
 }
 void ControlWidget::onVolumeSliderMoved(int value)
 {
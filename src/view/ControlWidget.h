@@ -10,6 +10,7 @@
 #include <QBoxLayout>
 #include <QRecursiveMutex>
 #include "PlayerController.h"
+#include "FilmstripWidget.h"
 
 namespace view {
 
@@ -32,6 +33,11 @@ public slots:
     void onFastRewindButtonClicked();
     void onStopButtonClicked();
 
+    void onPreviewReady(double seconds, const QImage& image);
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
 private:
     void createTimelineLayout(QBoxLayout* parentLayout);
     void createControlLayout(QBoxLayout* parentLayout);
@@ -42,12 +48,18 @@ private:
 
     void onVolumeSliderMoved(int value);
 
+    void onTimelineHovered(int x);
+    void hidePreview();
+
 private:
     PlayerController* m_playerController{nullptr};
 
     QLabel* m_currentTimeLabel{nullptr};
     QLabel* m_totalTimeLabel{nullptr};
     QSlider* m_timelineSlider{nullptr};
+    FilmstripWidget* m_filmstrip{nullptr};
+    QLabel* m_previewLabel{nullptr}; // 悬停预览浮窗
+    int m_previewX{0};
 
     QPushButton* m_playPauseButton{nullptr};
     QPushButton* m_fastRewindButton{nullptr};
@@ -0,0 +1,39 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#include "FilmstripWidget.h"
+#include <QPainter>
+#include <algorithm>
+
+namespace view {
+FilmstripWidget::FilmstripWidget(PlayerController* playerController, QWidget* parent)
+    : QWidget(parent), m_playerController(playerController)
+{
+    connect(m_playerController, &PlayerController::thumbnailsUpdated, this, qOverload<>(&QWidget::update), Qt::QueuedConnection);
+}
+
+void FilmstripWidget::paintEvent(QPaintEvent* event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::black);
+    const auto* strip = m_playerController->thumbnailStrip();
+    if (!strip || !strip->isLayoutReady() || width() <= 0 || height() <= 0) {
+        return;
+    }
+    // 按控件高度等比缩放缩略图，平铺到整个宽度，每格取其中心对应的时间
+    const int tileWidth = std::max(1, strip->thumbnailWidth() * height() / strip->thumbnailHeight());
+    for (int x = 0; x < width(); x += tileWidth) {
+        const int center = std::min(width() - 1, x + tileWidth / 2);
+        const int index = static_cast<int>(static_cast<int64_t>(center) * strip->count() / width());
+        const uint8_t* data = strip->thumbnail(index);
+        if (!data) {
+            continue;
+        }
+        // 直接引用精灵图内存，不拷贝
+        const QImage image(data, strip->thumbnailWidth(), strip->thumbnailHeight(), strip->stride(), QImage::Format_RGBA8888);
+        painter.drawImage(QRect(x, 0, tileWidth, height()), image);
+    }
+}
+} // namespace view
@@ -0,0 +1,25 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+#include <QWidget>
+#include "PlayerController.h"
+
+namespace view {
+
+// 进度条下方的缩略图条，按宽度平铺，每格显示所在时间位置的缩略图
+class FilmstripWidget : public QWidget {
+    Q_OBJECT
+public:
+    explicit FilmstripWidget(PlayerController* playerController, QWidget* parent = nullptr);
+    ~FilmstripWidget() override = default;
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    PlayerController* m_playerController{nullptr};
+};
+
+} // namespace view
@@ -49,6 +49,42 @@ void MainWindow::createMenus()
         m_playerController->onOpen();
     });
     connect(exitAction, &QAction::triggered, [this]() { close(); });
+
+    auto* playbackMenu = menuBar()->addMenu(tr("&Playback"));
+    auto* reverseAction = playbackMenu->addAction(tr("&Reverse Playback"));
+    reverseAction->setShortcut(QKeySequence(Qt::Key_R));
+    connect(reverseAction, &QAction::triggered, [this]() {
+        m_playerController->toggleReversePlayback();
+    });
+
+    playbackMenu->addSeparator();
+    auto* fasterAction = playbackMenu->addAction(tr("Speed &Up"));
+    fasterAction->setShortcut(QKeySequence(Qt::Key_BracketRight));
+    connect(fasterAction, &QAction::triggered, [this]() {
+        m_playerController->changePlaybackRate(1);
+    });
+    auto* slowerAction = playbackMenu->addAction(tr("Slow &Down"));
+    slowerAction->setShortcut(QKeySequence(Qt::Key_BracketLeft));
+    connect(slowerAction, &QAction::triggered, [this]() {
+        m_playerController->changePlaybackRate(-1);
+    });
+    auto* normalSpeedAction = playbackMenu->addAction(tr("&Normal Speed"));
+    normalSpeedAction->setShortcut(QKeySequence(Qt::Key_Backslash));
+    connect(normalSpeedAction, &QAction::triggered, [this]() {
+        m_playerController->changePlaybackRate(0);
+    });
+
+    playbackMenu->addSeparator();
+    auto* stepForwardAction = playbackMenu->addAction(tr("Step &Forward"));
+    stepForwardAction->setShortcut(QKeySequence(Qt::Key_Period));
+    connect(stepForwardAction, &QAction::triggered, [this]() {
+        m_playerController->stepForward();
+    });
+    auto* stepBackwardAction = playbackMenu->addAction(tr("Step &Backward"));
+    stepBackwardAction->setShortcut(QKeySequence(Qt::Key_Comma));
+    connect(stepBackwardAction, &QAction::triggered, [this]() {
+        m_playerController->stepBackward();
+    });
 }
 void MainWindow::createLayout()
 {
@@ -60,7 +96,7 @@ void MainWindow::createLayout()
     m_playerController = new PlayerController(m_videoRenderer, this);
     layout->addWidget(m_videoRenderer, 1);
     m_controlWidget = new ControlWidget(m_playerController, centralWidget);
-    m_controlWidget->setFixedHeight(80);
+    m_controlWidget->setFixedHeight(118); // 含缩略图条
     layout->addWidget(m_controlWidget, 0);
     layout->setContentsMargins(0, 0, 0, 0);
     layout->setSpacing(0);
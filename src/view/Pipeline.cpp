@@ -64,7 +64,14 @@ std::unique_ptr<Pipeline> Pipeline::makeFormFrame(const media::FramePtr& frame,
     try {
         switch (frame->pixelFormat()) {
         case YUV420P:
-            return std::make_unique<YuvPipeline>(param.rhi);
+        case NV12:
+        case P010:
+        case YUV420P10:
+        case YUV422P:
+        case YUV422P10:
+        case YUV444P:
+        case YUV444P10:
+            return std::make_unique<YuvPipeline>(param.rhi, frame->pixelFormat());
         case D3D11Texture2D:
 #ifdef _WIN32
             return std::make_unique<D3D11VAPipeline>(param.rhi, param.d3d11Device, param.d3d11DeviceContext, frame->swFormat());
@@ -116,7 +123,10 @@ QRhiShaderResourceBindings* Pipeline::getSrb() const
 }
 bool Pipeline::checkFormat(const media::FramePtr& frame) const
 {
-    return frame->pixelFormat() == m_pixelFormat;
+    if (frame->pixelFormat() != m_pixelFormat) {
+        return false;
+    }
+    return m_textureSize.isEmpty() || m_textureSize == QSize(frame->width(), frame->height());
 }
 void Pipeline::updateVertexUniforms(QRhiResourceUpdateBatch* rub, const QSize& renderSize, const QSize& frameSize)
 {
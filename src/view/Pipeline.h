@@ -52,6 +52,7 @@ protected:
     bool m_colorParamsInitialized{false};
     QRhi* m_rhi{nullptr};
 
+    QSize m_textureSize{0,0}; // 按帧尺寸创建纹理的管线记录其尺寸，尺寸变化时需要重建
     QSize m_oldFrameSize{0,0};
     QSize m_oldRenderSize{0,0};
 
@@ -6,6 +6,11 @@
 #include <QObject>
 #include "VideoRenderer.h"
 #include "AudioRenderer.h"
+#include "../media/Player.h"
+#include "../media/PreviewDecoder.h"
+#include "../media/ThumbnailStrip.h"
+#include <QImage>
+#include <memory>
 
 namespace view {
 
@@ -24,27 +29,57 @@ public:
     void onClose();
     void onPauseOrResume();
 
-    void seek(double seconds);
+    void seek(double seconds, media::Player::SeekMode mode = media::Player::SeekMode::Fast);
+
+    // 拖动进度条，播放器不支持拖动缓存时退化为逐次seek
+    void beginScrub(double seconds);
+    void scrubTo(double seconds);
+    void endScrub(double seconds);
+
+    // 进度条悬停预览，结果通过 previewReady 返回，过期的请求不会返回
+    void requestPreview(double seconds);
+    void cancelPreview();
+
+    // 当前文件的缩略图条，未打开或没有视频时为空；只在界面线程访问
+    const media::ThumbnailStrip* thumbnailStrip() const { return m_thumbnailStrip.get(); }
 
     void fastForward();
     void fastRewind();
+    void toggleReversePlayback();
+    // 变速播放：direction 为 1/-1 时按档位加快/减慢，0 恢复原速
+    void changePlaybackRate(int direction);
+    // 仅暂停时有效
+    void stepForward();
+    void stepBackward();
 
     State state() const { return m_state; }
 
 private slots:
     void onStreamEof();
+    void applyRenderSize();
+
+private:
+    void createPreviewDecoder(const std::string& url);
+    void createThumbnailStrip(const std::string& url);
 
 signals:
     void fileNameChanged(const QString& fileName);
     void durationChanged(double seconds);
     void positionChanged(double seconds);
     void stateChanged(State state);
+    void previewReady(double seconds, const QImage& image);
+    void thumbnailsUpdated();
 
 private:
     VideoRenderer* m_videoRenderer{nullptr};
     AudioRenderer* m_audioRenderer{nullptr};
 
     State m_state{State::Stopped};
+
+    std::unique_ptr<media::PreviewDecoder> m_previewDecoder;
+    uint64_t m_previewRequestId{0};
+    std::unique_ptr<media::ThumbnailStrip> m_thumbnailStrip;
+    int m_renderSizeRetries{0};
 };
 
 } // namespace view
@@ -6,17 +6,31 @@
 #include <logger.h>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QDir>
+#include <QStandardPaths>
+#include <QTimer>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
 #include "../media/Player.h"
 using media::Player;
 namespace view {
+// 正在seek时lowres刷新被拒绝，等seek完成后重试
+constexpr int RENDER_SIZE_RETRY_MS = 100;
+constexpr int RENDER_SIZE_MAX_RETRIES = 50;
+
 PlayerController::PlayerController(VideoRenderer* videoRenderer, QObject* parent) : QObject(parent), m_videoRenderer(videoRenderer)
 {
     m_audioRenderer = new AudioRenderer(this);
+    // 渲染回调中不seek，切换到界面线程再刷新lowres
+    connect(m_videoRenderer, &VideoRenderer::renderSizeChanged, this, &PlayerController::applyRenderSize, Qt::QueuedConnection);
 }
 PlayerController::~PlayerController()
 {
+    m_previewDecoder.reset();
+    m_thumbnailStrip.reset();
     m_audioRenderer->stop();
-    Player::instance().close();
+    Player::instance().shutdown();
 }
 void PlayerController::onOpen()
 {
@@ -66,6 +80,18 @@ void PlayerController::onOpen()
     param.downgradePixelFormat = media::Frame::PixelFormat::YUV420P;
     param.swDecodeOnly = true;
 #endif
+    param.passthroughPixelFormats = m_videoRenderer->supportedSoftwareFormats();
+    param.displaySizeAwareDecoding = true;
+    // 按设备原生格式、采样率和声道数输出，音频回调中只做拷贝
+    const auto& deviceFormat = m_audioRenderer->probeDevice();
+    param.audioSampleFormat = deviceFormat.sampleFormat;
+    param.audioOutputSampleRate = deviceFormat.sampleRate;
+    param.audioOutputChannels = deviceFormat.channels;
+    param.audioScrub = true;
+    const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    if (!cacheDir.isEmpty() && QDir().mkpath(cacheDir)) {
+        param.hwProbeCachePath = QDir(cacheDir).filePath("hwprobe.cache").toStdString();
+    }
 
     if (!Player::instance().open(param)) {
         NEAPU_LOGE("Failed to open media file: {}", param.url);
@@ -77,7 +103,12 @@ void PlayerController::onOpen()
         m_videoRenderer->start(Player::instance().fps(), currentTimeUs);
     }
     if (Player::instance().hasAudio()) {
-        m_audioRenderer->start(Player::instance().sampleRate(), Player::instance().channelCount(), currentTimeUs);
+        m_audioRenderer->start(Player::instance().sampleRate(), Player::instance().channelCount(),
+            Player::instance().audioSampleFormat(), currentTimeUs);
+    }
+    if (Player::instance().hasVideo()) {
+        createPreviewDecoder(param.url);
+        createThumbnailStrip(param.url);
     }
     media::Player::instance().play();
     m_state = State::Playing;
@@ -89,6 +120,10 @@ void PlayerController::onClose()
 {
     m_audioRenderer->stop();
     m_videoRenderer->stop();
+    m_previewDecoder.reset();
+    m_previewRequestId = 0;
+    m_thumbnailStrip.reset();
+    emit thumbnailsUpdated();
     Player::instance().close();
     m_state = State::Stopped;
     emit stateChanged(m_state);
@@ -96,6 +131,11 @@ void PlayerController::onClose()
 }
 void PlayerController::onPauseOrResume()
 {
+    if (m_state == State::Playing && Player::instance().trickPlaySpeed() != 0) {
+        // 快进快退中按播放键回到正常速度
+        Player::instance().setTrickPlaySpeed(0);
+        return;
+    }
     if (m_state == State::Playing) {
         media::Player::instance().pause();
         m_state = State::Pause;
@@ -105,40 +145,169 @@ void PlayerController::onPauseOrResume()
     }
     emit stateChanged(m_state);
 }
-void PlayerController::seek(double seconds)
+void PlayerController::seek(double seconds, Player::SeekMode mode)
 {
     if (m_state != State::Playing) {
         return;
     }
-    Player::instance().seek(seconds);
+    Player::instance().seek(seconds, mode);
+}
+void PlayerController::beginScrub(double seconds)
+{
+    if (m_state != State::Playing) {
+        return;
+    }
+    if (!Player::instance().beginScrub()) {
+        Player::instance().seek(seconds, Player::SeekMode::Accurate);
+        return;
+    }
+    Player::instance().scrubTo(seconds);
+}
+void PlayerController::scrubTo(double seconds)
+{
+    if (m_state != State::Playing) {
+        return;
+    }
+    if (Player::instance().isScrubbing()) {
+        Player::instance().scrubTo(seconds);
+    } else {
+        Player::instance().seek(seconds);
+    }
+}
+void PlayerController::endScrub(double seconds)
+{
+    if (Player::instance().isScrubbing()) {
+        Player::instance().endScrub(seconds);
+    }
+}
+void PlayerController::createPreviewDecoder(const std::string& url)
+{
+    media::PreviewDecoder::Config config;
+    config.url = url;
+    m_previewDecoder = std::make_unique<media::PreviewDecoder>(config,
+        [this](uint64_t requestId, int64_t positionUs, media::FramePtr frame) {
+            // 在预览线程中拷贝成QImage，回到界面线程后再丢弃过期结果
+            QImage image(frame->data(0), frame->width(), frame->height(), frame->lineSize(0), QImage::Format_RGBA8888);
+            image = image.copy();
+            QMetaObject::invokeMethod(this, [this, requestId, positionUs, image]() {
+                if (requestId == m_previewRequestId) {
+                    emit previewReady(static_cast<double>(positionUs) / 1e6, image);
+                }
+            }, Qt::QueuedConnection);
+        });
+}
+void PlayerController::createThumbnailStrip(const std::string& url)
+{
+    media::ThumbnailStrip::Config config;
+    config.url = url;
+    const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (!cacheDir.isEmpty()) {
+        config.cacheDir = QDir(cacheDir).filePath("thumbnails").toStdString();
+    }
+    m_thumbnailStrip = std::make_unique<media::ThumbnailStrip>(config, [this](int) {
+        QMetaObject::invokeMethod(this, [this]() { emit thumbnailsUpdated(); }, Qt::QueuedConnection);
+    });
+}
+void PlayerController::requestPreview(double seconds)
+{
+    if (!m_previewDecoder) {
+        return;
+    }
+    m_previewRequestId = m_previewDecoder->request(static_cast<int64_t>(seconds * 1'000'000));
+}
+void PlayerController::cancelPreview()
+{
+    if (!m_previewDecoder) {
+        return;
+    }
+    m_previewDecoder->cancel();
+    m_previewRequestId = 0;
+}
+static int nextTrickSpeed(int current, int direction)
+{
+    // 同方向按 8x -> 16x -> 32x 递增，超过32x回到正常速度；反方向先回到正常速度
+    if (current == 0 || (current > 0) != (direction > 0)) {
+        return current == 0 ? 8 * direction : 0;
+    }
+    const int next = current * 2;
+    return std::abs(next) > 32 ? 0 : next;
 }
 void PlayerController::fastForward()
 {
     if (m_state != State::Playing) {
         return;
     }
-    double currentPos = (double)media::Player::instance().lastPlayPtsUs() / 1e6;
-    double newPos = currentPos + 15.0; // 快进15秒
-    if (newPos > Player::instance().durationSeconds()) {
-        newPos = Player::instance().durationSeconds();
-    } else if (newPos < 0.0) {
-        newPos = 0.0;
+    if (!Player::instance().hasVideo()) {
+        // 纯音频没有关键帧可显示，保留跳转15秒
+        double newPos = (double)media::Player::instance().lastPlayPtsUs() / 1e6 + 15.0;
+        seek(std::min(newPos, Player::instance().durationSeconds()), Player::SeekMode::Accurate);
+        return;
     }
-    seek(newPos);
+    Player::instance().setTrickPlaySpeed(nextTrickSpeed(Player::instance().trickPlaySpeed(), 1));
 }
 void PlayerController::fastRewind()
 {
     if (m_state != State::Playing) {
         return;
     }
-    double currentPos = (double)media::Player::instance().lastPlayPtsUs() / 1e6;
-    double newPos = currentPos - 15.0; // 快退15秒
-    if (newPos < 0.0) {
-        newPos = 0.0;
+    if (!Player::instance().hasVideo()) {
+        double newPos = (double)media::Player::instance().lastPlayPtsUs() / 1e6 - 15.0;
+        seek(std::max(newPos, 0.0), Player::SeekMode::Accurate);
+        return;
+    }
+    Player::instance().setTrickPlaySpeed(nextTrickSpeed(Player::instance().trickPlaySpeed(), -1));
+}
+void PlayerController::changePlaybackRate(int direction)
+{
+    static constexpr std::array<double, 7> RATES{0.5, 0.75, 1.0, 1.25, 1.5, 1.75, 2.0};
+    const double current = Player::instance().playbackRate();
+    double next = 1.0;
+    if (direction > 0) {
+        auto it = std::upper_bound(RATES.begin(), RATES.end(), current);
+        next = it != RATES.end() ? *it : RATES.back();
+    } else if (direction < 0) {
+        auto it = std::lower_bound(RATES.begin(), RATES.end(), current);
+        next = it != RATES.begin() ? *std::prev(it) : RATES.front();
+    }
+    Player::instance().setPlaybackRate(next);
+}
+void PlayerController::toggleReversePlayback()
+{
+    if (m_state != State::Playing) {
+        return;
     }
-    seek(newPos);
+    Player::instance().setReversePlayback(!Player::instance().isReversePlayback());
 }
 
+void PlayerController::stepForward()
+{
+    if (m_state != State::Pause) {
+        return;
+    }
+    Player::instance().stepForward();
+}
+
+void PlayerController::stepBackward()
+{
+    if (m_state != State::Pause) {
+        return;
+    }
+    Player::instance().stepBackward();
+}
+
+void PlayerController::applyRenderSize()
+{
+    if (m_state == State::Stopped || Player::instance().applyRenderSize()) {
+        m_renderSizeRetries = 0;
+        return;
+    }
+    if (++m_renderSizeRetries > RENDER_SIZE_MAX_RETRIES) {
+        NEAPU_LOGW("Giving up refreshing decoder lowres, it takes effect on the next seek");
+        m_renderSizeRetries = 0;
+        return;
+    }
+    QTimer::singleShot(RENDER_SIZE_RETRY_MS, this, &PlayerController::applyRenderSize);
+}
 void PlayerController::onStreamEof()
 {
     while (m_audioRenderer->isPlaying()) {
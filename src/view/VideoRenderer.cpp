@@ -8,6 +8,7 @@
 #include <QThreadPool>
 #include "../media/Packet.h"
 #include "../media/Player.h"
+#include "YuvPipeline.h"
 #ifdef __linux__
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
@@ -149,6 +150,11 @@ bool VideoRenderer::useOpenGL() const
     return m_rhi->backend() == QRhi::OpenGLES2;
 }
 
+std::vector<media::Frame::PixelFormat> VideoRenderer::supportedSoftwareFormats() const
+{
+    return YuvPipeline::supportedPixelFormats(m_rhi);
+}
+
 #ifdef _WIN32
 ID3D11Device* VideoRenderer::getD3D11Device()
 {
@@ -158,6 +164,12 @@ ID3D11Device* VideoRenderer::getD3D11Device()
 
 void VideoRenderer::RenderFrame(QRhiCommandBuffer* cb)
 {
+    if (const QSize renderSize = renderTarget()->pixelSize(); renderSize != m_reportedRenderSize) {
+        // 窗口缩放、全屏切换或DPI变化后上报，解码端据此决定是否缩小输出
+        m_reportedRenderSize = renderSize;
+        media::Player::instance().setRenderSize(renderSize.width(), renderSize.height());
+        emit renderSizeChanged();
+    }
     auto frame = media::Player::instance().getVideoFrame();
     if (!frame) {
         return;
@@ -33,6 +33,7 @@ public:
 
     bool useD3D11() const;
     bool useOpenGL() const;
+    std::vector<media::Frame::PixelFormat> supportedSoftwareFormats() const;
 
 #ifdef _WIN32
     ID3D11Device* getD3D11Device();
@@ -40,6 +41,8 @@ public:
 
 signals:
     void initialized();
+    // 渲染尺寸已上报给播放器，在渲染回调中发出，接收方应排队处理
+    void renderSizeChanged();
 
 private:
     void RenderFrame(QRhiCommandBuffer* cb);
@@ -52,6 +55,7 @@ private:
     std::unique_ptr<Pipeline> m_pipeline{};
 
     std::atomic_bool m_running{false};
+    QSize m_reportedRenderSize; // 已上报给播放器的渲染尺寸
 
 #ifdef _WIN32
     ID3D11Device* m_d3d11Device{nullptr};
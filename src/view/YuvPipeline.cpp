@@ -4,15 +4,114 @@
 
 #include "YuvPipeline.h"
 #include <logger.h>
+extern "C" {
+#include <libavutil/common.h>
+#include <libavutil/pixdesc.h>
+}
 
 namespace view {
-YuvPipeline::YuvPipeline(QRhi* rhi)
+// 根据像素格式描述生成平面布局和对应的片段着色器，不支持的格式返回false
+static bool describePixelFormat(media::Frame::PixelFormat pixelFormat, std::vector<YuvPipeline::Plane>* planes, QString* shaderName)
+{
+    const auto avFormat = static_cast<AVPixelFormat>(media::Frame::toAVPixelFormat(pixelFormat));
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(avFormat);
+    if (!desc) {
+        return false;
+    }
+    constexpr uint64_t unsupportedFlags = AV_PIX_FMT_FLAG_BE | AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_HWACCEL |
+                                          AV_PIX_FMT_FLAG_BITSTREAM | AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_ALPHA;
+    if (desc->flags & unsupportedFlags || desc->nb_components != 3) {
+        return false;
+    }
+
+    const int planeCount = av_pix_fmt_count_planes(avFormat);
+    const int depth = desc->comp[0].depth;
+    if (depth > 10 || (planeCount != 2 && planeCount != 3)) {
+        return false;
+    }
+
+    std::vector<YuvPipeline::Plane> result(planeCount);
+    for (int p = 0; p < planeCount; p++) {
+        int components = 0;
+        bool chroma = false;
+        for (int c = 0; c < desc->nb_components; c++) {
+            if (desc->comp[c].plane == p) {
+                components++;
+                chroma = chroma || c > 0;
+            }
+        }
+        const bool highBitDepth = depth > 8;
+        if (components == 1) {
+            result[p].format = highBitDepth ? QRhiTexture::R16 : QRhiTexture::R8;
+        } else if (components == 2) {
+            result[p].format = highBitDepth ? QRhiTexture::RG16 : QRhiTexture::RG8;
+        } else {
+            return false;
+        }
+        if (chroma) {
+            result[p].log2ChromaW = desc->log2_chroma_w;
+            result[p].log2ChromaH = desc->log2_chroma_h;
+        }
+    }
+
+    if (planes) {
+        *planes = std::move(result);
+    }
+    if (shaderName) {
+        if (planeCount == 2) {
+            // NV12/P010：P010 高位对齐，归一化后与8位取值一致
+            *shaderName = ":/shaders/nv12.frag.qsb";
+        } else if (depth > 8) {
+            // 低位对齐的10位平面格式，需要在着色器中放大
+            *shaderName = ":/shaders/yuv420p10.frag.qsb";
+        } else {
+            // 采样坐标归一化，4:2:0/4:2:2/4:4:4 共用同一着色器，差异只在纹理尺寸
+            *shaderName = ":/shaders/yuv420p.frag.qsb";
+        }
+    }
+    return true;
+}
+
+YuvPipeline::YuvPipeline(QRhi* rhi, media::Frame::PixelFormat pixelFormat)
     : Pipeline(rhi)
 {
-    m_pixelFormat = media::Frame::PixelFormat::YUV420P;
+    if (!describePixelFormat(pixelFormat, &m_planes, &m_fragmentShaderName)) {
+        NEAPU_LOGE("Unsupported software pixel format: {}", static_cast<int>(pixelFormat));
+        throw std::runtime_error("Unsupported software pixel format");
+    }
+    for (const auto& plane : m_planes) {
+        if (!m_rhi->isTextureFormatSupported(plane.format)) {
+            NEAPU_LOGE("Texture format {} is not supported by QRhi backend", static_cast<int>(plane.format));
+            throw std::runtime_error("Texture format not supported");
+        }
+    }
+    m_pixelFormat = pixelFormat;
 }
 YuvPipeline::~YuvPipeline() = default;
 
+std::vector<media::Frame::PixelFormat> YuvPipeline::supportedPixelFormats(QRhi* rhi)
+{
+    using enum media::Frame::PixelFormat;
+    std::vector<media::Frame::PixelFormat> formats;
+    if (!rhi) {
+        return formats;
+    }
+    for (auto format : {YUV420P, NV12, P010, YUV420P10, YUV422P, YUV422P10, YUV444P, YUV444P10}) {
+        std::vector<Plane> planes;
+        if (!describePixelFormat(format, &planes, nullptr)) {
+            continue;
+        }
+        bool supported = true;
+        for (const auto& plane : planes) {
+            supported = supported && rhi->isTextureFormatSupported(plane.format);
+        }
+        if (supported) {
+            formats.push_back(format);
+        }
+    }
+    return formats;
+}
+
 void YuvPipeline::updateTexture(QRhiResourceUpdateBatch* rub, media::FramePtr&& frame)
 {
     if (!frame) {
@@ -20,71 +119,52 @@ void YuvPipeline::updateTexture(QRhiResourceUpdateBatch* rub, media::FramePtr&&
         return;
     }
 
-    // Y平面
-    {
-        int yDataSize = frame->lineSize(0) * frame->height();
-        QRhiTextureSubresourceUploadDescription sub(frame->data(0), yDataSize);
-        sub.setSourceSize(QSize(frame->width(), frame->height()));
-        sub.setDataStride(frame->lineSize(0));
-        QRhiTextureUploadEntry entry(0, 0, sub);
-        QRhiTextureUploadDescription desc({entry});
-        rub->uploadTexture(m_yTexture.get(), desc);
-    }
-
-    // U平面
-    {
-        int uDataSize = frame->lineSize(1) * (frame->height() / 2);
-        QRhiTextureSubresourceUploadDescription sub(frame->data(1), uDataSize);
-        sub.setSourceSize(QSize(frame->width() / 2, frame->height() / 2));
-        sub.setDataStride(frame->lineSize(1));
+    for (size_t i = 0; i < m_planes.size() && i < m_textures.size(); i++) {
+        const auto& plane = m_planes[i];
+        const int index = static_cast<int>(i);
+        const int planeWidth = AV_CEIL_RSHIFT(frame->width(), plane.log2ChromaW);
+        const int planeHeight = AV_CEIL_RSHIFT(frame->height(), plane.log2ChromaH);
+        const int dataSize = frame->lineSize(index) * planeHeight;
+        QRhiTextureSubresourceUploadDescription sub(frame->data(index), dataSize);
+        sub.setSourceSize(QSize(planeWidth, planeHeight));
+        sub.setDataStride(frame->lineSize(index));
         QRhiTextureUploadEntry entry(0, 0, sub);
         QRhiTextureUploadDescription desc({entry});
-        rub->uploadTexture(m_uTexture.get(), desc);
+        rub->uploadTexture(m_textures[i].get(), desc);
     }
 
-    // V平面
-    {
-        int vDataSize = frame->lineSize(2) * (frame->height() / 2);
-        QRhiTextureSubresourceUploadDescription sub(frame->data(2), vDataSize);
-        sub.setSourceSize(QSize(frame->width() / 2, frame->height() / 2));
-        sub.setDataStride(frame->lineSize(2));
-        QRhiTextureUploadEntry entry(0, 0, sub);
-        QRhiTextureUploadDescription desc({entry});
-        rub->uploadTexture(m_vTexture.get(), desc);
-    }
-    
     // frame 在这里析构
 }
 bool YuvPipeline::createSrb(const QSize& size)
 {
     NEAPU_FUNC_TRACE;
-    
+
     // 先释放旧的纹理
-    m_yTexture.reset();
-    m_uTexture.reset();
-    m_vTexture.reset();
-    
+    m_textures.clear();
+
     // 创建新纹理
-    m_yTexture.reset(m_rhi->newTexture(QRhiTexture::R8, QSize(size.width(), size.height()), 1, QRhiTexture::Flags()));
-    m_uTexture.reset(m_rhi->newTexture(QRhiTexture::R8, QSize(size.width() / 2, size.height() / 2), 1, QRhiTexture::Flags()));
-    m_vTexture.reset(m_rhi->newTexture(QRhiTexture::R8, QSize(size.width() / 2, size.height() / 2), 1, QRhiTexture::Flags()));
-    if (!m_yTexture->create() || !m_uTexture->create() || !m_vTexture->create()) {
-        NEAPU_LOGE("Failed to create YUV textures");
-        m_yTexture.reset();
-        m_uTexture.reset();
-        m_vTexture.reset();
-        return false;
+    for (const auto& plane : m_planes) {
+        const QSize planeSize(AV_CEIL_RSHIFT(size.width(), plane.log2ChromaW), AV_CEIL_RSHIFT(size.height(), plane.log2ChromaH));
+        std::unique_ptr<QRhiTexture> texture(m_rhi->newTexture(plane.format, planeSize, 1, QRhiTexture::Flags()));
+        if (!texture->create()) {
+            NEAPU_LOGE("Failed to create YUV textures");
+            m_textures.clear();
+            return false;
+        }
+        m_textures.push_back(std::move(texture));
+    }
+    m_textureSize = size;
+
+    QVarLengthArray<QRhiShaderResourceBinding, 5> bindings;
+    for (size_t i = 0; i < m_textures.size(); i++) {
+        bindings.append(QRhiShaderResourceBinding::sampledTexture(static_cast<int>(i), QRhiShaderResourceBinding::FragmentStage, m_textures[i].get(), m_sampler.get()));
     }
+    bindings.append(QRhiShaderResourceBinding::uniformBuffer(3, QRhiShaderResourceBinding::VertexStage, m_vsUBuffer.get()));
+    bindings.append(QRhiShaderResourceBinding::uniformBuffer(4, QRhiShaderResourceBinding::FragmentStage, m_colorParamsUBuffer.get()));
 
     // 总是重新创建 SRB，不复用旧的
     m_srb.reset(m_rhi->newShaderResourceBindings());
-    m_srb->setBindings({
-        QRhiShaderResourceBinding::sampledTexture(0, QRhiShaderResourceBinding::FragmentStage, m_yTexture.get(), m_sampler.get()),
-        QRhiShaderResourceBinding::sampledTexture(1, QRhiShaderResourceBinding::FragmentStage, m_uTexture.get(), m_sampler.get()),
-        QRhiShaderResourceBinding::sampledTexture(2, QRhiShaderResourceBinding::FragmentStage, m_vTexture.get(), m_sampler.get()),
-        QRhiShaderResourceBinding::uniformBuffer(3, QRhiShaderResourceBinding::VertexStage, m_vsUBuffer.get()),
-        QRhiShaderResourceBinding::uniformBuffer(4, QRhiShaderResourceBinding::FragmentStage, m_colorParamsUBuffer.get()),
-    });
+    m_srb->setBindings(bindings.cbegin(), bindings.cend());
     if (!m_srb->create()) {
         NEAPU_LOGE("Failed to create shader resource bindings for YUV pipeline");
         m_srb.reset();
@@ -95,7 +175,7 @@ bool YuvPipeline::createSrb(const QSize& size)
 }
 QString YuvPipeline::getFragmentShaderName()
 {
-    return ":/shaders/yuv420p.frag.qsb";
+    return m_fragmentShaderName;
 }
 
-} // namespace view
\ No newline at end of file
+} // namespace view
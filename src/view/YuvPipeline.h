@@ -4,25 +4,37 @@
 
 #pragma once
 #include "Pipeline.h"
+#include <vector>
 
 namespace view {
 
+// 通用软件帧管线，按 AVPixFmtDescriptor 为每个平面创建纹理（R8/RG8/R16/RG16），
+// 支持 YUV420P、NV12、P010 以及 10 位、4:2:2、4:4:4 的平面格式
 class YuvPipeline : public Pipeline {
 public:
-    explicit YuvPipeline(QRhi* rhi);
+    YuvPipeline(QRhi* rhi, media::Frame::PixelFormat pixelFormat);
     ~YuvPipeline() override;
 
+    // 当前 RHI 能直接渲染的软件格式，解码端据此跳过格式转换
+    static std::vector<media::Frame::PixelFormat> supportedPixelFormats(QRhi* rhi);
+
     void updateTexture(QRhiResourceUpdateBatch* rub, media::FramePtr&& frame) override;
 
+    struct Plane {
+        QRhiTexture::Format format{QRhiTexture::R8};
+        int log2ChromaW{0};
+        int log2ChromaH{0};
+    };
+
 protected:
     bool createSrb(const QSize& size) override;
     QString getFragmentShaderName() override;
 
 protected:
+    std::vector<Plane> m_planes;
+    QString m_fragmentShaderName;
 
-    std::unique_ptr<QRhiTexture> m_yTexture{};
-    std::unique_ptr<QRhiTexture> m_uTexture{};
-    std::unique_ptr<QRhiTexture> m_vTexture{};
+    std::vector<std::unique_ptr<QRhiTexture>> m_textures;
 };
 
 } // namespace view
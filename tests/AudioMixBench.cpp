@@ -0,0 +1,192 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+// 声道下混基准：5.1 和 7.1 下混立体声，按 AudioDecoder 的矩阵（buildMixMatrix）对比 swr 矩阵混合
+// 与本机支持的每个 AudioKernels 实现，分别测 float 输出和 S16 输出，报告每秒音频的处理耗时，
+// 同时检查各实现与标量实现、swr 的输出一致
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "BenchCommon.h"
+#include "TestCommon.h"
+#include "media/AudioKernels.h"
+#include "media/AudioResample.h"
+extern "C" {
+#include <libavutil/channel_layout.h>
+#include <libavutil/samplefmt.h>
+#include <libswresample/swresample.h>
+}
+
+constexpr int SAMPLE_RATE = 48000;
+constexpr int OUT_CHANNELS = 2;
+// 与解码器输出的一帧音频大小相当
+constexpr int BLOCK_FRAMES = 1024;
+
+static std::vector<float> makeSignal(int channels, int frames, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> samples(static_cast<size_t>(channels) * frames);
+    for (auto& sample : samples) {
+        sample = dist(rng);
+    }
+    return samples;
+}
+
+static SwrContext* createSwrMixer(int inChannels, const std::vector<float>& matrix, AVSampleFormat outFormat)
+{
+    AVChannelLayout in{};
+    AVChannelLayout out{};
+    av_channel_layout_default(&in, inChannels);
+    av_channel_layout_default(&out, OUT_CHANNELS);
+    SwrContext* ctx = nullptr;
+    int ret = swr_alloc_set_opts2(&ctx, &out, outFormat, SAMPLE_RATE, &in, AV_SAMPLE_FMT_FLT, SAMPLE_RATE, 0, nullptr);
+    av_channel_layout_uninit(&in);
+    av_channel_layout_uninit(&out);
+    if (ret >= 0) {
+        const std::vector<double> coefficients(matrix.begin(), matrix.end());
+        ret = swr_set_matrix(ctx, coefficients.data(), inChannels);
+    }
+    if (ret >= 0) {
+        ret = swr_init(ctx);
+    }
+    if (ret < 0) {
+        swr_free(&ctx);
+    }
+    return ctx;
+}
+
+// 与解码器一样逐块处理整段信号
+static bool mixWithSwr(SwrContext* ctx, const std::vector<float>& src, int inChannels, void* dst, int bytesPerSample)
+{
+    const int frames = static_cast<int>(src.size() / inChannels);
+    bool ok = true;
+    for (int offset = 0; offset < frames; offset += BLOCK_FRAMES) {
+        const int count = std::min(BLOCK_FRAMES, frames - offset);
+        const uint8_t* in[] = {reinterpret_cast<const uint8_t*>(src.data() + static_cast<size_t>(offset) * inChannels)};
+        uint8_t* out[] = {static_cast<uint8_t*>(dst) + static_cast<size_t>(offset) * OUT_CHANNELS * bytesPerSample};
+        ok = swr_convert(ctx, out, count, in, count) == count && ok;
+    }
+    return ok;
+}
+
+static void mixWithKernels(const media::AudioKernels& kernels, const std::vector<float>& src, int inChannels,
+    const std::vector<float>& matrix, float* dst, int16_t* s16)
+{
+    const int frames = static_cast<int>(src.size() / inChannels);
+    for (int offset = 0; offset < frames; offset += BLOCK_FRAMES) {
+        const int count = std::min(BLOCK_FRAMES, frames - offset);
+        float* mixed = dst + static_cast<size_t>(offset) * OUT_CHANNELS;
+        kernels.mixChannels(src.data() + static_cast<size_t>(offset) * inChannels, inChannels,
+            mixed, OUT_CHANNELS, matrix.data(), count);
+        if (s16) {
+            kernels.floatToS16(mixed, s16 + static_cast<size_t>(offset) * OUT_CHANNELS, count * OUT_CHANNELS);
+        }
+    }
+}
+
+template <typename T>
+static double maxDiff(const std::vector<T>& a, const std::vector<T>& b)
+{
+    double diff = 0.0;
+    for (size_t i = 0; i < std::min(a.size(), b.size()); i++) {
+        diff = std::max(diff, std::abs(static_cast<double>(a[i]) - static_cast<double>(b[i])));
+    }
+    return diff;
+}
+
+int main(int argc, char* argv[])
+{
+    test::initTestLogging();
+    const bool quick = test::isQuickMode(argc, argv);
+    const int64_t minDurationUs = quick ? 30'000 : 500'000;
+    const int frames = SAMPLE_RATE * (quick ? 1 : 10);
+    const double seconds = static_cast<double>(frames) / SAMPLE_RATE;
+    const auto available = media::availableAudioKernels();
+    NEAPU_CHECK(!available.empty() && std::string(available.front().name) == media::scalarAudioKernels().name);
+
+    for (int inChannels : {6, 8}) {
+        AVChannelLayout inLayout{};
+        av_channel_layout_default(&inLayout, inChannels);
+        std::vector<float> matrix;
+        const int ret = media::buildMixMatrix(inLayout, OUT_CHANNELS, matrix);
+        av_channel_layout_uninit(&inLayout);
+        NEAPU_CHECK_MSG(ret >= 0 && matrix.size() == static_cast<size_t>(OUT_CHANNELS) * inChannels,
+            "failed to build %d -> %d channel matrix", inChannels, OUT_CHANNELS);
+        if (ret < 0 || matrix.size() != static_cast<size_t>(OUT_CHANNELS) * inChannels) {
+            continue;
+        }
+        for (int o = 0; o < OUT_CHANNELS; o++) {
+            float gain = 0.0f;
+            for (int i = 0; i < inChannels; i++) {
+                gain += std::abs(matrix[static_cast<size_t>(o) * inChannels + i]);
+            }
+            // 归一化后不会削波；默认布局第4路为 LFE，下混时丢弃
+            NEAPU_CHECK_MSG(gain <= 1.0f + 1e-5f, "row %d gain %.6f", o, gain);
+            NEAPU_CHECK(matrix[static_cast<size_t>(o) * inChannels + 3] == 0.0f);
+        }
+
+        const auto src = makeSignal(inChannels, frames, static_cast<uint32_t>(inChannels));
+        const size_t outSamples = static_cast<size_t>(frames) * OUT_CHANNELS;
+        std::vector<float> reference(outSamples);
+        std::vector<int16_t> referenceS16(outSamples);
+        mixWithKernels(media::scalarAudioKernels(), src, inChannels, matrix, reference.data(), referenceS16.data());
+        std::vector<float> mixed(outSamples);
+        std::vector<int16_t> mixedS16(outSamples);
+
+        std::printf("%d -> %d channels, %.0f s at %d Hz, us per second of audio (realtime factor)\n",
+            inChannels, OUT_CHANNELS, seconds, SAMPLE_RATE);
+        std::printf("  %-12s %20s %20s\n", "mixer", "float out", "s16 out");
+        auto cell = [seconds](double us) {
+            char text[32];
+            const double perSecondUs = us / seconds;
+            std::snprintf(text, sizeof(text), "%.1f (%.0fx)", perSecondUs, perSecondUs > 0 ? 1e6 / perSecondUs : 0.0);
+            return std::string(text);
+        };
+
+        SwrContext* swrFloat = createSwrMixer(inChannels, matrix, AV_SAMPLE_FMT_FLT);
+        SwrContext* swrS16 = createSwrMixer(inChannels, matrix, AV_SAMPLE_FMT_S16);
+        NEAPU_CHECK(swrFloat != nullptr && swrS16 != nullptr);
+        if (swrFloat && swrS16) {
+            bool ok = true;
+            const double floatUs = test::measureAverageUs([&]() {
+                ok = mixWithSwr(swrFloat, src, inChannels, mixed.data(), sizeof(float)) && ok;
+            }, minDurationUs);
+            const double s16Us = test::measureAverageUs([&]() {
+                ok = mixWithSwr(swrS16, src, inChannels, mixedS16.data(), sizeof(int16_t)) && ok;
+            }, minDurationUs);
+            NEAPU_CHECK(ok);
+            // swr 内部的累加顺序和舍入方式不同，只要求误差在 float 精度和 1 LSB 以内
+            const double floatDiff = maxDiff(mixed, reference);
+            const double s16Diff = maxDiff(mixedS16, referenceS16);
+            NEAPU_CHECK_MSG(floatDiff <= 1e-5, "swr float max diff %g", floatDiff);
+            NEAPU_CHECK_MSG(s16Diff <= 1.0, "swr s16 max diff %g", s16Diff);
+            std::printf("  %-12s %20s %20s\n", "swr", cell(floatUs).c_str(), cell(s16Us).c_str());
+        }
+        swr_free(&swrFloat);
+        swr_free(&swrS16);
+
+        for (const auto& kernels : available) {
+            const double floatUs = test::measureAverageUs([&]() {
+                mixWithKernels(kernels, src, inChannels, matrix, mixed.data(), nullptr);
+            }, minDurationUs);
+            const double s16Us = test::measureAverageUs([&]() {
+                mixWithKernels(kernels, src, inChannels, matrix, mixed.data(), mixedS16.data());
+            }, minDurationUs);
+            const double floatDiff = maxDiff(mixed, reference);
+            const double s16Diff = maxDiff(mixedS16, referenceS16);
+            NEAPU_CHECK_MSG(floatDiff <= 1e-6, "%s float max diff %g", kernels.name, floatDiff);
+            NEAPU_CHECK_MSG(s16Diff <= 1.0, "%s s16 max diff %g", kernels.name, s16Diff);
+            // 同一输入的格式转换必须逐位一致
+            kernels.floatToS16(reference.data(), mixedS16.data(), static_cast<int>(outSamples));
+            NEAPU_CHECK_MSG(mixedS16 == referenceS16, "%s floatToS16 differs from scalar", kernels.name);
+            std::printf("  %-12s %20s %20s\n", kernels.name, cell(floatUs).c_str(), cell(s16Us).c_str());
+        }
+    }
+    return test::testResult();
+}
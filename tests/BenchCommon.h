@@ -0,0 +1,108 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// 基准程序共用的计时工具。ctest 以 --quick 运行，只验证能跑通；完整数据直接运行可执行文件
+
+namespace test {
+
+inline int64_t wallTimeUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 进程所有线程累计的CPU时间（用户态+内核态）
+inline int64_t cpuTimeUs()
+{
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        return 0;
+    }
+    auto toUs = [](const FILETIME& t) {
+        return static_cast<int64_t>((static_cast<uint64_t>(t.dwHighDateTime) << 32) | t.dwLowDateTime) / 10;
+    };
+    return toUs(kernel) + toUs(user);
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    auto toUs = [](const timeval& t) { return static_cast<int64_t>(t.tv_sec) * 1'000'000 + t.tv_usec; };
+    return toUs(usage.ru_utime) + toUs(usage.ru_stime);
+#endif
+}
+
+inline bool isQuickMode(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 第一个不以 -- 开头的参数，用于指定外部媒体文件代替生成的片段
+inline const char* positionalArg(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--", 2) != 0) {
+            return argv[i];
+        }
+    }
+    return nullptr;
+}
+
+struct Summary {
+    int64_t min{0};
+    int64_t median{0};
+    int64_t p95{0};
+    int64_t max{0};
+};
+
+inline Summary summarize(std::vector<int64_t> samples)
+{
+    Summary summary;
+    if (samples.empty()) {
+        return summary;
+    }
+    std::sort(samples.begin(), samples.end());
+    summary.min = samples.front();
+    summary.median = samples[samples.size() / 2];
+    summary.p95 = samples[std::min(samples.size() - 1, samples.size() * 95 / 100)];
+    summary.max = samples.back();
+    return summary;
+}
+
+// 重复运行 fn 直到累计耗时超过 minDurationUs，返回每次调用的平均耗时（微秒）
+template <typename Fn>
+double measureAverageUs(Fn&& fn, int64_t minDurationUs)
+{
+    fn(); // 预热缓存和分支预测
+    int64_t iterations = 0;
+    const int64_t startUs = wallTimeUs();
+    int64_t elapsedUs = 0;
+    do {
+        fn();
+        iterations++;
+        elapsedUs = wallTimeUs() - startUs;
+    } while (elapsedUs < minDurationUs);
+    return static_cast<double>(elapsedUs) / static_cast<double>(iterations);
+}
+
+} // namespace test
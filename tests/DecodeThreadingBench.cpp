@@ -0,0 +1,113 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+// 解码线程数扫描：同一片段分别用1~16个线程和自动设置完整解码一遍，
+// 对比吞吐、CPU时间和相对单线程的加速比，用于验证 resolveDecodeThreadSettings 的自动取值。
+// 本机缺少某种编码器时跳过该编码，内置的MPEG-4总会运行；可传入外部文件代替生成的片段
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BenchCommon.h"
+#include "TestCommon.h"
+#include "TestMedia.h"
+#include "media/DecodeThreading.h"
+#include "media/FrameReader.h"
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+struct DecodeResult {
+    int frames{0};
+    int64_t wallUs{0};
+    int64_t cpuUs{0};
+};
+
+static DecodeResult decodeAll(const std::string& url, int threadCount)
+{
+    DecodeResult result;
+    media::FrameReader reader(url, media::FrameReader::MediaType::Video, threadCount);
+    const int64_t wallStartUs = test::wallTimeUs();
+    const int64_t cpuStartUs = test::cpuTimeUs();
+    while (reader.readFrame()) {
+        result.frames++;
+    }
+    result.wallUs = test::wallTimeUs() - wallStartUs;
+    result.cpuUs = test::cpuTimeUs() - cpuStartUs;
+    return result;
+}
+
+static const char* threadTypeName(int threadType)
+{
+    switch (threadType) {
+    case FF_THREAD_FRAME: return "frame";
+    case FF_THREAD_SLICE: return "slice";
+    default: return "no";
+    }
+}
+
+static void describeAuto(const std::string& url)
+{
+    media::FrameReader reader(url, media::FrameReader::MediaType::Video);
+    const AVCodecParameters* codecpar = reader.stream()->codecpar;
+    const auto settings = media::resolveDecodeThreadSettings({}, avcodec_find_decoder(codecpar->codec_id),
+        codecpar->width, codecpar->height, static_cast<int>(std::thread::hardware_concurrency()));
+    std::printf("  auto resolves to %d thread(s), %s threading\n", settings.threadCount, threadTypeName(settings.threadType));
+}
+
+static void sweep(const std::string& label, const std::string& url)
+{
+    std::printf("%s: %s\n", label.c_str(), url.c_str());
+    describeAuto(url);
+    const int maxThreads = std::max(2, static_cast<int>(std::thread::hardware_concurrency()) * 2);
+    std::vector<int> counts;
+    for (int count = 1; count <= std::min(16, maxThreads); count *= 2) {
+        counts.push_back(count);
+    }
+    counts.push_back(0); // 自动
+
+    std::printf("  %-8s %8s %10s %10s %8s\n", "threads", "fps", "wall ms", "cpu ms", "speedup");
+    DecodeResult single;
+    for (int count : counts) {
+        const auto result = decodeAll(url, count);
+        if (count == 1) {
+            single = result;
+        }
+        // 线程数只影响速度，输出帧数必须一致
+        NEAPU_CHECK_MSG(result.frames == single.frames && result.frames > 0,
+            "%d thread(s) decoded %d frames, single thread decoded %d", count, result.frames, single.frames);
+        const double fps = result.wallUs > 0 ? result.frames * 1e6 / static_cast<double>(result.wallUs) : 0.0;
+        const double speedup = result.wallUs > 0 ? static_cast<double>(single.wallUs) / static_cast<double>(result.wallUs) : 0.0;
+        std::printf("  %-8s %8.1f %10.1f %10.1f %7.2fx\n", count == 0 ? "auto" : std::to_string(count).c_str(),
+            fps, result.wallUs / 1e3, result.cpuUs / 1e3, speedup);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    test::initTestLogging();
+    const bool quick = test::isQuickMode(argc, argv);
+    if (const char* url = test::positionalArg(argc, argv)) {
+        sweep("input", url);
+        return test::testResult();
+    }
+
+    test::ClipSpec spec;
+    spec.width = quick ? 640 : 1920;
+    spec.height = quick ? 360 : 1080;
+    spec.durationSec = quick ? 1 : 5;
+    for (auto codec : {test::VideoCodec::H264, test::VideoCodec::HEVC, test::VideoCodec::AV1, test::VideoCodec::MPEG4}) {
+        spec.codec = codec;
+        const std::string url = test::makeClip(spec);
+        if (url.empty()) {
+            std::printf("%s: no encoder available, skipped\n", test::videoCodecName(codec));
+            continue;
+        }
+        sweep(test::videoCodecName(codec), url);
+    }
+    return test::testResult();
+}
@@ -0,0 +1,116 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+// 显示尺寸感知解码的收益：大画面片段在小渲染区域中实时播放，分别关闭和开启 displaySizeAwareDecoding，
+// 对比播放期间进程的CPU时间和交给渲染端的帧数据量（上传带宽）。
+// H.264 走 sws 缩小，MPEG-4 的软件解码器支持 lowres，走解码器内部降分辨率
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include "BenchCommon.h"
+#include "TestCommon.h"
+#include "TestMedia.h"
+#include "media/Metrics.h"
+#include "media/Player.h"
+
+constexpr int RENDER_WIDTH = 640;
+constexpr int RENDER_HEIGHT = 360;
+
+struct PlaybackResult {
+    int frames{0};
+    int maxWidth{0};
+    int64_t bytes{0};
+    int64_t cpuUs{0};
+    int64_t wallUs{0};
+};
+
+static PlaybackResult play(const std::string& url, bool displaySizeAware)
+{
+    PlaybackResult result;
+    auto& player = media::Player::instance();
+    media::Player::OpenParam param;
+    param.url = url;
+    param.swDecodeOnly = true; // 硬件零拷贝路径不受该选项影响
+    param.displaySizeAwareDecoding = displaySizeAware;
+    std::atomic_bool finished{false};
+    param.onPlayFinished = [&finished]() { finished = true; };
+    player.setRenderSize(RENDER_WIDTH, RENDER_HEIGHT);
+    if (!player.open(param)) {
+        NEAPU_CHECK_MSG(false, "failed to open %s", url.c_str());
+        return result;
+    }
+    const int64_t timeoutUs = static_cast<int64_t>(player.durationSeconds() * 1e6) + 5'000'000;
+    const int64_t wallStartUs = test::wallTimeUs();
+    const int64_t cpuStartUs = test::cpuTimeUs();
+    player.play();
+    // 播完一遍，按渲染端的节奏取帧
+    while (!finished && test::wallTimeUs() - wallStartUs < timeoutUs) {
+        if (auto frame = player.getVideoFrame()) {
+            result.frames++;
+            result.bytes += static_cast<int64_t>(frame->dataSize());
+            result.maxWidth = std::max(result.maxWidth, frame->width());
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    result.cpuUs = test::cpuTimeUs() - cpuStartUs;
+    result.wallUs = test::wallTimeUs() - wallStartUs;
+    player.close();
+    return result;
+}
+
+static void compare(const std::string& label, const std::string& url, int sourceWidth)
+{
+    auto& metrics = media::Metrics::instance();
+    metrics.reset();
+    const auto full = play(url, false);
+    metrics.reset();
+    const auto aware = play(url, true);
+    const int64_t lowres = metrics.value("video.lowres.level");
+    const int64_t savedBytes = metrics.value("video.downscale.saved_bytes");
+
+    NEAPU_CHECK(full.frames > 0 && aware.frames > 0);
+    NEAPU_CHECK_MSG(full.maxWidth == sourceWidth, "%s without display-size awareness delivered width %d", label.c_str(), full.maxWidth);
+    // 不小于渲染尺寸，但明显小于源尺寸
+    NEAPU_CHECK_MSG(aware.maxWidth >= RENDER_WIDTH && aware.maxWidth < sourceWidth,
+        "%s with display-size awareness delivered width %d", label.c_str(), aware.maxWidth);
+    if (full.frames == 0 || aware.frames == 0) {
+        return;
+    }
+    const double fullBytesPerFrame = static_cast<double>(full.bytes) / full.frames;
+    const double awareBytesPerFrame = static_cast<double>(aware.bytes) / aware.frames;
+    std::printf("%s (%d px wide into %dx%d):\n", label.c_str(), sourceWidth, RENDER_WIDTH, RENDER_HEIGHT);
+    std::printf("  off: %d frames, %.1f KB/frame, cpu %.1f ms (%.1f%% of one core)\n", full.frames,
+        fullBytesPerFrame / 1024, full.cpuUs / 1e3, 100.0 * full.cpuUs / full.wallUs);
+    std::printf("  on:  %d frames, %.1f KB/frame, cpu %.1f ms (%.1f%% of one core), width %d, lowres %lld\n",
+        aware.frames, awareBytesPerFrame / 1024, aware.cpuUs / 1e3, 100.0 * aware.cpuUs / aware.wallUs,
+        aware.maxWidth, static_cast<long long>(lowres));
+    std::printf("  saved: %.1f%% frame bytes, %.1f%% cpu, video.downscale.saved_bytes %.1f MB\n",
+        100.0 * (1.0 - awareBytesPerFrame / fullBytesPerFrame),
+        100.0 * (1.0 - static_cast<double>(aware.cpuUs) / static_cast<double>(full.cpuUs)), savedBytes / 1048576.0);
+}
+
+int main(int argc, char* argv[])
+{
+    test::initTestLogging();
+    const bool quick = test::isQuickMode(argc, argv);
+    test::ClipSpec spec;
+    spec.width = quick ? 1920 : 3840;
+    spec.height = quick ? 1080 : 2160;
+    spec.durationSec = quick ? 2 : 8;
+    for (auto codec : {test::VideoCodec::H264, test::VideoCodec::MPEG4}) {
+        spec.codec = codec;
+        const std::string url = test::makeClip(spec);
+        if (url.empty()) {
+            std::printf("%s: no encoder available, skipped\n", test::videoCodecName(codec));
+            continue;
+        }
+        compare(test::videoCodecName(codec), url, spec.width);
+    }
+    media::Player::instance().shutdown();
+    return test::testResult();
+}
@@ -0,0 +1,194 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+// 硬解探测缓存测试，不依赖显卡：
+// 1. 缓存本身：查找、写入、过期、持久化、环境指纹或文件头不符时整体失效；
+// 2. 与播放器的配合：同一片段打开两次，第一次探测的硬解结果写入缓存，
+//    第一次失败的方式（如无显卡机器上的硬解）第二次直接跳过
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include "TestCommon.h"
+#include "TestMedia.h"
+#include "media/HWProbeCache.h"
+#include "media/Metrics.h"
+#include "media/Player.h"
+#include "media/VideoDecoder.h"
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+using media::HWProbeCache;
+
+static std::string cachePath()
+{
+    std::error_code ec;
+    return (std::filesystem::temp_directory_path(ec) / "neapu-hwprobe-test.txt").string();
+}
+
+// 切换到空路径再切回来，强制从文件重新加载
+static void reload(HWProbeCache& cache, const std::string& path)
+{
+    cache.setStoragePath({});
+    cache.setStoragePath(path);
+}
+
+static void checkMakeKey()
+{
+    AVCodecParameters* codecpar = avcodec_parameters_alloc();
+    codecpar->codec_id = AV_CODEC_ID_HEVC;
+    codecpar->profile = 2;
+    codecpar->width = 3840;
+    codecpar->height = 2160;
+    codecpar->bits_per_raw_sample = 10;
+    const auto uhd = HWProbeCache::makeKey(codecpar, 3);
+    NEAPU_CHECK(uhd.codecId == AV_CODEC_ID_HEVC && uhd.profile == 2 && uhd.bitDepth == 10 && uhd.method == 3);
+
+    codecpar->width = 1920;
+    codecpar->height = 1080;
+    codecpar->bits_per_raw_sample = 0;
+    codecpar->format = AV_PIX_FMT_YUV420P;
+    const auto fullHd = HWProbeCache::makeKey(codecpar, 3);
+    NEAPU_CHECK(fullHd.bitDepth == 8);
+    NEAPU_CHECK(fullHd.resolutionClass < uhd.resolutionClass);
+    // 同一分辨率档内的尺寸共用一条记录
+    codecpar->width = 1280;
+    codecpar->height = 1080;
+    NEAPU_CHECK(HWProbeCache::makeKey(codecpar, 3) == fullHd);
+    avcodec_parameters_free(&codecpar);
+}
+
+static void checkCache()
+{
+    auto& cache = HWProbeCache::instance();
+    const std::string path = cachePath();
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    cache.setStoragePath(path);
+    cache.setTtlSeconds(3600);
+    cache.clear();
+
+    const HWProbeCache::Key okKey{AV_CODEC_ID_H264, 100, 1, 8, 3};
+    const HWProbeCache::Key failKey{AV_CODEC_ID_AV1, 0, 2, 10, 3};
+    NEAPU_CHECK(!cache.lookup(okKey).has_value());
+    cache.store(okKey, true);
+    cache.store(failKey, false);
+    NEAPU_CHECK(cache.lookup(okKey) == true);
+    NEAPU_CHECK(cache.lookup(failKey) == false);
+
+    // 持久化后重新加载
+    reload(cache, path);
+    NEAPU_CHECK(cache.lookup(okKey) == true);
+    NEAPU_CHECK(cache.lookup(failKey) == false);
+
+    // 结果改变时覆盖
+    cache.store(failKey, true);
+    reload(cache, path);
+    NEAPU_CHECK(cache.lookup(failKey) == true);
+
+    // 过期的记录不返回
+    cache.setTtlSeconds(-1);
+    NEAPU_CHECK(!cache.lookup(okKey).has_value());
+    cache.setTtlSeconds(3600);
+    cache.store(okKey, true);
+
+    // 环境指纹不符（FFmpeg 或驱动升级）时整个文件失效
+    {
+        std::ifstream in(path);
+        std::string header, fingerprint, rest, line;
+        std::getline(in, header);
+        std::getline(in, fingerprint);
+        NEAPU_CHECK(fingerprint == "fingerprint " + HWProbeCache::environmentFingerprint());
+        while (std::getline(in, line)) {
+            rest += line + "\n";
+        }
+        in.close();
+        std::ofstream out(path, std::ios::trunc);
+        out << header << "\n" << "fingerprint other-driver\n" << rest;
+    }
+    reload(cache, path);
+    NEAPU_CHECK(!cache.lookup(okKey).has_value());
+
+    // 文件头不符时忽略
+    {
+        std::ofstream out(path, std::ios::trunc);
+        out << "garbage\n";
+    }
+    reload(cache, path);
+    NEAPU_CHECK(!cache.lookup(okKey).has_value());
+    cache.clear();
+}
+
+static void checkPlayerProbe(const std::string& url)
+{
+    using Method = media::VideoDecoder::HWAccelMethod;
+#ifdef _WIN32
+    const Method firstMethod = Method::D3D11VA;
+#elif defined(__linux__)
+    const Method firstMethod = Method::Vaapi;
+#elif defined(__APPLE__)
+    const Method firstMethod = Method::VideoToolBox;
+#else
+    const Method firstMethod = Method::None;
+#endif
+    auto& cache = HWProbeCache::instance();
+    auto& metrics = media::Metrics::instance();
+    auto& player = media::Player::instance();
+    media::Player::OpenParam param;
+    param.url = url;
+    param.hwProbeCachePath = cachePath();
+    param.warmDecoderPoolSize = 0; // 每次都走完整的探测
+
+    int64_t probeUs[2] = {};
+    for (int i = 0; i < 2; i++) {
+        metrics.reset();
+        NEAPU_CHECK(player.open(param));
+        probeUs[i] = metrics.value("open.video_probe_us");
+        if (i == 1 && firstMethod != Method::None) {
+            // 第一次失败的硬解方式，第二次由缓存跳过
+            AVFormatContext* fmtCtx = nullptr;
+            std::optional<bool> cached;
+            if (avformat_open_input(&fmtCtx, url.c_str(), nullptr, nullptr) >= 0) {
+                if (avformat_find_stream_info(fmtCtx, nullptr) >= 0 && fmtCtx->nb_streams > 0) {
+                    cached = cache.lookup(HWProbeCache::makeKey(fmtCtx->streams[0]->codecpar, static_cast<int>(firstMethod)));
+                }
+                avformat_close_input(&fmtCtx);
+            }
+            NEAPU_CHECK_MSG(cached.has_value(), "probe result of hw method %d was not cached", static_cast<int>(firstMethod));
+            if (cached == false) {
+                NEAPU_CHECK(metrics.value("hwprobe.cache_skip") > 0);
+            }
+            std::printf("hw method %d cached as %s\n", static_cast<int>(firstMethod),
+                !cached.has_value() ? "missing" : *cached ? "supported" : "unsupported");
+        }
+        player.close();
+    }
+    std::printf("video probe: first open %.2f ms, second open %.2f ms\n", probeUs[0] / 1e3, probeUs[1] / 1e3);
+    player.shutdown();
+    cache.clear();
+    std::error_code ec;
+    std::filesystem::remove(cachePath(), ec);
+}
+
+int main()
+{
+    test::initTestLogging();
+    checkMakeKey();
+    checkCache();
+
+    test::ClipSpec spec;
+    spec.width = 640;
+    spec.height = 360;
+    spec.durationSec = 1;
+    const std::string url = test::makeClipOrFallback(spec);
+    NEAPU_CHECK(!url.empty());
+    if (!url.empty()) {
+        checkPlayerProbe(url);
+    }
+    return test::testResult();
+}
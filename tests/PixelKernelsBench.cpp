@@ -0,0 +1,94 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+// 像素转换内核基准：1080p 和 4K 下每种源格式转 YUV420P 的每帧耗时，
+// 对比 sws 单线程、sws 条带多线程（swsThreadCount）和本机支持的每个内核实现
+
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+#include "BenchCommon.h"
+#include "TestCommon.h"
+#include "TestFrame.h"
+#include "media/PixelConverter.h"
+#include "media/PixelKernels.h"
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+}
+
+static double measureSws(const AVFrame* src, AVFrame* dst, int threads, int64_t minDurationUs)
+{
+    SwsContext* ctx = sws_alloc_context();
+    NEAPU_CHECK(ctx != nullptr);
+    if (!ctx) {
+        return 0.0;
+    }
+    ctx->src_w = src->width;
+    ctx->src_h = src->height;
+    ctx->src_format = static_cast<AVPixelFormat>(src->format);
+    ctx->dst_w = dst->width;
+    ctx->dst_h = dst->height;
+    ctx->dst_format = static_cast<AVPixelFormat>(dst->format);
+    ctx->flags = SWS_BILINEAR;
+    ctx->threads = threads;
+    double timeUs = 0.0;
+    if (sws_init_context(ctx, nullptr, nullptr) >= 0) {
+        timeUs = test::measureAverageUs([&]() { sws_scale_frame(ctx, dst, src); }, minDurationUs);
+    } else {
+        NEAPU_CHECK_MSG(false, "failed to create sws context for %s", av_get_pix_fmt_name(static_cast<AVPixelFormat>(src->format)));
+    }
+    sws_freeContext(ctx);
+    return timeUs;
+}
+
+int main(int argc, char* argv[])
+{
+    test::initTestLogging();
+    const bool quick = test::isQuickMode(argc, argv);
+    const int64_t minDurationUs = quick ? 30'000 : 500'000;
+    std::vector<std::pair<int, int>> resolutions = {{1920, 1080}};
+    if (!quick) {
+        resolutions.emplace_back(3840, 2160);
+    }
+    const auto available = media::availablePixelKernels();
+
+    for (auto [width, height] : resolutions) {
+        std::printf("%dx%d, ms per frame (speedup over sws single thread)\n", width, height);
+        std::printf("  %-10s %10s %16s", "source", "sws 1T", "sws sliced");
+        for (const auto& kernels : available) {
+            std::printf(" %16s", kernels.name);
+        }
+        std::printf("\n");
+        for (auto format : {AV_PIX_FMT_NV12, AV_PIX_FMT_P010LE, AV_PIX_FMT_YUV422P}) {
+            auto src = test::makeTestFrame(format, width, height, 3);
+            auto dst = test::makeTestFrame(AV_PIX_FMT_YUV420P, width, height, 0, 0, 0);
+            NEAPU_CHECK(src != nullptr && dst != nullptr);
+            if (!src || !dst) {
+                continue;
+            }
+            const double swsUs = measureSws(src->avFrame(), dst->avFrame(), 1, minDurationUs);
+            const int sliceThreads = media::swsThreadCount(width, height);
+            const double slicedUs = measureSws(src->avFrame(), dst->avFrame(), sliceThreads, minDurationUs);
+            auto cell = [swsUs](double us) {
+                char text[32];
+                std::snprintf(text, sizeof(text), "%.3f (%.1fx)", us / 1e3, us > 0 ? swsUs / us : 0.0);
+                return std::string(text);
+            };
+            std::printf("  %-10s %10.3f %16s", av_get_pix_fmt_name(format), swsUs / 1e3, cell(slicedUs).c_str());
+            for (const auto& kernels : available) {
+                bool ok = true;
+                const double us = test::measureAverageUs([&]() {
+                    ok = media::fastConvertPlanes(src->avFrame(), dst->avFrame(), kernels) && ok;
+                }, minDurationUs);
+                NEAPU_CHECK(ok);
+                std::printf(" %16s", cell(us).c_str());
+            }
+            std::printf("\n");
+        }
+    }
+    return test::testResult();
+}
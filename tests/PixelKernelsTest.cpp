@@ -0,0 +1,177 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+// 像素转换内核测试：
+// 1. 本机支持的每个SIMD实现与标量实现逐位一致，覆盖各种宽度（含SIMD尾部）、非对齐指针和饱和边界；
+// 2. fastConvert 的结果与 sws（SWS_BILINEAR，原先的转换路径）相比在以下误差内：
+//    NV12 为0（纯拷贝）；P010 为1（内核四舍五入，sws 转8位时加有序抖动）；
+//    4:2:2 为2（内核两行平均，sws 的垂直色度滤波权重不同，只在平滑画面上成立）
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+#include "TestCommon.h"
+#include "TestFrame.h"
+#include "media/PixelConverter.h"
+#include "media/PixelKernels.h"
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+}
+
+using media::PixelKernels;
+
+// 非对齐偏移，覆盖SIMD的非对齐加载和存储
+constexpr int MISALIGN = 1;
+
+static std::vector<int> testWidths()
+{
+    std::vector<int> widths;
+    for (int width = 1; width <= 80; width++) {
+        widths.push_back(width);
+    }
+    for (int width : {127, 128, 129, 960, 961, 1920, 1921, 3840}) {
+        widths.push_back(width);
+    }
+    return widths;
+}
+
+static void checkKernels(const PixelKernels& kernels, const PixelKernels& scalar)
+{
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<int> word(0, 0xFFFF);
+    for (int width : testWidths()) {
+        std::vector<uint8_t> src8(2 * width + MISALIGN);
+        std::vector<uint8_t> other8(width + MISALIGN);
+        std::vector<uint16_t> src16(2 * width + MISALIGN);
+        for (auto& v : src8) {
+            v = static_cast<uint8_t>(byte(rng));
+        }
+        for (auto& v : other8) {
+            v = static_cast<uint8_t>(byte(rng));
+        }
+        for (size_t i = 0; i < src16.size(); i++) {
+            // 一半随机值，一半贴近上限，覆盖四舍五入后的饱和
+            src16[i] = static_cast<uint16_t>(i % 2 ? word(rng) : 0xFF00 + (word(rng) & 0xFF));
+        }
+        std::vector<uint8_t> expectU(width + MISALIGN), expectV(width + MISALIGN);
+        std::vector<uint8_t> actualU(width + MISALIGN), actualV(width + MISALIGN);
+        auto compare = [&](const char* kernel, int offset, bool checkV) {
+            bool equal = std::memcmp(expectU.data() + offset, actualU.data() + offset, width) == 0;
+            if (checkV) {
+                equal = equal && std::memcmp(expectV.data() + offset, actualV.data() + offset, width) == 0;
+            }
+            NEAPU_CHECK_MSG(equal, "%s %s differs from scalar at width %d, offset %d", kernels.name, kernel, width, offset);
+        };
+
+        for (int offset : {0, MISALIGN}) {
+            scalar.deinterleaveUV8(src8.data() + offset, expectU.data() + offset, expectV.data() + offset, width);
+            kernels.deinterleaveUV8(src8.data() + offset, actualU.data() + offset, actualV.data() + offset, width);
+            compare("deinterleaveUV8", offset, true);
+
+            scalar.deinterleaveUV16To8(src16.data() + offset, expectU.data() + offset, expectV.data() + offset, width);
+            kernels.deinterleaveUV16To8(src16.data() + offset, actualU.data() + offset, actualV.data() + offset, width);
+            compare("deinterleaveUV16To8", offset, true);
+
+            scalar.narrow16To8(src16.data() + offset, expectU.data() + offset, width);
+            kernels.narrow16To8(src16.data() + offset, actualU.data() + offset, width);
+            compare("narrow16To8", offset, false);
+
+            scalar.averageRows8(src8.data() + offset, other8.data() + offset, expectU.data() + offset, width);
+            kernels.averageRows8(src8.data() + offset, other8.data() + offset, actualU.data() + offset, width);
+            compare("averageRows8", offset, false);
+        }
+    }
+}
+
+static void checkScalarRounding()
+{
+    // 标量实现本身的约定：P010 四舍五入到8位并饱和，两行平均向上取整
+    const uint16_t src[] = {0x0000, 0x007F, 0x0080, 0x3FC0, 0xFF7F, 0xFF80, 0xFFC0};
+    const uint8_t expect[] = {0x00, 0x00, 0x01, 0x40, 0xFF, 0xFF, 0xFF};
+    uint8_t dst[7] = {};
+    media::scalarPixelKernels().narrow16To8(src, dst, 7);
+    NEAPU_CHECK(std::memcmp(dst, expect, sizeof(expect)) == 0);
+
+    const uint8_t a[] = {0, 1, 254, 255};
+    const uint8_t b[] = {1, 1, 255, 255};
+    uint8_t avg[4] = {};
+    media::scalarPixelKernels().averageRows8(a, b, avg, 4);
+    NEAPU_CHECK(avg[0] == 1 && avg[1] == 1 && avg[2] == 255 && avg[3] == 255);
+}
+
+static media::FramePtr convertWithSws(const AVFrame* src)
+{
+    auto dst = std::make_unique<media::Frame>(media::Frame::FrameType::Normal, 0);
+    dst->avFrame()->format = AV_PIX_FMT_YUV420P;
+    dst->avFrame()->width = src->width;
+    dst->avFrame()->height = src->height;
+    SwsContext* ctx = sws_getContext(src->width, src->height, static_cast<AVPixelFormat>(src->format),
+        src->width, src->height, AV_PIX_FMT_YUV420P, SWS_BILINEAR, nullptr, nullptr, nullptr);
+    const bool ok = ctx && av_frame_get_buffer(dst->avFrame(), 32) >= 0 && sws_scale_frame(ctx, dst->avFrame(), src) >= 0;
+    sws_freeContext(ctx);
+    return ok ? std::move(dst) : nullptr;
+}
+
+static void checkFrames(AVPixelFormat format, int width, int height, int swsTolerance)
+{
+    auto src = test::makeTestFrame(format, width, height, 7);
+    NEAPU_CHECK(src != nullptr);
+    if (!src) {
+        return;
+    }
+    media::FramePtr scalarOutput;
+    for (const auto& kernels : media::availablePixelKernels()) {
+        auto dst = test::makeTestFrame(AV_PIX_FMT_YUV420P, width, height, 0, 0, 0);
+        NEAPU_CHECK(dst != nullptr && media::fastConvertPlanes(src->avFrame(), dst->avFrame(), kernels));
+        if (!dst) {
+            continue;
+        }
+        if (!scalarOutput) {
+            scalarOutput = std::move(dst);
+            continue;
+        }
+        const auto diff = test::compareFrames(scalarOutput->avFrame(), dst->avFrame());
+        NEAPU_CHECK_MSG(diff.maxDiff == 0, "%s %dx%d frame from %s differs from scalar by up to %d",
+            av_get_pix_fmt_name(format), width, height, kernels.name, diff.maxDiff);
+    }
+
+    auto swsOutput = convertWithSws(src->avFrame());
+    NEAPU_CHECK(swsOutput != nullptr && scalarOutput != nullptr);
+    if (swsOutput && scalarOutput) {
+        const auto diff = test::compareFrames(swsOutput->avFrame(), scalarOutput->avFrame());
+        std::printf("%-12s %dx%d vs sws: max %d, mean %.4f (tolerance %d)\n",
+            av_get_pix_fmt_name(format), width, height, diff.maxDiff, diff.meanDiff, swsTolerance);
+        NEAPU_CHECK_MSG(diff.maxDiff <= swsTolerance, "%s %dx%d differs from sws by %d",
+            av_get_pix_fmt_name(format), width, height, diff.maxDiff);
+    }
+}
+
+int main()
+{
+    test::initTestLogging();
+    const auto available = media::availablePixelKernels();
+    std::printf("Available pixel kernels:");
+    for (const auto& kernels : available) {
+        std::printf(" %s", kernels.name);
+    }
+    std::printf(", selected %s\n", media::pixelKernels().name);
+    NEAPU_CHECK(std::strcmp(available.back().name, media::pixelKernels().name) == 0);
+
+    checkScalarRounding();
+    for (const auto& kernels : available) {
+        checkKernels(kernels, media::scalarPixelKernels());
+    }
+
+    for (auto [width, height] : {std::pair{1920, 1080}, std::pair{1366, 768}, std::pair{642, 362}}) {
+        checkFrames(AV_PIX_FMT_NV12, width, height, 0);
+        checkFrames(AV_PIX_FMT_P010LE, width, height, 1);
+        checkFrames(AV_PIX_FMT_YUV422P, width, height, 2);
+    }
+    return test::testResult();
+}
@@ -0,0 +1,98 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+// 播放列表切换延迟：在两个同编码的片段之间反复切换，从 open() 开始计时到取得第一帧画面，
+// 对比关闭解码器预热池（容量0）和默认容量4。首次打开是冷启动，不计入统计
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BenchCommon.h"
+#include "TestCommon.h"
+#include "TestMedia.h"
+#include "media/Metrics.h"
+#include "media/Player.h"
+
+constexpr int64_t FIRST_FRAME_TIMEOUT_US = 5'000'000;
+
+// 返回 open() 到第一帧的耗时，失败返回-1
+static int64_t switchTo(const media::Player::OpenParam& param)
+{
+    auto& player = media::Player::instance();
+    const int64_t startUs = test::wallTimeUs();
+    if (!player.open(param)) {
+        return -1;
+    }
+    player.play();
+    while (test::wallTimeUs() - startUs < FIRST_FRAME_TIMEOUT_US) {
+        if (player.getVideoFrame()) {
+            return test::wallTimeUs() - startUs;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+    return -1;
+}
+
+static void run(const std::vector<std::string>& urls, size_t poolSize, int switches)
+{
+    auto& player = media::Player::instance();
+    auto& metrics = media::Metrics::instance();
+    player.shutdown(); // 清空上一轮留下的预热解码器
+    metrics.reset();
+
+    media::Player::OpenParam param;
+    param.swDecodeOnly = true; // 只比较解码器复用，硬解探测另有缓存
+    param.warmDecoderPoolSize = poolSize;
+    std::vector<int64_t> firstFrameUs;
+    std::vector<int64_t> openUs;
+    for (int i = 0; i <= switches; i++) {
+        param.url = urls[i % urls.size()];
+        const int64_t latencyUs = switchTo(param);
+        NEAPU_CHECK_MSG(latencyUs >= 0, "no frame after switching to %s", param.url.c_str());
+        if (i > 0 && latencyUs >= 0) {
+            firstFrameUs.push_back(latencyUs);
+            openUs.push_back(metrics.value("open.total_us"));
+        }
+    }
+    player.close();
+    const int64_t hits = metrics.value("decoder_pool.hit");
+    if (poolSize > 0) {
+        // 两个片段交替，容量足够时从第三次打开起必然命中
+        NEAPU_CHECK_MSG(hits > 0, "warm decoder pool of size %zu was never hit", poolSize);
+    }
+
+    const auto firstFrame = test::summarize(firstFrameUs);
+    const auto open = test::summarize(openUs);
+    std::printf("pool %zu: first frame median %.2f ms, p95 %.2f ms; open() median %.2f ms, p95 %.2f ms; pool hits %lld\n",
+        poolSize, firstFrame.median / 1e3, firstFrame.p95 / 1e3, open.median / 1e3, open.p95 / 1e3,
+        static_cast<long long>(hits));
+}
+
+int main(int argc, char* argv[])
+{
+    test::initTestLogging();
+    const bool quick = test::isQuickMode(argc, argv);
+    test::ClipSpec spec;
+    spec.width = quick ? 640 : 1920;
+    spec.height = quick ? 360 : 1080;
+    std::vector<std::string> urls;
+    // 时长不同，两个独立的文件
+    for (int durationSec : {2, 3}) {
+        spec.durationSec = durationSec;
+        const std::string url = test::makeClipOrFallback(spec);
+        NEAPU_CHECK(!url.empty());
+        if (url.empty()) {
+            return test::testResult();
+        }
+        urls.push_back(url);
+    }
+
+    const int switches = quick ? 6 : 30;
+    run(urls, 0, switches);
+    run(urls, 4, switches);
+    media::Player::instance().shutdown();
+    return test::testResult();
+}
@@ -0,0 +1,154 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+// seek延迟：长GOP片段播放中反复跳到伪随机位置，从 seek() 开始计时到取得新位置的第一帧，
+// 分别统计快速seek和精确seek。每次seek前先正常播放一段，让解码队列处于填满状态，
+// 过期的解码工作能否及时取消直接体现在延迟上。同时检查首帧位置：
+// 精确seek为目标位置所在的帧，快速seek为目标之前的关键帧
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BenchCommon.h"
+#include "TestCommon.h"
+#include "TestMedia.h"
+#include "media/Metrics.h"
+#include "media/Player.h"
+
+constexpr int64_t FIRST_FRAME_TIMEOUT_US = 5'000'000;
+
+static media::FramePtr waitFrame(media::Player& player, int64_t startUs)
+{
+    while (test::wallTimeUs() - startUs < FIRST_FRAME_TIMEOUT_US) {
+        if (auto frame = player.getVideoFrame()) {
+            return frame;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+    return nullptr;
+}
+
+// 正常播放一段时间，持续取走到期的帧
+static void playFor(media::Player& player, int64_t durationUs)
+{
+    const int64_t startUs = test::wallTimeUs();
+    while (test::wallTimeUs() - startUs < durationUs) {
+        player.getVideoFrame();
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+}
+
+// 外部文件带音频时，播放时钟和seek完成都依赖音频被读出，这里代替音频设备回调按实时节奏读取
+class AudioPump {
+public:
+    explicit AudioPump(media::Player& player)
+        : m_thread([this, &player]() {
+            std::vector<float> buffer(1024 * 8);
+            while (m_running) {
+                player.readAudio(buffer.data(), 1024, 0);
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+        })
+    {
+    }
+    ~AudioPump()
+    {
+        m_running = false;
+        m_thread.join();
+    }
+
+private:
+    std::atomic_bool m_running{true};
+    std::thread m_thread;
+};
+
+// gopUs 为0表示关键帧间隔未知，不检查快速seek的首帧位置
+static void run(const std::string& url, media::Player::SeekMode mode, int seeks, int64_t gopUs)
+{
+    auto& player = media::Player::instance();
+    auto& metrics = media::Metrics::instance();
+    media::Player::OpenParam param;
+    param.url = url;
+    param.swDecodeOnly = true;
+    param.audioOutputChannels = 2;
+    if (!player.open(param)) {
+        NEAPU_CHECK_MSG(false, "failed to open %s", url.c_str());
+        return;
+    }
+    const bool accurate = mode == media::Player::SeekMode::Accurate;
+    const double duration = player.durationSeconds();
+    const int64_t frameDurationUs = player.fps() > 0 ? static_cast<int64_t>(1e6 / player.fps()) : 40'000;
+    std::mt19937 rng(accurate ? 2 : 1);
+    std::uniform_real_distribution<double> position(0.0, duration * 0.9);
+    std::vector<int64_t> latencyUs;
+    std::vector<int64_t> metricUs;
+    {
+        // 在 close() 之前停止读取音频
+        AudioPump audioPump(player);
+        player.play();
+        NEAPU_CHECK(waitFrame(player, test::wallTimeUs()) != nullptr);
+        for (int i = 0; i < seeks; i++) {
+            playFor(player, 200'000);
+            const double target = position(rng);
+            const auto targetUs = static_cast<int64_t>(target * 1e6);
+            metrics.set("seek.first_frame_us", -1);
+            const int64_t startUs = test::wallTimeUs();
+            player.seek(target, mode);
+            auto frame = waitFrame(player, startUs);
+            NEAPU_CHECK_MSG(frame != nullptr, "no frame after seeking to %.3f s", target);
+            if (!frame) {
+                continue;
+            }
+            latencyUs.push_back(test::wallTimeUs() - startUs);
+            metricUs.push_back(metrics.value("seek.first_frame_us"));
+            const int64_t ptsUs = frame->ptsUs();
+            if (accurate) {
+                NEAPU_CHECK_MSG(ptsUs > targetUs - frameDurationUs && ptsUs <= targetUs + frameDurationUs,
+                    "accurate seek to %lld us showed frame at %lld us", static_cast<long long>(targetUs), static_cast<long long>(ptsUs));
+            } else if (gopUs > 0) {
+                NEAPU_CHECK_MSG(ptsUs <= targetUs + frameDurationUs && ptsUs > targetUs - gopUs - frameDurationUs,
+                    "fast seek to %lld us showed frame at %lld us", static_cast<long long>(targetUs), static_cast<long long>(ptsUs));
+            }
+        }
+    }
+    player.close();
+
+    const auto latency = test::summarize(latencyUs);
+    const auto metric = test::summarize(metricUs);
+    std::printf("%-8s seek: median %.2f ms, p95 %.2f ms, max %.2f ms (seek.first_frame_us median %.2f ms)\n",
+        accurate ? "accurate" : "fast", latency.median / 1e3, latency.p95 / 1e3, latency.max / 1e3, metric.median / 1e3);
+}
+
+int main(int argc, char* argv[])
+{
+    test::initTestLogging();
+    const bool quick = test::isQuickMode(argc, argv);
+    test::ClipSpec spec;
+    spec.width = quick ? 640 : 1920;
+    spec.height = quick ? 360 : 1080;
+    // 长GOP让精确seek需要解码的帧数明显多于快速seek
+    spec.gopSize = quick ? 50 : 250;
+    spec.durationSec = quick ? 6 : 30;
+    std::string url;
+    int64_t gopUs = 0;
+    if (const char* input = test::positionalArg(argc, argv)) {
+        url = input;
+    } else {
+        url = test::makeClipOrFallback(spec);
+        gopUs = static_cast<int64_t>(spec.gopSize) * 1'000'000 / spec.frameRate;
+    }
+    NEAPU_CHECK(!url.empty());
+    if (url.empty()) {
+        return test::testResult();
+    }
+    const int seeks = quick ? 5 : 40;
+    run(url, media::Player::SeekMode::Fast, seeks, gopUs);
+    run(url, media::Player::SeekMode::Accurate, seeks, gopUs);
+    media::Player::instance().shutdown();
+    return test::testResult();
+}
@@ -0,0 +1,130 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+// sws 条带多线程：各分辨率下分别用单线程、swsThreadCount 的取值和全部核心转换同一帧，
+// 对比每帧耗时，并检查多线程输出与单线程逐位一致
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "BenchCommon.h"
+#include "TestCommon.h"
+#include "TestFrame.h"
+#include "media/PixelConverter.h"
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+}
+
+struct Resolution {
+    int width;
+    int height;
+};
+
+struct ConversionCase {
+    AVPixelFormat srcFormat;
+    AVPixelFormat dstFormat;
+    int scaleDown; // 输出尺寸为源的 1/scaleDown，对应显示尺寸感知解码的缩小
+};
+
+static SwsContext* createContext(const AVFrame* src, int dstWidth, int dstHeight, AVPixelFormat dstFormat, int threads)
+{
+    // 与 VideoDecoder::convertFixelFormat 的设置一致
+    SwsContext* ctx = sws_alloc_context();
+    if (!ctx) {
+        return nullptr;
+    }
+    ctx->src_w = src->width;
+    ctx->src_h = src->height;
+    ctx->src_format = static_cast<AVPixelFormat>(src->format);
+    ctx->dst_w = dstWidth;
+    ctx->dst_h = dstHeight;
+    ctx->dst_format = dstFormat;
+    ctx->flags = SWS_BILINEAR;
+    ctx->threads = threads;
+    if (sws_init_context(ctx, nullptr, nullptr) < 0) {
+        sws_freeContext(ctx);
+        return nullptr;
+    }
+    return ctx;
+}
+
+static media::FramePtr allocOutput(int width, int height, AVPixelFormat format)
+{
+    auto frame = std::make_unique<media::Frame>(media::Frame::FrameType::Normal, 0);
+    frame->avFrame()->format = format;
+    frame->avFrame()->width = width;
+    frame->avFrame()->height = height;
+    if (av_frame_get_buffer(frame->avFrame(), 32) < 0) {
+        return nullptr;
+    }
+    return frame;
+}
+
+int main(int argc, char* argv[])
+{
+    test::initTestLogging();
+    const bool quick = test::isQuickMode(argc, argv);
+    const int64_t minDurationUs = quick ? 50'000 : 500'000;
+    std::vector<Resolution> resolutions = {{1280, 720}, {1920, 1080}};
+    if (!quick) {
+        resolutions.push_back({2560, 1440});
+        resolutions.push_back({3840, 2160});
+    }
+    const ConversionCase cases[] = {
+        {AV_PIX_FMT_YUV420P10LE, AV_PIX_FMT_YUV420P, 1},
+        {AV_PIX_FMT_YUV444P, AV_PIX_FMT_YUV420P, 1},
+        {AV_PIX_FMT_NV12, AV_PIX_FMT_YUV420P, 2},
+    };
+    const int cpuCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    std::printf("%-10s %-28s %10s %14s %14s\n", "size", "conversion", "1 thread", "sliced", "all cores");
+    for (const auto& resolution : resolutions) {
+        for (const auto& conversion : cases) {
+            auto src = test::makeTestFrame(conversion.srcFormat, resolution.width, resolution.height, 1);
+            NEAPU_CHECK(src != nullptr);
+            if (!src) {
+                continue;
+            }
+            const int dstWidth = resolution.width / conversion.scaleDown;
+            const int dstHeight = resolution.height / conversion.scaleDown;
+            const int threadCounts[] = {1, media::swsThreadCount(resolution.width, resolution.height), cpuCount};
+
+            double timesUs[3] = {};
+            media::FramePtr reference;
+            for (int i = 0; i < 3; i++) {
+                SwsContext* ctx = createContext(src->avFrame(), dstWidth, dstHeight, conversion.dstFormat, threadCounts[i]);
+                auto dst = allocOutput(dstWidth, dstHeight, conversion.dstFormat);
+                NEAPU_CHECK(ctx != nullptr && dst != nullptr);
+                if (!ctx || !dst) {
+                    sws_freeContext(ctx);
+                    continue;
+                }
+                timesUs[i] = test::measureAverageUs([&]() { sws_scale_frame(ctx, dst->avFrame(), src->avFrame()); }, minDurationUs);
+                sws_freeContext(ctx);
+                if (i == 0) {
+                    reference = std::move(dst);
+                } else if (reference) {
+                    const auto diff = test::compareFrames(reference->avFrame(), dst->avFrame());
+                    NEAPU_CHECK_MSG(diff.maxDiff == 0, "%dx%d %s with %d threads differs from single thread by up to %d",
+                        resolution.width, resolution.height, av_get_pix_fmt_name(conversion.srcFormat), threadCounts[i], diff.maxDiff);
+                }
+            }
+
+            char size[16];
+            char name[64];
+            char sliced[32];
+            char all[32];
+            std::snprintf(size, sizeof(size), "%dx%d", resolution.width, resolution.height);
+            std::snprintf(name, sizeof(name), "%s->%s%s", av_get_pix_fmt_name(conversion.srcFormat),
+                av_get_pix_fmt_name(conversion.dstFormat), conversion.scaleDown > 1 ? " 1/2" : "");
+            std::snprintf(sliced, sizeof(sliced), "%.2f ms (%d)", timesUs[1] / 1e3, threadCounts[1]);
+            std::snprintf(all, sizeof(all), "%.2f ms (%d)", timesUs[2] / 1e3, threadCounts[2]);
+            std::printf("%-10s %-28s %7.2f ms %14s %14s\n", size, name, timesUs[0] / 1e3, sliced, all);
+        }
+    }
+    return test::testResult();
+}
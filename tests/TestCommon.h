@@ -0,0 +1,53 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+#include <cstdio>
+#include <logger.h>
+
+// 测试程序共用的检查宏：失败时打印位置并计数，不中断，main 最后用 testResult() 作为返回值
+
+namespace test {
+
+inline int& failureCount()
+{
+    static int count = 0;
+    return count;
+}
+
+// 测试只关心检查结果，媒体库的日志只打印警告以上
+inline void initTestLogging()
+{
+    neapu::Logger::setPrintLevel(NEAPU_LOG_LEVEL_WARNING);
+}
+
+inline int testResult()
+{
+    if (failureCount() > 0) {
+        std::printf("%d check(s) failed\n", failureCount());
+        return 1;
+    }
+    std::printf("All checks passed\n");
+    return 0;
+}
+
+} // namespace test
+
+#define NEAPU_CHECK(cond)                                                         \
+    do {                                                                          \
+        if (!(cond)) {                                                            \
+            std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++test::failureCount();                                               \
+        }                                                                         \
+    } while (0)
+
+#define NEAPU_CHECK_MSG(cond, ...)                                                \
+    do {                                                                          \
+        if (!(cond)) {                                                            \
+            std::printf("%s:%d: check failed: %s: ", __FILE__, __LINE__, #cond);  \
+            std::printf(__VA_ARGS__);                                             \
+            std::printf("\n");                                                    \
+            ++test::failureCount();                                               \
+        }                                                                         \
+    } while (0)
@@ -0,0 +1,116 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#include "TestFrame.h"
+#include <algorithm>
+#include <cstdlib>
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixdesc.h>
+}
+
+namespace test {
+namespace {
+// 分量在帧中的位置，按 AVPixFmtDescriptor 的描述访问
+struct Component {
+    const AVComponentDescriptor* desc;
+    int width;
+    int height;
+};
+
+Component componentOf(const AVPixFmtDescriptor* desc, const AVFrame* frame, int index)
+{
+    const bool chroma = index == 1 || index == 2;
+    const int shiftW = chroma ? desc->log2_chroma_w : 0;
+    const int shiftH = chroma ? desc->log2_chroma_h : 0;
+    return {&desc->comp[index], (frame->width + (1 << shiftW) - 1) >> shiftW, (frame->height + (1 << shiftH) - 1) >> shiftH};
+}
+
+int readSample(const AVFrame* frame, const AVComponentDescriptor& comp, int x, int y)
+{
+    const uint8_t* p = frame->data[comp.plane] + static_cast<ptrdiff_t>(y) * frame->linesize[comp.plane] +
+        static_cast<ptrdiff_t>(x) * comp.step + comp.offset;
+    const int raw = comp.depth > 8 ? *reinterpret_cast<const uint16_t*>(p) : *p;
+    return (raw >> comp.shift) & ((1 << comp.depth) - 1);
+}
+
+void writeSample(AVFrame* frame, const AVComponentDescriptor& comp, int x, int y, int value)
+{
+    uint8_t* p = frame->data[comp.plane] + static_cast<ptrdiff_t>(y) * frame->linesize[comp.plane] +
+        static_cast<ptrdiff_t>(x) * comp.step + comp.offset;
+    if (comp.depth > 8) {
+        *reinterpret_cast<uint16_t*>(p) = static_cast<uint16_t>(value << comp.shift);
+    } else {
+        *p = static_cast<uint8_t>(value);
+    }
+}
+
+int triangle(int value, int period)
+{
+    value %= period;
+    return value < period / 2 ? value : period - value;
+}
+} // namespace
+
+media::FramePtr makeTestFrame(int pixelFormat, int width, int height, uint32_t seed, int lumaNoise, int chromaNoise)
+{
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(pixelFormat));
+    if (!desc) {
+        return nullptr;
+    }
+    auto frame = std::make_unique<media::Frame>(media::Frame::FrameType::Normal, 0);
+    AVFrame* avFrame = frame->avFrame();
+    avFrame->format = pixelFormat;
+    avFrame->width = width;
+    avFrame->height = height;
+    if (av_frame_get_buffer(avFrame, 32) < 0) {
+        return nullptr;
+    }
+    for (int c = 0; c < desc->nb_components; c++) {
+        const auto component = componentOf(desc, avFrame, c);
+        const int depth = component.desc->depth;
+        const int maxValue = (1 << depth) - 1;
+        const int noise = (c == 0 ? lumaNoise : chromaNoise) << (depth - 8);
+        for (int y = 0; y < component.height; y++) {
+            for (int x = 0; x < component.width; x++) {
+                // 各分量沿不同方向渐变，周期取大值使相邻像素差很小
+                const int gradient = c == 0 ? triangle(x + y, 1024) : c == 1 ? triangle(x * 2, 1024) : triangle(y * 2, 1024);
+                int value = (32 + gradient * 3 / 8) << (depth - 8);
+                if (noise > 0) {
+                    seed = seed * 1664525u + 1013904223u;
+                    value += static_cast<int>(seed >> 16) % (2 * noise + 1) - noise;
+                }
+                writeSample(avFrame, *component.desc, x, y, std::clamp(value, 0, maxValue));
+            }
+        }
+    }
+    return frame;
+}
+
+FrameDiff compareFrames(const AVFrame* a, const AVFrame* b)
+{
+    FrameDiff diff;
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(a->format));
+    if (!desc || a->format != b->format || a->width != b->width || a->height != b->height) {
+        diff.maxDiff = INT32_MAX;
+        return diff;
+    }
+    int64_t total = 0;
+    int64_t count = 0;
+    for (int c = 0; c < desc->nb_components; c++) {
+        const auto component = componentOf(desc, a, c);
+        for (int y = 0; y < component.height; y++) {
+            for (int x = 0; x < component.width; x++) {
+                const int d = std::abs(readSample(a, *component.desc, x, y) - readSample(b, *component.desc, x, y));
+                diff.maxDiff = std::max(diff.maxDiff, d);
+                total += d;
+                count++;
+            }
+        }
+    }
+    diff.meanDiff = count > 0 ? static_cast<double>(total) / static_cast<double>(count) : 0.0;
+    return diff;
+}
+
+} // namespace test
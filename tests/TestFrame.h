@@ -0,0 +1,22 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+#include <cstdint>
+#include "media/Frame.h"
+
+namespace test {
+
+// 按像素格式描述分配并填充测试帧，支持平面和半平面格式，高位深格式按描述中的移位对齐（如P010高位对齐）。
+// 画面为平滑渐变，噪声幅度以8位为单位；色度不加噪声时渐变是线性的，便于和sws的滤波结果比较
+media::FramePtr makeTestFrame(int pixelFormat, int width, int height, uint32_t seed, int lumaNoise = 8, int chromaNoise = 0);
+
+struct FrameDiff {
+    int maxDiff{0};
+    double meanDiff{0.0};
+};
+// 逐分量比较两帧（同格式、同尺寸），差值以该格式的位深为单位
+FrameDiff compareFrames(const AVFrame* a, const AVFrame* b);
+
+} // namespace test
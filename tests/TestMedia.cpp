@@ -0,0 +1,243 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#include "TestMedia.h"
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <logger.h>
+#include "media/Helper.h"
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/opt.h>
+}
+
+namespace test {
+namespace {
+struct EncodeContext {
+    AVFormatContext* fmtCtx{nullptr};
+    AVCodecContext* codecCtx{nullptr};
+    AVFrame* frame{nullptr};
+    AVPacket* packet{nullptr};
+
+    ~EncodeContext()
+    {
+        if (fmtCtx && fmtCtx->pb) {
+            avio_closep(&fmtCtx->pb);
+        }
+        avformat_free_context(fmtCtx);
+        avcodec_free_context(&codecCtx);
+        av_frame_free(&frame);
+        av_packet_free(&packet);
+    }
+};
+} // namespace
+
+const char* videoCodecName(VideoCodec codec)
+{
+    switch (codec) {
+    case VideoCodec::H264: return "h264";
+    case VideoCodec::HEVC: return "hevc";
+    case VideoCodec::AV1: return "av1";
+    case VideoCodec::MPEG4: return "mpeg4";
+    }
+    return "unknown";
+}
+
+static const AVCodec* findEncoder(VideoCodec codec)
+{
+    // 按名称查找软件编码器，避免选中本机不可用的硬件编码器
+    static const std::vector<const char*> h264 = {"libx264", "libopenh264"};
+    static const std::vector<const char*> hevc = {"libx265"};
+    static const std::vector<const char*> av1 = {"libsvtav1", "libaom-av1", "librav1e"};
+    static const std::vector<const char*> mpeg4 = {"mpeg4"};
+    const std::vector<const char*>* names = &mpeg4;
+    switch (codec) {
+    case VideoCodec::H264: names = &h264; break;
+    case VideoCodec::HEVC: names = &hevc; break;
+    case VideoCodec::AV1: names = &av1; break;
+    case VideoCodec::MPEG4: break;
+    }
+    for (const char* name : *names) {
+        if (const AVCodec* encoder = avcodec_find_encoder_by_name(name)) {
+            return encoder;
+        }
+    }
+    return nullptr;
+}
+
+static void applyEncoderOptions(AVCodecContext* codecCtx, const AVCodec* encoder)
+{
+    // 只求生成快，画质无所谓
+    const std::string name = encoder->name;
+    if (name == "libx264") {
+        av_opt_set(codecCtx->priv_data, "preset", "ultrafast", 0);
+    } else if (name == "libx265") {
+        av_opt_set(codecCtx->priv_data, "preset", "ultrafast", 0);
+        av_opt_set(codecCtx->priv_data, "x265-params", "log-level=error", 0);
+    } else if (name == "libsvtav1") {
+        av_opt_set(codecCtx->priv_data, "preset", "12", 0);
+    } else if (name == "libaom-av1") {
+        av_opt_set(codecCtx->priv_data, "usage", "realtime", 0);
+        av_opt_set(codecCtx->priv_data, "cpu-used", "8", 0);
+    } else if (name == "librav1e") {
+        av_opt_set(codecCtx->priv_data, "speed", "10", 0);
+    }
+}
+
+static int triangle(int value, int period)
+{
+    value %= period;
+    return value < period / 2 ? value : period - value;
+}
+
+static void fillFrame(AVFrame* frame, int index)
+{
+    // 平滑渐变随时间平移，亮度叠加少量伪随机噪声
+    uint32_t seed = static_cast<uint32_t>(index) * 2654435761u;
+    for (int y = 0; y < frame->height; y++) {
+        uint8_t* row = frame->data[0] + static_cast<ptrdiff_t>(y) * frame->linesize[0];
+        for (int x = 0; x < frame->width; x++) {
+            seed = seed * 1664525u + 1013904223u;
+            const int noise = static_cast<int>(seed >> 28) - 8;
+            row[x] = static_cast<uint8_t>(std::clamp(16 + triangle(x + y + index * 4, 440) + noise, 0, 255));
+        }
+    }
+    for (int y = 0; y < frame->height / 2; y++) {
+        uint8_t* rowU = frame->data[1] + static_cast<ptrdiff_t>(y) * frame->linesize[1];
+        uint8_t* rowV = frame->data[2] + static_cast<ptrdiff_t>(y) * frame->linesize[2];
+        for (int x = 0; x < frame->width / 2; x++) {
+            rowU[x] = static_cast<uint8_t>(88 + triangle(x * 2 + index * 3, 160) / 2);
+            rowV[x] = static_cast<uint8_t>(128 + triangle(y * 2 + index * 2, 160) / 2);
+        }
+    }
+}
+
+static bool writePackets(EncodeContext& ctx, AVStream* stream, const AVFrame* frame)
+{
+    int ret = avcodec_send_frame(ctx.codecCtx, frame);
+    if (ret < 0) {
+        return false;
+    }
+    for (;;) {
+        ret = avcodec_receive_packet(ctx.codecCtx, ctx.packet);
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+            return true;
+        }
+        if (ret < 0) {
+            return false;
+        }
+        av_packet_rescale_ts(ctx.packet, ctx.codecCtx->time_base, stream->time_base);
+        ctx.packet->stream_index = stream->index;
+        if (av_interleaved_write_frame(ctx.fmtCtx, ctx.packet) < 0) {
+            return false;
+        }
+    }
+}
+
+static bool encodeClip(const AVCodec* encoder, const ClipSpec& spec, const std::string& path)
+{
+    EncodeContext ctx;
+    if (avformat_alloc_output_context2(&ctx.fmtCtx, nullptr, "matroska", path.c_str()) < 0) {
+        return false;
+    }
+    ctx.codecCtx = avcodec_alloc_context3(encoder);
+    ctx.frame = av_frame_alloc();
+    ctx.packet = av_packet_alloc();
+    if (!ctx.codecCtx || !ctx.frame || !ctx.packet) {
+        return false;
+    }
+    AVCodecContext* codecCtx = ctx.codecCtx;
+    codecCtx->width = spec.width;
+    codecCtx->height = spec.height;
+    codecCtx->pix_fmt = AV_PIX_FMT_YUV420P;
+    codecCtx->time_base = AVRational{1, spec.frameRate};
+    codecCtx->framerate = AVRational{spec.frameRate, 1};
+    codecCtx->gop_size = spec.gopSize;
+    codecCtx->bit_rate = static_cast<int64_t>(spec.width) * spec.height * spec.frameRate / 10;
+    if (ctx.fmtCtx->oformat->flags & AVFMT_GLOBALHEADER) {
+        codecCtx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+    applyEncoderOptions(codecCtx, encoder);
+    int ret = avcodec_open2(codecCtx, encoder, nullptr);
+    if (ret < 0) {
+        NEAPU_LOGW("Failed to open encoder {}: {}", encoder->name, media::getFFmpegErrorString(ret));
+        return false;
+    }
+
+    AVStream* stream = avformat_new_stream(ctx.fmtCtx, nullptr);
+    if (!stream || avcodec_parameters_from_context(stream->codecpar, codecCtx) < 0) {
+        return false;
+    }
+    stream->time_base = codecCtx->time_base;
+    if (avio_open(&ctx.fmtCtx->pb, path.c_str(), AVIO_FLAG_WRITE) < 0 ||
+        avformat_write_header(ctx.fmtCtx, nullptr) < 0) {
+        return false;
+    }
+
+    ctx.frame->format = codecCtx->pix_fmt;
+    ctx.frame->width = spec.width;
+    ctx.frame->height = spec.height;
+    if (av_frame_get_buffer(ctx.frame, 0) < 0) {
+        return false;
+    }
+    const int frameCount = spec.frameRate * spec.durationSec;
+    for (int i = 0; i < frameCount; i++) {
+        if (av_frame_make_writable(ctx.frame) < 0) {
+            return false;
+        }
+        fillFrame(ctx.frame, i);
+        ctx.frame->pts = i;
+        if (!writePackets(ctx, stream, ctx.frame)) {
+            return false;
+        }
+    }
+    if (!writePackets(ctx, stream, nullptr)) {
+        return false;
+    }
+    return av_write_trailer(ctx.fmtCtx) >= 0;
+}
+
+std::string makeClip(const ClipSpec& spec)
+{
+    const AVCodec* encoder = findEncoder(spec.codec);
+    if (!encoder) {
+        return {};
+    }
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    const fs::path dir = fs::temp_directory_path(ec) / "neapu-test-media";
+    fs::create_directories(dir, ec);
+    const fs::path path = dir / (std::string(videoCodecName(spec.codec)) + "_" +
+        std::to_string(spec.width) + "x" + std::to_string(spec.height) + "_" +
+        std::to_string(spec.frameRate) + "fps_g" + std::to_string(spec.gopSize) + "_" +
+        std::to_string(spec.durationSec) + "s.mkv");
+    if (fs::exists(path, ec)) {
+        return path.string();
+    }
+    // 先写临时文件，中途失败不会留下残缺的片段被下次复用
+    const fs::path tmpPath = path.string() + ".tmp";
+    if (!encodeClip(encoder, spec, tmpPath.string())) {
+        NEAPU_LOGW("Failed to generate test clip {} with encoder {}", path.string(), encoder->name);
+        fs::remove(tmpPath, ec);
+        return {};
+    }
+    fs::rename(tmpPath, path, ec);
+    return ec ? std::string{} : path.string();
+}
+
+std::string makeClipOrFallback(ClipSpec spec)
+{
+    std::string path = makeClip(spec);
+    if (path.empty() && spec.codec != VideoCodec::MPEG4) {
+        spec.codec = VideoCodec::MPEG4;
+        path = makeClip(spec);
+    }
+    return path;
+}
+
+} // namespace test
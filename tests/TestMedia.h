@@ -0,0 +1,35 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+#pragma once
+#include <string>
+
+namespace test {
+
+// 测试片段的视频编码，实际使用的编码器取决于本机FFmpeg的编译选项
+enum class VideoCodec {
+    H264, // libx264 / libopenh264
+    HEVC, // libx265
+    AV1, // libsvtav1 / libaom-av1 / librav1e
+    MPEG4, // FFmpeg 内置，总是可用
+};
+
+const char* videoCodecName(VideoCodec codec);
+
+struct ClipSpec {
+    VideoCodec codec{VideoCodec::H264};
+    int width{1280};
+    int height{720};
+    int frameRate{25};
+    int gopSize{25}; // 关键帧间隔（帧）
+    int durationSec{4};
+};
+
+// 在临时目录生成只有视频流的MKV测试片段，同参数的片段已存在时直接复用。
+// 画面为平移的渐变叠加噪声，每帧都有残差需要解码。编码器不可用或生成失败时返回空字符串
+std::string makeClip(const ClipSpec& spec);
+// 指定编码不可用时退回MPEG-4
+std::string makeClipOrFallback(ClipSpec spec);
+
+} // namespace test
@@ -0,0 +1,101 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+// 缩略图条生成的多线程扩展性：同一片段按 1、2、4 … 个工作线程各生成一次（不落盘），
+// 报告耗时和相对单线程的加速比。关键帧间隔短于缩略图间隔，每张缩略图都需要一次seek和解码
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BenchCommon.h"
+#include "TestCommon.h"
+#include "TestMedia.h"
+#include "media/Metrics.h"
+#include "media/ThumbnailStrip.h"
+
+constexpr int64_t GENERATE_TIMEOUT_US = 120'000'000;
+
+struct StripResult {
+    int64_t elapsedUs{-1}; // 未完成为-1
+    std::vector<uint8_t> pixels;
+};
+
+static StripResult generate(const std::string& url, int count, int workerCount)
+{
+    StripResult result;
+    media::ThumbnailStrip::Config config;
+    config.url = url;
+    config.count = count;
+    config.workerCount = workerCount;
+    const int64_t startUs = test::wallTimeUs();
+    media::ThumbnailStrip strip(config, nullptr);
+    while (!strip.isComplete() && test::wallTimeUs() - startUs < GENERATE_TIMEOUT_US) {
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+    if (!strip.isComplete()) {
+        return result;
+    }
+    result.elapsedUs = test::wallTimeUs() - startUs;
+    const size_t thumbnailBytes = static_cast<size_t>(strip.thumbnailHeight()) * strip.stride();
+    for (int i = 0; i < strip.count(); i++) {
+        const uint8_t* thumbnail = strip.thumbnail(i);
+        NEAPU_CHECK_MSG(thumbnail != nullptr, "thumbnail %d missing from a complete strip", i);
+        if (thumbnail) {
+            result.pixels.insert(result.pixels.end(), thumbnail, thumbnail + thumbnailBytes);
+        }
+    }
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    test::initTestLogging();
+    const bool quick = test::isQuickMode(argc, argv);
+    test::ClipSpec spec;
+    spec.durationSec = quick ? 8 : 24;
+    spec.gopSize = 5;
+    const std::string url = test::makeClipOrFallback(spec);
+    NEAPU_CHECK(!url.empty());
+    if (url.empty()) {
+        return test::testResult();
+    }
+    const int count = quick ? 40 : 120;
+    const int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    std::vector<int> workerCounts;
+    for (int workers = 1; workers < cores; workers *= 2) {
+        workerCounts.push_back(workers);
+    }
+    workerCounts.push_back(cores);
+
+    std::printf("%s %dx%d, %d s, %d thumbnails, %d cores\n", test::videoCodecName(spec.codec), spec.width, spec.height,
+        spec.durationSec, count, cores);
+    std::printf("  %-8s %12s %10s %12s\n", "workers", "ms", "speedup", "efficiency");
+    auto& metrics = media::Metrics::instance();
+    std::vector<uint8_t> reference;
+    double singleUs = 0.0;
+    for (int workers : workerCounts) {
+        metrics.reset();
+        const auto result = generate(url, count, workers);
+        NEAPU_CHECK_MSG(result.elapsedUs >= 0, "strip with %d workers did not complete", workers);
+        if (result.elapsedUs < 0) {
+            continue;
+        }
+        NEAPU_CHECK(metrics.value("thumbnails.decoded") > 0);
+        NEAPU_CHECK(metrics.value("thumbnails.incomplete") == 0);
+        // 每张缩略图都从同一个关键帧解码，与线程划分无关
+        if (reference.empty()) {
+            reference = result.pixels;
+            singleUs = static_cast<double>(result.elapsedUs);
+        } else {
+            NEAPU_CHECK_MSG(result.pixels == reference, "strip with %d workers differs from single worker", workers);
+        }
+        const double speedup = singleUs / static_cast<double>(result.elapsedUs);
+        std::printf("  %-8d %12.1f %9.2fx %11.0f%%\n", workers, result.elapsedUs / 1e3, speedup,
+            speedup / workers * 100.0);
+    }
+    return test::testResult();
+}
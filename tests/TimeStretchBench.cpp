@@ -0,0 +1,121 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+// 变速音频的CPU开销：48kHz立体声按解码器的帧大小送入 TimeStretcher，测量各速率下
+// 每播放一秒（即每输出一秒）的处理耗时和占单核的比例。WSOLA 每输出一秒的计算量与速率无关，
+// 检查 2x 的开销与低速率相当且远低于实时，同时检查输出时长和音高
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <initializer_list>
+#include <numbers>
+#include <random>
+#include <vector>
+#include "BenchCommon.h"
+#include "TestCommon.h"
+#include "media/AudioKernels.h"
+#include "media/TimeStretcher.h"
+
+constexpr int SAMPLE_RATE = 48000;
+constexpr int CHANNELS = 2;
+// 与解码器输出的一帧音频大小相当
+constexpr int BLOCK_FRAMES = 1024;
+// 2x 时每播放一秒的拉伸耗时上限（单核的10%）
+constexpr double MAX_COST_US_PER_SECOND = 100'000.0;
+
+// 几个不成谐波的正弦加噪声，接近音乐的频谱，避免相似度搜索过于容易
+static std::vector<float> makeSignal(int frames, std::initializer_list<double> frequencies, float noise)
+{
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-noise, noise);
+    std::vector<float> samples(static_cast<size_t>(frames) * CHANNELS);
+    const float amplitude = 0.6f / static_cast<float>(frequencies.size());
+    for (int i = 0; i < frames; i++) {
+        float value = 0.0f;
+        for (double frequency : frequencies) {
+            value += amplitude * static_cast<float>(std::sin(2.0 * std::numbers::pi * frequency * i / SAMPLE_RATE));
+        }
+        for (int c = 0; c < CHANNELS; c++) {
+            samples[static_cast<size_t>(i) * CHANNELS + c] = value + dist(rng);
+        }
+    }
+    return samples;
+}
+
+// 与 AudioDecoder::stretchFrame 一样逐帧送入并处理，返回输出的交错采样
+static std::vector<float> stretch(const std::vector<float>& input, double rate)
+{
+    media::TimeStretcher stretcher(SAMPLE_RATE, CHANNELS);
+    stretcher.setRate(rate);
+    std::vector<float> out;
+    out.reserve(static_cast<size_t>(static_cast<double>(input.size()) / rate) + SAMPLE_RATE);
+    const int frames = static_cast<int>(input.size() / CHANNELS);
+    for (int offset = 0; offset < frames; offset += BLOCK_FRAMES) {
+        const int count = std::min(BLOCK_FRAMES, frames - offset);
+        stretcher.push(input.data() + static_cast<size_t>(offset) * CHANNELS, count,
+            static_cast<int64_t>(offset) * 1'000'000 / SAMPLE_RATE);
+        int64_t ptsUs = 0;
+        stretcher.process(out, ptsUs);
+    }
+    return out;
+}
+
+// 第一声道过零点估计的频率
+static double estimateFrequency(const std::vector<float>& samples)
+{
+    const size_t frames = samples.size() / CHANNELS;
+    int crossings = 0;
+    for (size_t i = 1; i < frames; i++) {
+        const float previous = samples[(i - 1) * CHANNELS];
+        const float current = samples[i * CHANNELS];
+        if ((previous < 0.0f) != (current < 0.0f)) {
+            crossings++;
+        }
+    }
+    return frames > 0 ? crossings * 0.5 * SAMPLE_RATE / static_cast<double>(frames) : 0.0;
+}
+
+int main(int argc, char* argv[])
+{
+    test::initTestLogging();
+    const bool quick = test::isQuickMode(argc, argv);
+    const int64_t minDurationUs = quick ? 100'000 : 1'000'000;
+    const int inputFrames = SAMPLE_RATE * (quick ? 2 : 20);
+    const auto input = makeSignal(inputFrames, {220.0, 331.0, 497.0, 1250.0}, 0.05f);
+    const auto tone = makeSignal(SAMPLE_RATE * 2, {440.0}, 0.0f);
+
+    std::printf("%d Hz %dch, %.0f s input, kernels %s\n", SAMPLE_RATE, CHANNELS,
+        static_cast<double>(inputFrames) / SAMPLE_RATE, media::audioKernels().name);
+    std::printf("  %-6s %14s %22s %12s %10s\n", "rate", "output s", "us per playback second", "core usage", "pitch Hz");
+    double baselineUs = 0.0;
+    double doubleSpeedUs = 0.0;
+    for (double rate : {0.5, 1.25, 1.5, 2.0}) {
+        const auto out = stretch(input, rate);
+        const double expectedFrames = inputFrames / rate;
+        const double outFrames = static_cast<double>(out.size() / CHANNELS);
+        // 末尾不足一段加搜索窗口的输入留在拉伸器中
+        NEAPU_CHECK_MSG(std::abs(outFrames - expectedFrames) <= SAMPLE_RATE * 0.1,
+            "rate %.2f: %.0f output frames, expected about %.0f", rate, outFrames, expectedFrames);
+        const double outSeconds = outFrames / SAMPLE_RATE;
+
+        const double elapsedUs = test::measureAverageUs([&]() { stretch(input, rate); }, minDurationUs);
+        // 输出按原速播放，每输出一秒即播放一秒
+        const double perSecondUs = outSeconds > 0 ? elapsedUs / outSeconds : 0.0;
+        const double pitch = estimateFrequency(stretch(tone, rate));
+        NEAPU_CHECK_MSG(std::abs(pitch - 440.0) <= 440.0 * 0.02, "rate %.2f: pitch %.1f Hz", rate, pitch);
+        std::printf("  %-6.2f %14.2f %22.1f %11.2f%% %10.1f\n", rate, outSeconds, perSecondUs,
+            perSecondUs / 1e4, pitch);
+        if (rate == 1.25) {
+            baselineUs = perSecondUs;
+        } else if (rate == 2.0) {
+            doubleSpeedUs = perSecondUs;
+        }
+    }
+    NEAPU_CHECK_MSG(doubleSpeedUs < MAX_COST_US_PER_SECOND, "2x costs %.1f us per second", doubleSpeedUs);
+    // 计时有抖动，只要求与 1.25x 在同一量级
+    NEAPU_CHECK_MSG(doubleSpeedUs <= baselineUs * 2.0, "2x costs %.1f us per second, 1.25x %.1f",
+        doubleSpeedUs, baselineUs);
+    return test::testResult();
+}
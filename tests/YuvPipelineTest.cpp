@@ -0,0 +1,139 @@
+//
+// Created by neapu on 2026/10/18.
+//
+
+// 通用软件帧管线测试，使用 QRhi 的 Null 后端，不需要显卡和窗口：
+// 每种软件格式从测试帧建立管线，检查平面纹理的格式和尺寸、选用的着色器，
+// 以及帧尺寸变化时 checkFormat 要求重建。着色器资源在可执行程序中，这里不创建图形管线
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <vector>
+#include <rhi/qrhi.h>
+#include "TestCommon.h"
+#include "TestFrame.h"
+#include "view/YuvPipeline.h"
+
+using media::Frame;
+
+// 暴露受保护的纹理和着色器信息
+class YuvPipelineProbe : public view::YuvPipeline {
+public:
+    using YuvPipeline::YuvPipeline;
+    bool createTextures(const QSize& size) { return createSrb(size); }
+    QString shaderName() { return getFragmentShaderName(); }
+    const std::vector<std::unique_ptr<QRhiTexture>>& textures() const { return m_textures; }
+};
+
+struct ExpectedPlane {
+    QRhiTexture::Format format;
+    int log2ChromaW;
+    int log2ChromaH;
+};
+struct Expected {
+    Frame::PixelFormat pixelFormat;
+    const char* name;
+    const char* shader;
+    std::vector<ExpectedPlane> planes;
+};
+
+static const std::vector<Expected>& expectations()
+{
+    using enum Frame::PixelFormat;
+    static const std::vector<Expected> expected = {
+        {YUV420P, "YUV420P", ":/shaders/yuv420p.frag.qsb", {{QRhiTexture::R8, 0, 0}, {QRhiTexture::R8, 1, 1}, {QRhiTexture::R8, 1, 1}}},
+        {NV12, "NV12", ":/shaders/nv12.frag.qsb", {{QRhiTexture::R8, 0, 0}, {QRhiTexture::RG8, 1, 1}}},
+        {P010, "P010", ":/shaders/nv12.frag.qsb", {{QRhiTexture::R16, 0, 0}, {QRhiTexture::RG16, 1, 1}}},
+        {YUV420P10, "YUV420P10", ":/shaders/yuv420p10.frag.qsb", {{QRhiTexture::R16, 0, 0}, {QRhiTexture::R16, 1, 1}, {QRhiTexture::R16, 1, 1}}},
+        {YUV422P, "YUV422P", ":/shaders/yuv420p.frag.qsb", {{QRhiTexture::R8, 0, 0}, {QRhiTexture::R8, 1, 0}, {QRhiTexture::R8, 1, 0}}},
+        {YUV422P10, "YUV422P10", ":/shaders/yuv420p10.frag.qsb", {{QRhiTexture::R16, 0, 0}, {QRhiTexture::R16, 1, 0}, {QRhiTexture::R16, 1, 0}}},
+        {YUV444P, "YUV444P", ":/shaders/yuv420p.frag.qsb", {{QRhiTexture::R8, 0, 0}, {QRhiTexture::R8, 0, 0}, {QRhiTexture::R8, 0, 0}}},
+        {YUV444P10, "YUV444P10", ":/shaders/yuv420p10.frag.qsb", {{QRhiTexture::R16, 0, 0}, {QRhiTexture::R16, 0, 0}, {QRhiTexture::R16, 0, 0}}},
+    };
+    return expected;
+}
+
+static void checkTextures(const Expected& expected, YuvPipelineProbe& pipeline, const QSize& size)
+{
+    const auto& textures = pipeline.textures();
+    NEAPU_CHECK_MSG(textures.size() == expected.planes.size(), "%s: %zu textures, expected %zu",
+        expected.name, textures.size(), expected.planes.size());
+    for (size_t i = 0; i < textures.size() && i < expected.planes.size(); i++) {
+        const auto& plane = expected.planes[i];
+        // 奇数尺寸的色度平面向上取整
+        const QSize planeSize((size.width() + (1 << plane.log2ChromaW) - 1) >> plane.log2ChromaW,
+            (size.height() + (1 << plane.log2ChromaH) - 1) >> plane.log2ChromaH);
+        NEAPU_CHECK_MSG(textures[i]->format() == plane.format, "%s plane %zu: texture format %d, expected %d",
+            expected.name, i, static_cast<int>(textures[i]->format()), static_cast<int>(plane.format));
+        NEAPU_CHECK_MSG(textures[i]->pixelSize() == planeSize, "%s plane %zu: %dx%d, expected %dx%d", expected.name, i,
+            textures[i]->pixelSize().width(), textures[i]->pixelSize().height(), planeSize.width(), planeSize.height());
+    }
+}
+
+static void testFormat(QRhi* rhi, const Expected& expected)
+{
+    const int avFormat = Frame::toAVPixelFormat(expected.pixelFormat);
+    const QSize firstSize(640, 360);
+    const QSize secondSize(1279, 719);
+    auto frame = test::makeTestFrame(avFormat, firstSize.width(), firstSize.height(), 1);
+    auto resized = test::makeTestFrame(avFormat, secondSize.width(), secondSize.height(), 2);
+    NEAPU_CHECK_MSG(frame && resized, "%s: failed to allocate test frames", expected.name);
+    if (!frame || !resized) {
+        return;
+    }
+
+    // 渲染器走的工厂路径
+    view::Pipeline::CreateParam param;
+    param.rhi = rhi;
+    auto created = view::Pipeline::makeFormFrame(frame, param);
+    NEAPU_CHECK_MSG(dynamic_cast<view::YuvPipeline*>(created.get()) != nullptr, "%s: factory did not create a YuvPipeline", expected.name);
+
+    YuvPipelineProbe pipeline(rhi, frame->pixelFormat());
+    NEAPU_CHECK(pipeline.pixelFormat() == expected.pixelFormat);
+    NEAPU_CHECK_MSG(pipeline.shaderName() == QLatin1String(expected.shader), "%s: shader %s, expected %s",
+        expected.name, qPrintable(pipeline.shaderName()), expected.shader);
+    NEAPU_CHECK(pipeline.createTextures(firstSize));
+    checkTextures(expected, pipeline, firstSize);
+
+    // 同尺寸沿用，尺寸变化时要求重建，重建后按新尺寸创建纹理
+    NEAPU_CHECK(pipeline.checkFormat(frame));
+    NEAPU_CHECK_MSG(!pipeline.checkFormat(resized), "%s: size change did not require a rebuild", expected.name);
+    NEAPU_CHECK(pipeline.createTextures(secondSize));
+    checkTextures(expected, pipeline, secondSize);
+    NEAPU_CHECK(pipeline.checkFormat(resized));
+    NEAPU_CHECK(!pipeline.checkFormat(frame));
+}
+
+int main()
+{
+    test::initTestLogging();
+    QRhiNullInitParams params;
+    std::unique_ptr<QRhi> rhi(QRhi::create(QRhi::Null, &params));
+    NEAPU_CHECK(rhi != nullptr);
+    if (!rhi) {
+        return test::testResult();
+    }
+
+    // Null 后端支持全部纹理格式，所有软件格式都应直接渲染
+    const auto supported = view::YuvPipeline::supportedPixelFormats(rhi.get());
+    for (const auto& expected : expectations()) {
+        const bool listed = std::find(supported.begin(), supported.end(), expected.pixelFormat) != supported.end();
+        NEAPU_CHECK_MSG(listed, "%s missing from supportedPixelFormats()", expected.name);
+        if (listed) {
+            testFormat(rhi.get(), expected);
+        }
+    }
+    NEAPU_CHECK(supported.size() == expectations().size());
+
+    // 硬件帧格式不能走通用管线
+    bool threw = false;
+    try {
+        YuvPipelineProbe pipeline(rhi.get(), Frame::PixelFormat::Vaapi);
+    } catch (const std::exception&) {
+        threw = true;
+    }
+    NEAPU_CHECK(threw);
+    return test::testResult();
+}